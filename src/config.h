@@ -42,8 +42,13 @@
 // WIFI SCANNER SETTINGS
 // =============================================================================
 #define WIFI_MAX_NETWORKS       100
-#define WIFI_CHANNEL_HOP_MS     200
+#define WIFI_CHANNEL_HOP_MS     200     // Average dwell per channel
+#define WIFI_CHANNEL_FLOOR_MS   50      // Shortest adaptive dwell
+#define WIFI_HOP_POLICY         HOP_WEIGHTED
 #define WIFI_SCAN_TIMEOUT_MS    5000
+#define WIFI_PORTAL_ROWS        8       // Networks listed on the Portal screen
+#define WIFI_FRAME_RING_SLOTS   256     // Sniffed frames buffered in PSRAM
+#define WIFI_DECLOAK_EXPIRY_MS  300000  // Stop watching a hidden AP after its beacons stop
 
 // =============================================================================
 // BLE SPAM SETTINGS
@@ -70,10 +75,47 @@ typedef enum {
 #define LORA_TX_POWER           20      // dBm
 
 // =============================================================================
-// GPS SETTINGS (Uses LilyGoLib instance.gps)
+// GPS SETTINGS (u-blox M10 on Serial1, see gps/nmea_*)
 // =============================================================================
 #define GPS_UPDATE_INTERVAL_MS  1000
 #define GPS_FIX_TIMEOUT_MS      30000
+#define GPS_BAUD_RATE           115200  // Module boots at 9600, switched at init
+#define GPS_RATE_MS             200     // 5 Hz fixes
+#define GPS_RX_BUFFER           1024    // UART driver buffer
+#define GPS_RING_SIZE           4096    // NMEA stream ring
+#define GPS_PPS_PIN             13      // Pulse per second, disciplines gps/utc_clock
+
+// =============================================================================
+// TASKS (FreeRTOS, pinned - stacks in bytes, higher priority wins)
+// =============================================================================
+#define TASK_RADIO_CORE         0       // WiFi sniffing, BLE spam
+#define TASK_RADIO_PRIO         5
+#define TASK_RADIO_STACK        6144
+#define TASK_RADIO_PERIOD_MS    5
+
+#define TASK_MESH_CORE          0       // LoRa; transmit blocks while on air
+#define TASK_MESH_PRIO          3
+#define TASK_MESH_STACK         4096
+#define TASK_MESH_PERIOD_MS     20
+
+#define TASK_GPS_CORE           1       // NMEA from the UART
+#define TASK_GPS_PRIO           3
+#define TASK_GPS_STACK          4096
+#define TASK_GPS_PERIOD_MS      100
+
+#define TASK_UI_CORE            1       // LVGL, keyboard, rotary
+#define TASK_UI_PRIO            2
+#define TASK_UI_STACK           8192
+#define TASK_UI_PERIOD_MS       5
+
+#define TASK_STORAGE_CORE       1       // SD card
+#define TASK_STORAGE_PRIO       1
+#define TASK_STORAGE_STACK      6144
+
+#define QUEUE_UI_DEPTH          32      // Worker -> UI events
+#define QUEUE_CMD_DEPTH         8       // UI -> worker commands, per worker
+#define TASK_CMD_WAIT_MS        10      // UI gives up on a full command queue
+#define TASK_STACK_REPORT_MS    60000
 
 // =============================================================================
 // XP SYSTEM
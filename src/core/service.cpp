@@ -0,0 +1,106 @@
+/**
+ * @file service.cpp
+ * @brief RICK Service Registry - background subsystems independent of screens
+ */
+
+#include "service.h"
+#include <string.h>
+
+// =============================================================================
+// REGISTRY
+// =============================================================================
+void service_init(service_t* svc, const char* name, uint8_t runner, uint32_t period_ms,
+                  service_fn_t start, service_fn_t stop, service_tick_fn_t tick,
+                  void* state, uint16_t state_len) {
+    memset(svc, 0, sizeof(service_t));
+    svc->name = name;
+    svc->runner = runner;
+    svc->periodMs = period_ms;
+    svc->start = start;
+    svc->stop = stop;
+    svc->tick = tick;
+    svc->state = state;
+    svc->stateLen = state_len;
+}
+
+bool service_register(service_registry_t* reg, service_t* svc) {
+    if (reg->count >= SERVICE_MAX) {
+        Serial.printf("[SERVICE] Registry full, %s dropped\n", svc->name);
+        return false;
+    }
+    reg->services[reg->count++] = svc;
+    return true;
+}
+
+void service_request(service_t* svc, bool enabled) {
+    svc->requested = enabled;
+}
+
+// =============================================================================
+// RUNNER
+// =============================================================================
+uint32_t service_run(service_registry_t* reg, uint8_t runner, uint32_t now) {
+    uint32_t wait = SERVICE_IDLE;
+
+    for (uint8_t i = 0; i < reg->count; i++) {
+        service_t* svc = reg->services[i];
+        if (svc->runner != runner) continue;
+
+        bool want = svc->requested;
+        if (want != svc->active) {
+            if (want) {
+                if (svc->start) svc->start();
+                svc->lastRun = now - svc->periodMs;     // Due at once
+            } else if (svc->stop) {
+                svc->stop();
+            }
+            svc->active = want;
+            Serial.printf("[SERVICE] %s %s\n", svc->name, want ? "started" : "stopped");
+        }
+        if (!svc->active) continue;
+
+        uint32_t elapsed = now - svc->lastRun;
+        if (elapsed >= svc->periodMs) {
+            uint32_t start = micros();
+            svc->tick(now);
+            uint32_t us = micros() - start;
+
+            svc->runs++;
+            if (us > svc->maxUs) svc->maxUs = us;
+            if (us >= svc->periodMs * 1000) svc->overruns++;
+            svc->lastRun = now;
+            elapsed = 0;
+        }
+
+        uint32_t left = svc->periodMs - elapsed;
+        if (left < wait) wait = left;
+    }
+    return wait;
+}
+
+// =============================================================================
+// SNAPSHOTS
+// =============================================================================
+void service_publish(service_t* svc, const void* state) {
+    uint32_t seq = svc->seq;
+    __atomic_store_n(&svc->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    memcpy(svc->state, state, svc->stateLen);
+    __atomic_store_n(&svc->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+bool service_read(const service_t* svc, void* out, uint32_t* seen) {
+    for (int attempt = 0; attempt < SERVICE_READ_RETRIES; attempt++) {
+        uint32_t before = __atomic_load_n(&svc->seq, __ATOMIC_ACQUIRE);
+        if (before == *seen) return false;
+        if (before & 1) continue;
+
+        memcpy(out, svc->state, svc->stateLen);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&svc->seq, __ATOMIC_RELAXED) == before) {
+            *seen = before;
+            return true;
+        }
+    }
+    return false;
+}
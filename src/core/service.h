@@ -0,0 +1,100 @@
+/**
+ * @file service.h
+ * @brief RICK Service Registry - background subsystems independent of screens
+ *
+ * A service is a start/stop/tick triple with a cadence and a runner (the task
+ * that owns it). Any task may ask for a service to be enabled or disabled;
+ * the runner applies the change on its next pass, so start/stop always run
+ * in the task that owns the hardware. While enabled, the runner ticks it
+ * every period whatever screen is showing.
+ *
+ * Services publish their state as a snapshot that any task can copy out
+ * without locking: a sequence number is odd while the runner writes and
+ * moves on with every publish, so a reader detects torn and stale copies.
+ */
+
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <Arduino.h>
+
+#define SERVICE_MAX             12
+#define SERVICE_IDLE            0xFFFFFFFF  // service_run(): nothing enabled
+#define SERVICE_READ_RETRIES    4
+
+typedef void (*service_fn_t)(void);
+typedef void (*service_tick_fn_t)(uint32_t now);
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    const char* name;
+    uint8_t runner;             // Task that runs it
+    uint32_t periodMs;          // Tick cadence while enabled
+    service_fn_t start;         // Optional
+    service_fn_t stop;          // Optional
+    service_tick_fn_t tick;
+
+    volatile bool requested;    // Written by any task
+    bool active;                // Runner's view
+    uint32_t lastRun;
+
+    // Published state
+    void* state;
+    uint16_t stateLen;
+    volatile uint32_t seq;
+
+    // Stats
+    uint32_t runs;
+    uint32_t overruns;          // Ticks that took longer than the period
+    uint32_t maxUs;
+} service_t;
+
+typedef struct {
+    service_t* services[SERVICE_MAX];
+    uint8_t count;
+} service_registry_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Describe a service; state (state_len bytes, may be null) receives its
+ * snapshots
+ */
+void service_init(service_t* svc, const char* name, uint8_t runner, uint32_t period_ms,
+                  service_fn_t start, service_fn_t stop, service_tick_fn_t tick,
+                  void* state, uint16_t state_len);
+
+/**
+ * Add to the registry, false when full
+ */
+bool service_register(service_registry_t* reg, service_t* svc);
+
+/**
+ * Ask for a service to run or stop - any task
+ */
+void service_request(service_t* svc, bool enabled);
+
+/**
+ * Apply pending requests and tick every due service owned by runner - call
+ * from that task. Returns ms until the next one is due, SERVICE_IDLE when
+ * none of them is enabled.
+ */
+uint32_t service_run(service_registry_t* reg, uint8_t runner, uint32_t now);
+
+/**
+ * Replace the snapshot - runner only
+ */
+void service_publish(service_t* svc, const void* state);
+
+/**
+ * Copy the snapshot into out if it changed since *seen, and update *seen.
+ * False when unchanged, or when the runner kept rewriting it while we read
+ * (try again next pass).
+ */
+bool service_read(const service_t* svc, void* out, uint32_t* seen);
+
+#endif // SERVICE_H
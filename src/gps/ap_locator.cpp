@@ -0,0 +1,101 @@
+/**
+ * @file ap_locator.cpp
+ * @brief RICK AP Locator - online position estimate from RSSI sightings
+ */
+
+#include "ap_locator.h"
+#include <math.h>
+#include <string.h>
+
+#define M_PER_DEG_LAT           110574.0
+#define M_PER_DEG_LON           111320.0    // At the equator, times cos(latitude)
+
+// =============================================================================
+// LOCAL PLANE
+// =============================================================================
+static inline double lon_scale(int32_t lat0) {
+    return M_PER_DEG_LON * cos(lat0 * 1e-7 * M_PI / 180.0);
+}
+
+float ap_locator_range(int8_t rssi) {
+    return powf(10.0f, (LOCATOR_RSSI_1M - rssi) / (10.0f * LOCATOR_PATH_LOSS));
+}
+
+// Received amplitude relative to -100 dBm, which falls off with range
+static inline float sighting_weight(int8_t rssi) {
+    return powf(10.0f, (rssi + 100) / 20.0f);
+}
+
+// =============================================================================
+// ESTIMATOR
+// =============================================================================
+void ap_locator_init(ap_locator_t* loc) {
+    memset(loc, 0, sizeof(ap_locator_t));
+}
+
+void ap_locator_add(ap_locator_t* loc, double lat, double lon, int8_t rssi) {
+    if (loc->sightings == 0) {
+        loc->lat0 = (int32_t)lround(lat * 1e7);
+        loc->lon0 = (int32_t)lround(lon * 1e7);
+    }
+    loc->sightings++;
+
+    float x = (float)((lon - loc->lon0 * 1e-7) * lon_scale(loc->lat0));
+    float y = (float)((lat - loc->lat0 * 1e-7) * M_PER_DEG_LAT);
+    float d = ap_locator_range(rssi);
+    float b = d * d - x * x - y * y;
+    float w = sighting_weight(rssi);
+
+    loc->sw += w;
+    loc->sx += w * x;
+    loc->sy += w * y;
+    loc->sxx += w * x * x;
+    loc->sxy += w * x * y;
+    loc->syy += w * y * y;
+    loc->sb += w * b;
+    loc->sxb += w * x * b;
+    loc->syb += w * y * b;
+}
+
+// Range circles |P - p_i|^2 = d_i^2 differ from each other only in terms
+// linear in P once the shared |P|^2 is taken out, so centring on the means
+// leaves  C P = -1/2 cov(p, b)  with C the covariance of sighting positions
+static bool refine(const ap_locator_t* loc, float mx, float my, float* x, float* y) {
+    if (loc->sightings < LOCATOR_MIN_SIGHTINGS) return false;
+
+    float cxx = loc->sxx / loc->sw - mx * mx;
+    float cxy = loc->sxy / loc->sw - mx * my;
+    float cyy = loc->syy / loc->sw - my * my;
+    float mb = loc->sb / loc->sw;
+    float cxb = loc->sxb / loc->sw - mx * mb;
+    float cyb = loc->syb / loc->sw - my * mb;
+
+    // Narrow axis of the sighting spread - a straight pass cannot say which
+    // side of the road the AP is on
+    float half = (cxx + cyy) * 0.5f;
+    float det = cxx * cyy - cxy * cxy;
+    float minVar = half - sqrtf(fmaxf(half * half - det, 0.0f));
+    if (minVar < LOCATOR_MIN_SPREAD_M * LOCATOR_MIN_SPREAD_M) return false;
+
+    float px = -0.5f * (cyy * cxb - cxy * cyb) / det;
+    float py = -0.5f * (cxx * cyb - cxy * cxb) / det;
+    float dx = px - mx;
+    float dy = py - my;
+    if (!(dx * dx + dy * dy <= LOCATOR_MAX_SHIFT_M * LOCATOR_MAX_SHIFT_M)) return false;
+
+    *x = px;
+    *y = py;
+    return true;
+}
+
+locator_method_t ap_locator_estimate(const ap_locator_t* loc, double* lat, double* lon) {
+    if (loc->sightings == 0 || loc->sw <= 0) return LOCATOR_NONE;
+
+    float x = loc->sx / loc->sw;
+    float y = loc->sy / loc->sw;
+    locator_method_t method = refine(loc, x, y, &x, &y) ? LOCATOR_REFINED : LOCATOR_CENTROID;
+
+    *lat = loc->lat0 * 1e-7 + y / M_PER_DEG_LAT;
+    *lon = loc->lon0 * 1e-7 + x / lon_scale(loc->lat0);
+    return method;
+}
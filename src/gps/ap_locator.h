@@ -0,0 +1,72 @@
+/**
+ * @file ap_locator.h
+ * @brief RICK AP Locator - online position estimate from RSSI sightings
+ *
+ * Every sighting of an AP (where the car was, how loud the AP was) is folded
+ * into a handful of running sums on a local plane around the first one, so
+ * the state is the same size after ten sightings or ten thousand.
+ *
+ *   Centroid   sighting positions weighted by received amplitude
+ *   Refined    least-squares fit of the range circles a log-distance path
+ *              loss model gives for each RSSI, linearised so it reduces to
+ *              a 2x2 solve over the same sums
+ *
+ * The refinement needs sightings spread across the AP, not just along one
+ * straight road; without that, or if it lands implausibly far from the
+ * centroid, the centroid is the estimate.
+ */
+
+#ifndef AP_LOCATOR_H
+#define AP_LOCATOR_H
+
+#include <Arduino.h>
+
+#define LOCATOR_RSSI_1M         -35.0f  // Path loss model: RSSI at 1 m ...
+#define LOCATOR_PATH_LOSS       2.7f    // ... and exponent (2 = free space)
+#define LOCATOR_MIN_SIGHTINGS   5       // Before trying the refinement
+#define LOCATOR_MIN_SPREAD_M    20.0f   // Sighting spread across the narrow axis
+#define LOCATOR_MAX_SHIFT_M     150.0f  // Refined estimate this far off the centroid is rejected
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    int32_t lat0;               // First sighting, 1e-7 degrees - origin of the plane
+    int32_t lon0;
+    uint32_t sightings;
+
+    // Weighted sums over sightings at (x, y) meters, b = range^2 - x^2 - y^2
+    float sw;
+    float sx, sy;
+    float sxx, sxy, syy;
+    float sb, sxb, syb;
+} ap_locator_t;
+
+typedef enum {
+    LOCATOR_NONE = 0,           // No sightings
+    LOCATOR_CENTROID,
+    LOCATOR_REFINED
+} locator_method_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+void ap_locator_init(ap_locator_t* loc);
+
+/**
+ * Fold in one sighting: the observer's position and the AP's RSSI there
+ */
+void ap_locator_add(ap_locator_t* loc, double lat, double lon, int8_t rssi);
+
+/**
+ * Current estimate; returns the method that produced it
+ */
+locator_method_t ap_locator_estimate(const ap_locator_t* loc, double* lat, double* lon);
+
+/**
+ * Range the path loss model gives for an RSSI, meters
+ */
+float ap_locator_range(int8_t rssi);
+
+#endif // AP_LOCATOR_H
@@ -0,0 +1,213 @@
+/**
+ * @file nmea_parser.cpp
+ * @brief RICK NMEA Parser - fixed-point RMC/GGA/GSA decoder
+ */
+
+#include "nmea_parser.h"
+#include <string.h>
+
+#define SUM_PENDING             0xFF    // sumDigits before the '*'
+#define KNOT_CMS_X10000         5144    // 1 knot = 51.44 cm/s
+
+// =============================================================================
+// FIELDS
+// =============================================================================
+
+// "-12.345" with decimals 2 -> -1234; extra digits are cut, missing ones
+// padded. False for an empty field
+static bool parse_scaled(const char* s, uint8_t decimals, int32_t* out) {
+    if (!*s) return false;
+    bool neg = *s == '-';
+    if (neg) s++;
+
+    uint32_t v = 0;
+    while (*s >= '0' && *s <= '9') v = v * 10 + (*s++ - '0');
+    uint8_t d = 0;
+    if (*s == '.') {
+        s++;
+        for (; *s >= '0' && *s <= '9' && d < decimals; d++) v = v * 10 + (*s++ - '0');
+    }
+    for (; d < decimals; d++) v *= 10;
+
+    *out = neg ? -(int32_t)v : (int32_t)v;
+    return true;
+}
+
+// "dddmm.mmmmm" -> 1e-7 degrees; minutes kept to 1e-5 (2 cm)
+static void parse_coord(const char* s, int32_t* out) {
+    int32_t v;
+    if (!parse_scaled(s, 5, &v) || v < 0) return;
+    int32_t deg = v / 10000000;
+    int32_t min5 = v % 10000000;
+    *out = deg * 10000000 + (min5 * 5 + 1) / 3;       // min5 * 1e7 / (60 * 1e5)
+}
+
+// "hhmmss.sss" -> ms since midnight
+static void parse_time(const char* s, uint32_t* out) {
+    int32_t v;
+    if (!parse_scaled(s, 3, &v) || v < 0) return;
+    uint32_t hms = v / 1000;
+    *out = (hms / 10000) * 3600000 + (hms / 100 % 100) * 60000 + (hms % 100) * 1000 + v % 1000;
+}
+
+static void parse_u16(const char* s, uint8_t decimals, uint16_t* out) {
+    int32_t v;
+    if (parse_scaled(s, decimals, &v) && v >= 0) *out = v > 0xFFFF ? 0xFFFF : v;
+}
+
+static void parse_rmc(nmea_fix_t* f, uint8_t field, const char* t) {
+    int32_t v;
+    switch (field) {
+        case 1: parse_time(t, &f->timeMs); break;
+        case 2: f->valid = t[0] == 'A'; break;
+        case 3: parse_coord(t, &f->lat); break;
+        case 4: if (t[0] == 'S') f->lat = -f->lat; break;
+        case 5: parse_coord(t, &f->lon); break;
+        case 6: if (t[0] == 'W') f->lon = -f->lon; break;
+        case 7:
+            if (parse_scaled(t, 2, &v) && v >= 0) {
+                v = v * KNOT_CMS_X10000 / 10000;
+                f->speedCms = v > 0xFFFF ? 0xFFFF : v;
+            }
+            break;
+        case 8: parse_u16(t, 2, &f->courseCdeg); break;
+        case 9: if (parse_scaled(t, 0, &v)) f->date = v; break;
+    }
+}
+
+static void parse_gga(nmea_fix_t* f, uint8_t field, const char* t) {
+    int32_t v;
+    switch (field) {
+        case 1: parse_time(t, &f->timeMs); break;
+        case 2: parse_coord(t, &f->lat); break;
+        case 3: if (t[0] == 'S') f->lat = -f->lat; break;
+        case 4: parse_coord(t, &f->lon); break;
+        case 5: if (t[0] == 'W') f->lon = -f->lon; break;
+        case 6:
+            f->quality = t[0] >= '0' && t[0] <= '9' ? t[0] - '0' : 0;
+            f->valid = f->quality > 0;
+            break;
+        case 7: if (parse_scaled(t, 0, &v)) f->satellites = v; break;
+        case 8: parse_u16(t, 2, &f->hdop); break;
+        case 9: if (parse_scaled(t, 2, &v)) f->altCm = v; break;
+    }
+}
+
+static void parse_gsa(nmea_fix_t* f, uint8_t field, const char* t) {
+    switch (field) {
+        case 2: if (t[0] >= '1' && t[0] <= '3') f->mode = t[0] - '0'; break;
+        case 15: parse_u16(t, 2, &f->pdop); break;
+        case 16: parse_u16(t, 2, &f->hdop); break;
+        case 17: parse_u16(t, 2, &f->vdop); break;
+    }
+}
+
+// Address field: any talker, then the sentence type
+static uint8_t sentence_type(const char* t, uint8_t len) {
+    if (len != 5) return 0;
+    if (memcmp(t + 2, "RMC", 3) == 0) return NMEA_RMC;
+    if (memcmp(t + 2, "GGA", 3) == 0) return NMEA_GGA;
+    if (memcmp(t + 2, "GSA", 3) == 0) return NMEA_GSA;
+    return 0;
+}
+
+static void term_done(nmea_parser_t* p) {
+    p->term[p->termLen] = '\0';
+
+    if (p->field == 0) {
+        p->sentence = sentence_type(p->term, p->termLen);
+        if (p->sentence) p->pending = p->fix;
+        else p->skipped++;
+        return;
+    }
+
+    switch (p->sentence) {
+        case NMEA_RMC: parse_rmc(&p->pending, p->field, p->term); break;
+        case NMEA_GGA: parse_gga(&p->pending, p->field, p->term); break;
+        case NMEA_GSA: parse_gsa(&p->pending, p->field, p->term); break;
+    }
+}
+
+static int8_t hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// =============================================================================
+// PARSER
+// =============================================================================
+void nmea_parser_init(nmea_parser_t* p) {
+    memset(p, 0, sizeof(nmea_parser_t));
+}
+
+uint8_t nmea_parse(nmea_parser_t* p, char c, uint32_t sentence_ms) {
+    if (c == '$') {
+        p->sentence = NMEA_RMC | NMEA_GGA | NMEA_GSA;   // Until the address says otherwise
+        p->field = 0;
+        p->termLen = 0;
+        p->sum = 0;
+        p->sumDigits = SUM_PENDING;
+        p->stampMs = sentence_ms;
+        return 0;
+    }
+    if (!p->sentence) return 0;
+
+    // Checksum digits
+    if (p->sumDigits != SUM_PENDING) {
+        int8_t h = hex_digit(c);
+        if (h < 0) {
+            p->sentence = 0;
+            p->checksumErrors++;
+            return 0;
+        }
+        p->given = (p->given << 4) | h;
+        if (++p->sumDigits < 2) return 0;
+
+        uint8_t type = p->sentence;
+        p->sentence = 0;
+        if (p->given != p->sum) {
+            p->checksumErrors++;
+            return 0;
+        }
+
+        p->fix = p->pending;
+        if (type != NMEA_GSA) {
+            p->fix.stampMs = p->stampMs;
+            if (p->fix.valid) p->fix.fixes++;
+        }
+        p->sentences++;
+        return type;
+    }
+
+    switch (c) {
+        case ',':
+            term_done(p);
+            p->sum ^= c;
+            p->field++;
+            p->termLen = 0;
+            return 0;
+        case '*':
+            term_done(p);
+            if (p->sentence) {
+                p->given = 0;
+                p->sumDigits = 0;
+            }
+            return 0;
+        case '\r':
+        case '\n':
+            p->sentence = 0;        // No checksum - not trusted
+            p->checksumErrors++;
+            return 0;
+    }
+
+    p->sum ^= c;
+    if (p->termLen >= NMEA_MAX_TERM) {
+        p->sentence = 0;
+        p->skipped++;
+        return 0;
+    }
+    p->term[p->termLen++] = c;
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file nmea_parser.h
+ * @brief RICK NMEA Parser - fixed-point RMC/GGA/GSA decoder
+ *
+ * Fed one byte at a time straight off the NMEA stream. Only the three
+ * sentences wardriving needs are decoded (any talker: GP, GN, GL, ...);
+ * everything else is skipped after its address field. Fields are converted
+ * to scaled integers as each one ends and the checksum is accumulated on the
+ * way, so a sentence costs one pass and no floating point. Decoded fields
+ * are held back until the checksum matches, then committed to the fix in
+ * one go. No allocation.
+ */
+
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <Arduino.h>
+
+#define NMEA_MAX_TERM           15      // Longest field kept, longer drops the sentence
+
+// nmea_parse() return: sentence committed
+#define NMEA_RMC                0x01
+#define NMEA_GGA                0x02
+#define NMEA_GSA                0x04
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    int32_t lat;                // 1e-7 degrees, north positive
+    int32_t lon;                // 1e-7 degrees, east positive
+    int32_t altCm;              // Above mean sea level
+    uint32_t timeMs;            // UTC, ms since midnight
+    uint32_t date;              // ddmmyy
+    uint16_t speedCms;          // Ground speed, cm/s
+    uint16_t courseCdeg;        // Course over ground, 0.01 degrees
+    uint16_t hdop;              // x100
+    uint16_t pdop;              // x100
+    uint16_t vdop;              // x100
+    uint8_t satellites;
+    uint8_t quality;            // GGA fix quality, 0 = none
+    uint8_t mode;               // GSA 1 = none, 2 = 2D, 3 = 3D
+    bool valid;                 // Last RMC/GGA reported a position
+
+    uint32_t stampMs;           // Arrival of the last RMC/GGA committed
+    uint32_t fixes;             // RMC/GGA committed with a position
+} nmea_fix_t;
+
+typedef struct {
+    nmea_fix_t fix;             // Committed state
+    nmea_fix_t pending;         // Sentence in progress, committed on a good checksum
+
+    uint8_t sentence;           // NMEA_* being decoded, 0 = skipping
+    uint8_t field;
+    uint8_t termLen;
+    char term[NMEA_MAX_TERM + 1];
+    uint8_t sum;                // XOR of everything between '$' and '*'
+    uint8_t given;              // Checksum from the sentence
+    uint8_t sumDigits;          // Hex digits read after '*', 0xFF = not there yet
+    uint32_t stampMs;
+
+    // Stats
+    uint32_t sentences;         // Decoded and committed
+    uint32_t checksumErrors;
+    uint32_t skipped;           // Other sentence types, overlong fields
+} nmea_parser_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+void nmea_parser_init(nmea_parser_t* p);
+
+/**
+ * Feed one byte; sentence_ms is the arrival time of the current sentence's
+ * '$'. Returns the NMEA_* type when a sentence is committed, else 0
+ */
+uint8_t nmea_parse(nmea_parser_t* p, char c, uint32_t sentence_ms);
+
+#endif // NMEA_PARSER_H
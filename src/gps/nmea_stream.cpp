@@ -0,0 +1,114 @@
+/**
+ * @file nmea_stream.cpp
+ * @brief RICK NMEA Stream - byte ring between the GPS UART and the parser
+ */
+
+#include "nmea_stream.h"
+#include <string.h>
+
+#define MIN_SENTENCE            16      // Bytes; sizes the stamp ring
+
+// =============================================================================
+// SETUP
+// =============================================================================
+bool nmea_stream_init(nmea_stream_t* s, uint32_t ring_bytes, uint32_t baud) {
+    memset(s, 0, sizeof(nmea_stream_t));
+
+    uint32_t size = 64;
+    while (size < ring_bytes) size <<= 1;
+    uint32_t stampSlots = size / MIN_SENTENCE;
+
+    s->bytes = (uint8_t*)ps_malloc(size);
+    s->stamps = (uint32_t*)ps_malloc(stampSlots * sizeof(uint32_t));
+    if (!s->bytes || !s->stamps) {
+        Serial.println("[NMEA] PSRAM alloc failed, trying heap...");
+        free(s->bytes);
+        free(s->stamps);
+        s->bytes = (uint8_t*)malloc(size);
+        s->stamps = (uint32_t*)malloc(stampSlots * sizeof(uint32_t));
+    }
+    if (!s->bytes || !s->stamps) {
+        Serial.println("[NMEA] Failed to allocate stream ring");
+        nmea_stream_free(s);
+        return false;
+    }
+
+    s->mask = size - 1;
+    s->stampMask = stampSlots - 1;
+    nmea_stream_set_baud(s, baud);
+    return true;
+}
+
+void nmea_stream_free(nmea_stream_t* s) {
+    free(s->bytes);
+    free(s->stamps);
+    s->bytes = nullptr;
+    s->stamps = nullptr;
+    s->mask = 0;
+}
+
+void nmea_stream_set_baud(nmea_stream_t* s, uint32_t baud) {
+    s->byteUs = baud ? 10000000UL / baud : 0;     // 8N1 - ten bits per byte
+}
+
+// =============================================================================
+// PRODUCER
+// =============================================================================
+// Indices run free and wrap at 2^32, as in the frame ring. A '$' that finds
+// the stamp ring full is dropped too, so stamps and sentences never slip out
+// of step; the parser just sees one broken sentence.
+
+size_t nmea_stream_push(nmea_stream_t* s, const uint8_t* data, size_t len, uint32_t now_ms) {
+    s->received += len;
+    if (!s->bytes) {
+        s->dropped += len;
+        return 0;
+    }
+
+    uint32_t head = s->head;
+    uint32_t stampHead = s->stampHead;
+    uint32_t tail = __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE);
+    uint32_t stampTail = __atomic_load_n(&s->stampTail, __ATOMIC_ACQUIRE);
+
+    size_t stored = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (head - tail > s->mask) break;
+
+        if (data[i] == '$') {
+            if (stampHead - stampTail > s->stampMask) continue;
+            // The UART hands bytes over in bursts; back-date to the byte itself
+            uint32_t lateUs = (uint32_t)(len - 1 - i) * s->byteUs;
+            s->stamps[stampHead & s->stampMask] = now_ms - lateUs / 1000;
+            stampHead++;
+        }
+        s->bytes[head & s->mask] = data[i];
+        head++;
+        stored++;
+    }
+
+    __atomic_store_n(&s->stampHead, stampHead, __ATOMIC_RELEASE);
+    __atomic_store_n(&s->head, head, __ATOMIC_RELEASE);
+    s->dropped += len - stored;
+    return stored;
+}
+
+// =============================================================================
+// CONSUMER
+// =============================================================================
+bool nmea_stream_getc(nmea_stream_t* s, char* c) {
+    uint32_t tail = s->tail;
+    uint32_t backlog = __atomic_load_n(&s->head, __ATOMIC_ACQUIRE) - tail;
+    if (backlog == 0) return false;
+    if (backlog > s->highWater) s->highWater = backlog;
+
+    *c = (char)s->bytes[tail & s->mask];
+    if (*c == '$') {
+        uint32_t stampTail = s->stampTail;
+        s->sentenceMs = s->stamps[stampTail & s->stampMask];
+        s->sentences++;
+        __atomic_store_n(&s->stampTail, stampTail + 1, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&s->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file nmea_stream.h
+ * @brief RICK NMEA Stream - byte ring between the GPS UART and the parser
+ *
+ * Single-producer/single-consumer ring of raw NMEA bytes. The producer is the
+ * UART event handler and only copies; the GPS task pulls bytes one at a time
+ * and parses as they come. Every '$' is stamped on the way in with the time
+ * it came off the wire, so a fix carries the time of its sentence rather
+ * than the time the parser got to it.
+ */
+
+#ifndef NMEA_STREAM_H
+#define NMEA_STREAM_H
+
+#include <Arduino.h>
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    // Producer side
+    volatile uint32_t head;
+    volatile uint32_t stampHead;
+    volatile uint32_t received;         // Bytes offered by the UART
+    volatile uint32_t dropped;          // Bytes lost to a full ring
+
+    // Consumer side
+    volatile uint32_t tail;
+    volatile uint32_t stampTail;
+    uint32_t sentenceMs;                // Arrival of the current sentence's '$'
+    uint32_t sentences;                 // '$' seen by the consumer
+    uint32_t highWater;                 // Deepest backlog seen by the consumer
+
+    // Read-only after init
+    uint8_t* bytes;
+    uint32_t* stamps;                   // millis() per '$' in the ring
+    uint32_t mask;                      // Byte count - 1 (power of two)
+    uint32_t stampMask;
+    uint32_t byteUs;                    // Time on the wire per byte
+} nmea_stream_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Allocate a ring of ring_bytes bytes (rounded up to a power of two) for a
+ * UART running at baud
+ */
+bool nmea_stream_init(nmea_stream_t* s, uint32_t ring_bytes, uint32_t baud);
+
+void nmea_stream_free(nmea_stream_t* s);
+
+/**
+ * Follow a UART baud change, for back-dating stamps
+ */
+void nmea_stream_set_baud(nmea_stream_t* s, uint32_t baud);
+
+/**
+ * Copy bytes in (producer side); now_ms is when the last of them arrived.
+ * Returns bytes stored, short when the ring is full
+ */
+size_t nmea_stream_push(nmea_stream_t* s, const uint8_t* data, size_t len, uint32_t now_ms);
+
+/**
+ * Next byte (consumer side), false if empty; a '$' updates sentenceMs
+ */
+bool nmea_stream_getc(nmea_stream_t* s, char* c);
+
+#endif // NMEA_STREAM_H
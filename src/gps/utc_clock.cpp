@@ -0,0 +1,149 @@
+/**
+ * @file utc_clock.cpp
+ * @brief RICK UTC Clock - PPS-disciplined wall-clock time for records
+ */
+
+#include "utc_clock.h"
+#include <string.h>
+
+#define DRIFT_MAX_PPB           200000      // Beyond any crystal - a bad pairing
+
+utc_clock_t utcClock;
+
+static const char* const SOURCE_NAMES[] = {"boot", "RTC", "NMEA", "PPS"};
+
+// =============================================================================
+// CALENDAR
+// =============================================================================
+// Proleptic Gregorian, days relative to 1970-01-01
+
+static int64_t days_from_civil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(int64_t z, int* y, unsigned* m, unsigned* d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    *d = doy - (153 * mp + 2) / 5 + 1;
+    *m = mp < 10 ? mp + 3 : mp - 9;
+    *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+// RMC ddmmyy + ms of day
+static uint64_t fix_epoch_us(uint32_t date, uint32_t time_ms) {
+    unsigned yy = date % 100;
+    int year = yy < 80 ? 2000 + yy : 1900 + yy;
+    int64_t days = days_from_civil(year, date / 100 % 100, date / 10000);
+    return (uint64_t)days * 86400000000ULL + (uint64_t)time_ms * 1000;
+}
+
+const char* utc_source_name(uint8_t source) {
+    return source <= UTC_SOURCE_PPS ? SOURCE_NAMES[source] : "?";
+}
+
+size_t utc_format(uint64_t utc_us, char* out, size_t len) {
+    uint64_t secs = utc_us / 1000000;
+    uint32_t sod = secs % 86400;
+    int y;
+    unsigned m, d;
+    civil_from_days(secs / 86400, &y, &m, &d);
+    int n = snprintf(out, len, "%04d-%02u-%02u %02lu:%02lu:%02lu", y, m, d,
+                     (unsigned long)(sod / 3600), (unsigned long)(sod / 60 % 60), (unsigned long)(sod % 60));
+    return n < 0 ? 0 : (size_t)n;
+}
+
+// =============================================================================
+// DISCIPLINE
+// =============================================================================
+static void rebase(utc_clock_t* c, uint64_t local, uint64_t utc, uint8_t source,
+                   uint32_t error, int32_t drift_ppb) {
+    int64_t jump = (int64_t)(utc - utc_clock_at(c, local));
+    if (c->source != UTC_SOURCE_NONE && (jump > 1000000 || jump < -1000000)) {
+        c->steps++;
+        Serial.printf("[CLOCK] Stepped %lld ms\n", (long long)(jump / 1000));
+    }
+    if (source > c->source) {
+        char when[24];
+        utc_format(utc, when, sizeof(when));
+        Serial.printf("[CLOCK] %s time: %s UTC\n", SOURCE_NAMES[source], when);
+    }
+
+    __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    c->baseLocal = local;
+    c->baseUtc = utc;
+    c->driftPpb = drift_ppb;
+    c->source = source;
+    c->baseErrorUs = error;
+    __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELEASE);
+}
+
+void utc_clock_init(utc_clock_t* c) {
+    memset(c, 0, sizeof(utc_clock_t));
+    uint64_t rtc;
+    if (hal_rtc_get(&rtc)) rebase(c, hal_clock_us(), rtc, UTC_SOURCE_RTC, UTC_RTC_ERROR_US, 0);
+}
+
+uint32_t utc_clock_error_us(const utc_clock_t* c, uint64_t local_us) {
+    if (c->source == UTC_SOURCE_NONE) return UINT32_MAX;
+    uint64_t dt = local_us > c->baseLocal ? local_us - c->baseLocal : c->baseLocal - local_us;
+    uint64_t error = c->baseErrorUs + dt * (c->driftKnown ? UTC_DRIFT_RESIDUAL_PPM : UTC_DRIFT_UNKNOWN_PPM) / 1000000;
+    return error > UINT32_MAX ? UINT32_MAX : (uint32_t)error;
+}
+
+// Rate error from two PPS locks far enough apart, smoothed
+static int32_t measure_drift(utc_clock_t* c, uint64_t pps_local, uint64_t utc) {
+    int32_t drift = c->driftPpb;
+    int64_t dl = (int64_t)(pps_local - c->anchorLocal);
+
+    if (c->anchorLocal && dl < UTC_DRIFT_MIN_US) return drift;
+    if (c->anchorLocal) {
+        int64_t du = (int64_t)(utc - c->anchorUtc);
+        int64_t measured = (du - dl) * 1000000000 / dl;
+        if (measured > -DRIFT_MAX_PPB && measured < DRIFT_MAX_PPB) {
+            drift = c->driftKnown ? drift + (int32_t)(measured - drift) / 8 : (int32_t)measured;
+            c->driftKnown = true;
+        }
+    }
+    c->anchorLocal = pps_local;
+    c->anchorUtc = utc;
+    return drift;
+}
+
+void utc_clock_fix(utc_clock_t* c, const nmea_fix_t* fix) {
+    if (!fix->valid || !fix->date) return;
+
+    uint64_t now = hal_clock_us();
+    uint64_t age = (uint64_t)(uint32_t)(millis() - fix->stampMs) * 1000;
+    uint64_t sentenceLocal = age < now ? now - age : 0;     // Started arriving before boot
+    uint64_t utc = fix_epoch_us(fix->date, fix->timeMs);
+
+    // The pulse marks the top of the second this RMC goes on to name
+    uint64_t ppsLocal;
+    uint32_t pulses = hal_gps_pps_last(&ppsLocal);
+    if (pulses != c->lastPps && fix->timeMs % 1000 == 0 &&
+        ppsLocal <= sentenceLocal && sentenceLocal - ppsLocal < 1000000) {
+        c->lastPps = pulses;
+        c->ppsLocks++;
+        int32_t drift = measure_drift(c, ppsLocal, utc);
+        rebase(c, ppsLocal, utc, UTC_SOURCE_PPS, UTC_PPS_ERROR_US, drift);
+    } else if (utc_clock_error_us(c, sentenceLocal) > UTC_NMEA_RESYNC_US) {
+        c->nmeaSyncs++;
+        rebase(c, sentenceLocal, utc, UTC_SOURCE_NMEA, UTC_NMEA_ERROR_US, c->driftPpb);
+    }
+
+    // Keep the RTC close for the next boot
+    if (c->source >= UTC_SOURCE_NMEA && (!c->rtcSetLocal || now - c->rtcSetLocal >= UTC_RTC_SET_US)) {
+        hal_rtc_set(utc_clock_at(c, now));
+        c->rtcSetLocal = now;
+    }
+}
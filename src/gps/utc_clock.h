@@ -0,0 +1,127 @@
+/**
+ * @file utc_clock.h
+ * @brief RICK UTC Clock - PPS-disciplined wall-clock time for records
+ *
+ * Maps the monotonic local clock (hal_clock_us) to UTC microseconds. The
+ * mapping is a base point plus a rate correction, so reading it is one
+ * multiply. The base comes from the best source available:
+ *
+ *   PPS    whole-second RMC paired with the pulse edge before it, a few us
+ *   NMEA   RMC time at the arrival of its sentence, a few hundred ms
+ *   RTC    the clock kept across resets, seconds
+ *
+ * Between PPS locks the local oscillator's rate error is measured, and the
+ * correction keeps free-running time close after the signal is lost. A new
+ * sample replaces the base only if it is tighter than the base has drifted
+ * to - an NMEA one only once the base is off by twice its own error, so
+ * sentence latency jitter does not step the clock back and forth. The GPS
+ * task is the only writer; any task reads without locking.
+ */
+
+#ifndef UTC_CLOCK_H
+#define UTC_CLOCK_H
+
+#include <Arduino.h>
+#include "hal/hal.h"
+#include "nmea_parser.h"
+
+#define UTC_PPS_ERROR_US        5
+#define UTC_NMEA_ERROR_US       250000
+#define UTC_NMEA_RESYNC_US      (2 * UTC_NMEA_ERROR_US)     // Base error an NMEA sample replaces
+#define UTC_RTC_ERROR_US        2000000
+#define UTC_DRIFT_UNKNOWN_PPM   50          // Crystal tolerance, before measuring
+#define UTC_DRIFT_RESIDUAL_PPM  2           // After measuring
+#define UTC_DRIFT_MIN_US        10000000    // Shortest PPS interval to measure over
+#define UTC_RTC_SET_US          600000000   // Write back to the RTC this often
+
+typedef enum {
+    UTC_SOURCE_NONE = 0,        // Time since boot
+    UTC_SOURCE_RTC,
+    UTC_SOURCE_NMEA,
+    UTC_SOURCE_PPS
+} utc_source_t;
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    // Published mapping - seq is odd while the GPS task rewrites it
+    volatile uint32_t seq;
+    uint64_t baseLocal;         // hal_clock_us() ...
+    uint64_t baseUtc;           // ... and the UTC microseconds it maps to
+    int32_t driftPpb;           // Local clock rate error, positive = slow
+    uint8_t source;             // utc_source_t of the base
+    uint32_t baseErrorUs;
+
+    // Discipline, GPS task only
+    bool driftKnown;
+    uint64_t anchorLocal;       // Last PPS lock, for the next rate measurement
+    uint64_t anchorUtc;
+    uint32_t lastPps;           // Pulse count already used
+    uint64_t rtcSetLocal;
+
+    // Stats
+    uint32_t ppsLocks;
+    uint32_t nmeaSyncs;
+    uint32_t steps;             // Corrections of more than a second
+} utc_clock_t;
+
+// The one clock every module stamps records with
+extern utc_clock_t utcClock;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Start from the RTC when it holds a time, else from time since boot
+ */
+void utc_clock_init(utc_clock_t* c);
+
+/**
+ * Offer a fix (GPS task); whole-second RMCs lock to the latest PPS edge
+ */
+void utc_clock_fix(utc_clock_t* c, const nmea_fix_t* fix);
+
+/**
+ * Uncertainty of utc_clock_at(local_us), grows with time since the base
+ */
+uint32_t utc_clock_error_us(const utc_clock_t* c, uint64_t local_us);
+
+/**
+ * "boot", "RTC", "NMEA" or "PPS"
+ */
+const char* utc_source_name(uint8_t source);
+
+/**
+ * UTC microseconds to "YYYY-MM-DD HH:MM:SS", returns the length
+ */
+size_t utc_format(uint64_t utc_us, char* out, size_t len);
+
+/**
+ * UTC microseconds at a hal_clock_us() reading
+ */
+static inline uint64_t utc_clock_at(const utc_clock_t* c, uint64_t local_us) {
+    uint32_t seq;
+    uint64_t baseLocal, baseUtc;
+    int32_t ppb;
+    do {
+        seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        baseLocal = c->baseLocal;
+        baseUtc = c->baseUtc;
+        ppb = c->driftPpb;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != c->seq);
+
+    int64_t dt = (int64_t)(local_us - baseLocal);
+    return baseUtc + dt + dt * ppb / 1000000000;
+}
+
+/**
+ * UTC microseconds now
+ */
+static inline uint64_t utc_now_us() {
+    return utc_clock_at(&utcClock, hal_clock_us());
+}
+
+#endif // UTC_CLOCK_H
@@ -0,0 +1,313 @@
+/**
+ * @file wardrive_log.cpp
+ * @brief RICK Wardrive Log - compact binary session journal
+ */
+
+#include "wardrive_log.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define REC_SSID                0x01
+#define REC_POINT               0x02
+#define SSID_SLOTS              (WLOG_BLOCK_SSIDS * 2)
+
+static const uint8_t MAGIC[4] = {'R', 'W', 'L', '2'};
+
+// =============================================================================
+// ENCODING
+// =============================================================================
+// CRC-32 (IEEE, reflected) a nibble at a time - 64 bytes of table
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32(const uint8_t* p, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 15];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 15];
+    }
+    return ~crc;
+}
+
+static inline uint8_t* put_varint(uint8_t* p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static inline uint8_t* put_delta(uint8_t* p, int32_t v, int32_t* base) {
+    int32_t d = (int32_t)((uint32_t)v - (uint32_t)*base);
+    *base = v;
+    return put_varint(p, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+}
+
+static inline void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static inline uint32_t get_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// FNV-1a, never 0 (the empty-slot key)
+static uint64_t ssid_key(const char* ssid) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    while (*ssid) h = (h ^ (uint8_t)*ssid++) * 0x100000001B3ULL;
+    return h ? h : 1;
+}
+
+// =============================================================================
+// WRITER
+// =============================================================================
+static void block_reset(wlog_writer_t* w) {
+    w->used = WLOG_HEADER_SIZE;
+    w->records = 0;
+    w->lat = w->lon = w->altDm = 0;
+    w->time = 0;
+    memset(w->ssidKeys, 0, sizeof(w->ssidKeys));
+    w->ssidCount = 0;
+}
+
+static void block_emit(wlog_writer_t* w) {
+    if (w->records == 0) return;
+
+    uint16_t payload = w->used - WLOG_HEADER_SIZE;
+    memcpy(w->block, MAGIC, 4);
+    put_u16(w->block + 4, payload);
+    put_u16(w->block + 6, w->records);
+    put_u32(w->block + 8, crc32(w->block + WLOG_HEADER_SIZE, payload));
+
+    if (w->file.write(w->block, w->used) == w->used) {
+        w->blocks++;
+        w->bytes += w->used;
+    } else {
+        w->errors++;
+    }
+    block_reset(w);
+}
+
+bool wlog_writer_init(wlog_writer_t* w) {
+    *w = wlog_writer_t();
+    w->block = (uint8_t*)ps_malloc(WLOG_BLOCK_SIZE);
+    if (!w->block) w->block = (uint8_t*)malloc(WLOG_BLOCK_SIZE);
+    if (!w->block) {
+        Serial.println("[WLOG] Failed to allocate block buffer");
+        return false;
+    }
+    block_reset(w);
+    return true;
+}
+
+void wlog_writer_free(wlog_writer_t* w) {
+    wlog_close(w);
+    free(w->block);
+    w->block = nullptr;
+}
+
+static bool open_mode(wlog_writer_t* w, const char* path, const char* mode) {
+    if (!w->block) return false;
+    wlog_close(w);
+    w->file = SD.open(path, mode);
+    w->isOpen = (bool)w->file;
+    if (!w->isOpen) w->errors++;
+    block_reset(w);
+    return w->isOpen;
+}
+
+bool wlog_create(wlog_writer_t* w, const char* path) {
+    return open_mode(w, path, FILE_WRITE);
+}
+
+bool wlog_open(wlog_writer_t* w, const char* path) {
+    return open_mode(w, path, FILE_APPEND);
+}
+
+void wlog_flush(wlog_writer_t* w) {
+    if (!w->isOpen) return;
+    block_emit(w);
+    w->file.flush();
+}
+
+void wlog_close(wlog_writer_t* w) {
+    if (!w->isOpen) return;
+    wlog_flush(w);
+    w->file.close();
+    w->isOpen = false;
+}
+
+// SSID number for a name, defining it in the block first if it is new there
+static uint32_t intern(wlog_writer_t* w, const char* ssid) {
+    uint64_t key = ssid_key(ssid);
+    uint32_t slot = (uint32_t)(key >> 32) & (SSID_SLOTS - 1);
+    while (w->ssidKeys[slot]) {
+        if (w->ssidKeys[slot] == key) return w->ssidIds[slot];
+        slot = (slot + 1) & (SSID_SLOTS - 1);
+    }
+
+    uint32_t id = ++w->ssidCount;
+    w->ssidKeys[slot] = key;
+    w->ssidIds[slot] = id;
+    w->ssids++;
+
+    uint8_t len = strnlen(ssid, 32);
+    uint8_t* p = w->block + w->used;
+    *p++ = REC_SSID;
+    p = put_varint(p, id);
+    *p++ = len;
+    memcpy(p, ssid, len);
+    w->used = p + len - w->block;
+    return id;
+}
+
+void wlog_write(wlog_writer_t* w, const wlog_record_t* rec) {
+    if (!w->isOpen) return;
+    if (w->used + WLOG_MAX_RECORD > WLOG_BLOCK_SIZE || w->ssidCount == WLOG_BLOCK_SSIDS) block_emit(w);
+
+    uint32_t id = rec->ssid[0] ? intern(w, rec->ssid) : 0;
+
+    uint8_t* p = w->block + w->used;
+    *p++ = REC_POINT;
+    memcpy(p, rec->bssid, 6);
+    p += 6;
+    p = put_varint(p, id);
+    *p++ = rec->channel;
+    *p++ = rec->authmode;
+    *p++ = (uint8_t)rec->rssi;
+    p = put_delta(p, (int32_t)rec->time, &w->time);
+    p = put_delta(p, rec->lat, &w->lat);
+    p = put_delta(p, rec->lon, &w->lon);
+    p = put_delta(p, rec->altDm, &w->altDm);
+    p = put_varint(p, rec->sightings);
+
+    w->used = p - w->block;
+    w->records++;
+    w->points++;
+}
+
+// =============================================================================
+// READER
+// =============================================================================
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+} cursor_t;
+
+static uint32_t get_varint(cursor_t* c) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (c->p >= c->end) break;
+        uint8_t b = *c->p++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    c->ok = false;
+    return 0;
+}
+
+static int32_t get_delta(cursor_t* c, int32_t* base) {
+    uint32_t z = get_varint(c);
+    *base = (int32_t)((uint32_t)*base + ((z >> 1) ^ (0 - (z & 1))));
+    return *base;
+}
+
+static uint8_t get_byte(cursor_t* c) {
+    if (c->p >= c->end) {
+        c->ok = false;
+        return 0;
+    }
+    return *c->p++;
+}
+
+void wlog_reader_init(wlog_reader_t* r) {
+    memset(r, 0, sizeof(wlog_reader_t));
+}
+
+static bool define_ssid(wlog_reader_t* r, uint32_t id, const uint8_t* name, uint8_t len) {
+    if (id == 0 || id > WLOG_BLOCK_SSIDS || len > 32) return false;
+    memcpy(r->ssids[id], name, len);
+    r->ssids[id][len] = '\0';
+    return true;
+}
+
+// False if the payload does not parse; points before the fault are kept
+static bool decode_block(wlog_reader_t* r, const uint8_t* payload, uint16_t len,
+                         wlog_record_cb_t cb, void* ctx) {
+    cursor_t c = {payload, payload + len, true};
+    int32_t time = 0, lat = 0, lon = 0, alt = 0;
+    for (int i = 0; i <= WLOG_BLOCK_SSIDS; i++) r->ssids[i][0] = '\0';
+
+    while (c.ok && c.p < c.end) {
+        uint8_t type = get_byte(&c);
+        if (type == REC_SSID) {
+            uint32_t id = get_varint(&c);
+            uint8_t n = get_byte(&c);
+            if (!c.ok || c.end - c.p < n || !define_ssid(r, id, c.p, n)) return false;
+            c.p += n;
+            continue;
+        }
+        if (type != REC_POINT || c.end - c.p < 6) return false;
+
+        wlog_record_t rec;
+        memcpy(rec.bssid, c.p, 6);
+        c.p += 6;
+        uint32_t id = get_varint(&c);
+        rec.channel = get_byte(&c);
+        rec.authmode = get_byte(&c);
+        rec.rssi = (int8_t)get_byte(&c);
+        rec.time = (uint32_t)get_delta(&c, &time);
+        rec.lat = get_delta(&c, &lat);
+        rec.lon = get_delta(&c, &lon);
+        rec.altDm = get_delta(&c, &alt);
+        rec.sightings = get_varint(&c);
+        if (!c.ok || id > WLOG_BLOCK_SSIDS) return false;
+        memcpy(rec.ssid, r->ssids[id], sizeof(rec.ssid));
+
+        r->points++;
+        cb(&rec, ctx);
+    }
+    return c.ok;
+}
+
+size_t wlog_read(wlog_reader_t* r, const uint8_t* data, size_t len, bool final,
+                 wlog_record_cb_t cb, void* ctx) {
+    size_t p = 0;
+    while (len - p >= WLOG_HEADER_SIZE) {
+        const uint8_t* h = data + p;
+        uint16_t payload = h[4] | (h[5] << 8);
+        if (memcmp(h, MAGIC, 4) != 0 || payload > WLOG_BLOCK_SIZE - WLOG_HEADER_SIZE) {
+            p++;
+            r->skippedBytes++;
+            continue;
+        }
+        if (len - p < (size_t)WLOG_HEADER_SIZE + payload) break;     // Rest of it not here yet
+
+        if (crc32(h + WLOG_HEADER_SIZE, payload) != get_u32(h + 8)) {
+            r->badBlocks++;
+            p++;
+            r->skippedBytes++;
+            continue;
+        }
+        if (!decode_block(r, h + WLOG_HEADER_SIZE, payload, cb, ctx)) r->badBlocks++;
+        r->blocks++;
+        p += WLOG_HEADER_SIZE + payload;
+    }
+
+    if (final && p < len) {
+        if (len - p >= 4 && memcmp(data + p, MAGIC, 4) == 0) r->badBlocks++;      // Cut short
+        r->skippedBytes += len - p;
+        p = len;
+    }
+    return p;
+}
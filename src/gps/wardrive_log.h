@@ -0,0 +1,121 @@
+/**
+ * @file wardrive_log.h
+ * @brief RICK Wardrive Log - compact binary session journal
+ *
+ * A file is a run of blocks of at most WLOG_BLOCK_SIZE bytes, so a full
+ * block is one card sector:
+ *
+ *   "RWL2"  u16 payload length  u16 records  u32 CRC-32 of the payload
+ *   payload: records
+ *
+ * Records are a type byte and varints. Positions (1e-7 degrees), altitude
+ * (decimetres) and time (UTC seconds) are zigzag deltas from the previous
+ * point in the same block, and every block starts from zero. SSIDs are
+ * interned the same way: an SSID record defines a name the first time a
+ * block uses it, and later points in that block refer to it by number. So
+ * each block decodes on its own and a damaged block costs only its own
+ * points.
+ *
+ * A point record supersedes earlier ones for the same BSSID. Nothing here
+ * formats text; wardriving exports the decoded points.
+ */
+
+#ifndef WARDRIVE_LOG_H
+#define WARDRIVE_LOG_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+#define WLOG_BLOCK_SIZE         512
+#define WLOG_HEADER_SIZE        12
+#define WLOG_MAX_RECORD         (36 + 43)   // SSID definition + point, worst case
+#define WLOG_BLOCK_SSIDS        32      // Names one block can define, numbered from 1
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[33];
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t authmode;
+    int32_t lat;                // 1e-7 degrees
+    int32_t lon;
+    int32_t altDm;              // Decimetres
+    uint32_t time;              // UTC seconds, first seen
+    uint32_t sightings;
+} wlog_record_t;
+
+typedef struct {
+    File file;
+    bool isOpen;
+
+    uint8_t* block;             // WLOG_BLOCK_SIZE bytes, header included
+    uint16_t used;
+    uint16_t records;
+    int32_t lat, lon, altDm;    // Delta bases, reset per block
+    int32_t time;
+
+    uint64_t ssidKeys[WLOG_BLOCK_SSIDS * 2];    // Names defined in this block, 0 = empty slot
+    uint8_t ssidIds[WLOG_BLOCK_SSIDS * 2];
+    uint8_t ssidCount;
+
+    // Stats
+    uint32_t points;
+    uint32_t ssids;             // SSID definitions written
+    uint32_t blocks;
+    uint32_t bytes;
+    uint32_t errors;
+} wlog_writer_t;
+
+typedef struct {
+    char ssids[WLOG_BLOCK_SSIDS + 1][33];       // By SSID number, cleared per block
+
+    // Stats
+    uint32_t blocks;
+    uint32_t points;
+    uint32_t badBlocks;         // CRC or framing errors
+    uint32_t skippedBytes;      // Passed over looking for the next block
+} wlog_reader_t;
+
+typedef void (*wlog_record_cb_t)(const wlog_record_t* rec, void* ctx);
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Allocate the block buffer
+ */
+bool wlog_writer_init(wlog_writer_t* w);
+
+void wlog_writer_free(wlog_writer_t* w);
+
+bool wlog_create(wlog_writer_t* w, const char* path);
+
+/**
+ * Reopen for appending
+ */
+bool wlog_open(wlog_writer_t* w, const char* path);
+
+void wlog_write(wlog_writer_t* w, const wlog_record_t* rec);
+
+/**
+ * Write out the block in progress, even if it is short
+ */
+void wlog_flush(wlog_writer_t* w);
+
+void wlog_close(wlog_writer_t* w);
+
+void wlog_reader_init(wlog_reader_t* r);
+
+/**
+ * Decode whole blocks from data, calling cb for each point. Returns the
+ * bytes consumed; a trailing partial block is left for the next call with
+ * more data, or counted bad if final
+ */
+size_t wlog_read(wlog_reader_t* r, const uint8_t* data, size_t len, bool final,
+                 wlog_record_cb_t cb, void* ctx);
+
+#endif // WARDRIVE_LOG_H
@@ -0,0 +1,221 @@
+/**
+ * @file hal.h
+ * @brief RICK Hardware Abstraction Layer
+ *
+ * Thin seam between the scan/capture/wardrive/mesh logic and the K257
+ * peripherals. hal_esp32.cpp backs it with LilyGoLib/ESP-IDF on the pager,
+ * native/hal_native.cpp backs it with Linux stand-ins fed from replay files
+ * so the same logic can be exercised and profiled on a desktop.
+ */
+
+#ifndef RICK_HAL_H
+#define RICK_HAL_H
+
+#include <Arduino.h>
+#include <esp_wifi.h>
+
+// =============================================================================
+// WIFI SCAN RESULTS
+// =============================================================================
+#define HAL_SCAN_RUNNING    -1
+#define HAL_SCAN_FAILED     -2
+
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[33];
+    int8_t rssi;
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+} hal_ap_record_t;
+
+/**
+ * Bring WiFi up in station mode, disconnected
+ */
+void hal_wifi_begin();
+
+/**
+ * Turn WiFi off
+ */
+void hal_wifi_end();
+
+/**
+ * Kick off an asynchronous scan sweep
+ */
+bool hal_wifi_scan_start(bool show_hidden, bool passive, uint32_t ms_per_chan);
+
+/**
+ * Poll scan state - result count, HAL_SCAN_RUNNING or HAL_SCAN_FAILED
+ */
+int16_t hal_wifi_scan_poll();
+
+/**
+ * Copy one result of the last completed sweep
+ */
+bool hal_wifi_scan_get(uint16_t index, hal_ap_record_t* out);
+
+/**
+ * Copy up to max results of the last completed sweep, returns count copied
+ */
+uint16_t hal_wifi_scan_fetch(hal_ap_record_t* out, uint16_t max);
+
+/**
+ * Release the results of the last sweep
+ */
+void hal_wifi_scan_delete();
+
+/**
+ * Tune the radio to a primary channel
+ */
+void hal_wifi_set_channel(uint8_t channel);
+
+// =============================================================================
+// PROMISCUOUS FRAME SOURCE
+// =============================================================================
+typedef struct {
+    const uint8_t* payload;     // 802.11 header onwards, FCS stripped
+    uint16_t len;
+    int8_t rssi;
+    uint8_t channel;
+    uint32_t timestamp;         // Microseconds, radio local time
+    wifi_promiscuous_pkt_type_t type;
+} hal_frame_t;
+
+typedef void (*hal_frame_cb_t)(const hal_frame_t* frame);
+
+/**
+ * Enable/disable promiscuous reception
+ */
+void hal_wifi_promisc(bool enable);
+
+/**
+ * Set the frame callback (runs in the WiFi driver task on device)
+ */
+void hal_wifi_set_frame_cb(hal_frame_cb_t callback);
+
+/**
+ * Inject a raw 802.11 frame
+ */
+bool hal_wifi_tx_raw(const uint8_t* frame, uint16_t len);
+
+/**
+ * Read/write the station MAC
+ */
+void hal_wifi_get_mac(uint8_t* mac);
+void hal_wifi_set_mac(const uint8_t* mac);
+
+// =============================================================================
+// LORA (SX1262) PACKET I/O
+// =============================================================================
+
+/**
+ * Configure the SX1262 and leave it in standby
+ */
+bool hal_lora_begin(float freq, float bw, uint8_t sf, uint8_t cr,
+                    uint8_t sync, int8_t power, uint16_t preamble);
+
+/**
+ * Blocking transmit - 0 on success, driver error code otherwise
+ */
+int hal_lora_transmit(const uint8_t* data, size_t len);
+
+/**
+ * Arm continuous receive
+ */
+void hal_lora_start_receive();
+
+/**
+ * Put the radio in standby
+ */
+void hal_lora_standby();
+
+/**
+ * Check if a received packet is pending
+ */
+bool hal_lora_available();
+
+/**
+ * Fetch a pending packet - length, 0 if none, negative driver error
+ */
+int hal_lora_receive(uint8_t* buf, size_t max_len, int16_t* rssi, float* snr);
+
+// =============================================================================
+// GPS NMEA BYTE STREAM
+// =============================================================================
+
+typedef void (*hal_gps_rx_cb_t)(const uint8_t* data, size_t len);
+
+/**
+ * Open the GPS UART with an rx_buffer byte driver buffer, and move the module
+ * to baud and one fix every rate_ms (0 keeps its rate). on_rx is called from
+ * the UART event task with each burst received; with none, poll
+ * hal_gps_read()
+ */
+void hal_gps_begin(uint32_t baud, uint16_t rate_ms, size_t rx_buffer, hal_gps_rx_cb_t on_rx);
+
+/**
+ * Drain up to max_len pending NMEA bytes, returns bytes read
+ */
+size_t hal_gps_read(uint8_t* buf, size_t max_len);
+
+/**
+ * Timestamp the module's pulse-per-second output on pin
+ */
+void hal_gps_pps_begin(uint8_t pin);
+
+/**
+ * hal_clock_us() at the last PPS edge; returns the pulse count, 0 if none yet
+ */
+uint32_t hal_gps_pps_last(uint64_t* local_us);
+
+// =============================================================================
+// CLOCKS
+// =============================================================================
+
+/**
+ * Monotonic microseconds since boot, never wraps
+ */
+uint64_t hal_clock_us();
+
+/**
+ * Wall-clock time kept across resets, false if it was never set
+ */
+bool hal_rtc_get(uint64_t* epoch_us);
+void hal_rtc_set(uint64_t epoch_us);
+
+// =============================================================================
+// SD FILESYSTEM
+// =============================================================================
+// Files are accessed through the Arduino SD/File API; on the host that API is
+// provided by native/SD.h and rooted at a local directory.
+
+/**
+ * Mount the SD card
+ */
+bool hal_sd_begin();
+
+/**
+ * Card capacity and usage in bytes
+ */
+uint64_t hal_sd_total_bytes();
+uint64_t hal_sd_used_bytes();
+
+// =============================================================================
+// DISPLAY SINK
+// =============================================================================
+
+/**
+ * Bring up the panel and the LVGL display driver
+ */
+bool hal_display_begin();
+
+/**
+ * Set backlight level (1-16)
+ */
+void hal_display_set_brightness(uint8_t level);
+
+/**
+ * Push an RGB565 rectangle to the panel
+ */
+void hal_display_flush(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels);
+
+#endif // RICK_HAL_H
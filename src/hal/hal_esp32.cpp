@@ -0,0 +1,299 @@
+/**
+ * @file hal_esp32.cpp
+ * @brief RICK HAL - K257 backend (LilyGoLib / ESP-IDF)
+ */
+
+#include "hal.h"
+#include <LilyGoLib.h>
+#include <LV_Helper.h>
+#include <WiFi.h>
+#include <SD.h>
+#include <sys/time.h>
+#include <esp_timer.h>
+
+// =============================================================================
+// WIFI SCAN RESULTS
+// =============================================================================
+void hal_wifi_begin() {
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+}
+
+void hal_wifi_end() {
+    WiFi.mode(WIFI_OFF);
+}
+
+bool hal_wifi_scan_start(bool show_hidden, bool passive, uint32_t ms_per_chan) {
+    return WiFi.scanNetworks(true, show_hidden, passive, ms_per_chan) != WIFI_SCAN_FAILED;
+}
+
+int16_t hal_wifi_scan_poll() {
+    int16_t n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return HAL_SCAN_RUNNING;
+    if (n < 0) return HAL_SCAN_FAILED;
+    return n;
+}
+
+// The core drains esp_wifi_scan_get_ap_records() into its own array on
+// SCAN_DONE, so read the raw wifi_ap_record_t from there - no String copies
+static bool copyRecord(uint16_t index, hal_ap_record_t* out) {
+    const wifi_ap_record_t* ap = (const wifi_ap_record_t*)WiFi.getScanInfoByIndex(index);
+    if (!ap) return false;
+
+    memcpy(out->bssid, ap->bssid, 6);
+    memcpy(out->ssid, ap->ssid, 32);
+    out->ssid[32] = '\0';
+    out->rssi = ap->rssi;
+    out->channel = ap->primary;
+    out->authmode = ap->authmode;
+    return true;
+}
+
+bool hal_wifi_scan_get(uint16_t index, hal_ap_record_t* out) {
+    return copyRecord(index, out);
+}
+
+uint16_t hal_wifi_scan_fetch(hal_ap_record_t* out, uint16_t max) {
+    int16_t n = WiFi.scanComplete();
+    if (n <= 0) return 0;
+
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < (uint16_t)n && count < max; i++) {
+        if (copyRecord(i, &out[count])) count++;
+    }
+    return count;
+}
+
+void hal_wifi_scan_delete() {
+    WiFi.scanDelete();
+}
+
+void hal_wifi_set_channel(uint8_t channel) {
+    esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+}
+
+// =============================================================================
+// PROMISCUOUS FRAME SOURCE
+// =============================================================================
+static hal_frame_cb_t frameCallback = nullptr;
+
+static void IRAM_ATTR onPromiscRx(void* buf, wifi_promiscuous_pkt_type_t type) {
+    if (!frameCallback) return;
+
+    const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)buf;
+    uint16_t len = pkt->rx_ctrl.sig_len;
+    if (type != WIFI_PKT_MISC && len >= 4) len -= 4;  // sig_len includes the FCS
+
+    hal_frame_t frame;
+    frame.payload = pkt->payload;
+    frame.len = len;
+    frame.rssi = pkt->rx_ctrl.rssi;
+    frame.channel = pkt->rx_ctrl.channel;
+    frame.timestamp = pkt->rx_ctrl.timestamp;
+    frame.type = type;
+    frameCallback(&frame);
+}
+
+void hal_wifi_promisc(bool enable) {
+    esp_wifi_set_promiscuous(enable);
+}
+
+void hal_wifi_set_frame_cb(hal_frame_cb_t callback) {
+    frameCallback = callback;
+    esp_wifi_set_promiscuous_rx_cb(callback ? onPromiscRx : nullptr);
+}
+
+bool hal_wifi_tx_raw(const uint8_t* frame, uint16_t len) {
+    return esp_wifi_80211_tx(WIFI_IF_STA, frame, len, false) == ESP_OK;
+}
+
+void hal_wifi_get_mac(uint8_t* mac) {
+    esp_wifi_get_mac(WIFI_IF_STA, mac);
+}
+
+void hal_wifi_set_mac(const uint8_t* mac) {
+    esp_wifi_set_mac(WIFI_IF_STA, mac);
+}
+
+// =============================================================================
+// LORA (SX1262) PACKET I/O
+// =============================================================================
+// 'radio' is the global SX1262 owned by LilyGoLib; DIO1 stays with the
+// library, so RX completion is polled through the IRQ flags.
+
+bool hal_lora_begin(float freq, float bw, uint8_t sf, uint8_t cr,
+                    uint8_t sync, int8_t power, uint16_t preamble) {
+    if (!instance.initLoRa()) return false;
+    return radio.begin(freq, bw, sf, cr, sync, power, preamble, 0, false) == RADIOLIB_ERR_NONE;
+}
+
+int hal_lora_transmit(const uint8_t* data, size_t len) {
+    return radio.transmit((uint8_t*)data, len);
+}
+
+void hal_lora_start_receive() {
+    radio.startReceive();
+}
+
+void hal_lora_standby() {
+    radio.standby();
+}
+
+bool hal_lora_available() {
+    return (radio.getIrqFlags() & RADIOLIB_SX126X_IRQ_RX_DONE) != 0;
+}
+
+int hal_lora_receive(uint8_t* buf, size_t max_len, int16_t* rssi, float* snr) {
+    if (!hal_lora_available()) return 0;
+
+    int len = radio.getPacketLength();
+    int state = RADIOLIB_ERR_NONE;
+    if (len > 0 && (size_t)len <= max_len) {
+        state = radio.readData(buf, len);
+    } else {
+        len = 0;
+    }
+    if (rssi) *rssi = radio.getRSSI();
+    if (snr) *snr = radio.getSNR();
+
+    radio.clearIrqFlags(RADIOLIB_SX126X_IRQ_RX_DONE);
+    radio.startReceive();
+    return state == RADIOLIB_ERR_NONE ? len : state;
+}
+
+// =============================================================================
+// GPS NMEA BYTE STREAM
+// =============================================================================
+// The K257 carries a u-blox M10, configured with UBX-CFG-VALSET into the RAM
+// layer only: a power cycle brings it back at 9600 baud, 1 Hz.
+
+#define GPS_MODULE_BAUD         9600
+#define UBX_CFG_RATE_MEAS       0x30210001      // U2, ms between fixes
+#define UBX_CFG_UART1_BAUDRATE  0x40520001      // U4
+
+static hal_gps_rx_cb_t gpsRx = nullptr;
+
+static void ubxValset(uint32_t key, uint32_t value, uint8_t size) {
+    uint8_t msg[20] = {0xB5, 0x62, 0x06, 0x8A, (uint8_t)(8 + size), 0,
+                       0x00, 0x01, 0x00, 0x00};        // Version 0, RAM layer
+    memcpy(msg + 10, &key, 4);
+    memcpy(msg + 14, &value, size);
+
+    uint8_t a = 0, b = 0;
+    for (uint8_t i = 2; i < 14 + size; i++) {
+        a += msg[i];
+        b += a;
+    }
+    msg[14 + size] = a;
+    msg[15 + size] = b;
+    Serial1.write(msg, 16 + size);
+}
+
+static void gpsReceive() {
+    uint8_t buf[128];
+    size_t n;
+    while ((n = Serial1.read(buf, min((size_t)Serial1.available(), sizeof(buf)))) > 0) gpsRx(buf, n);
+}
+
+void hal_gps_begin(uint32_t baud, uint16_t rate_ms, size_t rx_buffer, hal_gps_rx_cb_t on_rx) {
+    Serial1.setRxBufferSize(rx_buffer);         // Must precede begin()
+    Serial1.begin(GPS_MODULE_BAUD, SERIAL_8N1, GPS_RX, GPS_TX);
+
+    if (rate_ms) ubxValset(UBX_CFG_RATE_MEAS, rate_ms, 2);
+    if (baud != GPS_MODULE_BAUD) {
+        ubxValset(UBX_CFG_UART1_BAUDRATE, baud, 4);
+        Serial1.flush();
+        delay(20);
+        Serial1.updateBaudRate(baud);
+        // Again at the new rate, for a module that kept it over our reset
+        if (rate_ms) ubxValset(UBX_CFG_RATE_MEAS, rate_ms, 2);
+    }
+
+    gpsRx = on_rx;
+    if (on_rx) Serial1.onReceive(gpsReceive);
+}
+
+size_t hal_gps_read(uint8_t* buf, size_t max_len) {
+    size_t avail = Serial1.available();
+    if (avail == 0) return 0;
+    return Serial1.read(buf, min(avail, max_len));
+}
+
+// Edge time only; the GPS task pairs it with the next whole-second RMC
+static volatile uint64_t ppsLocal = 0;
+static volatile uint32_t ppsCount = 0;
+
+static void IRAM_ATTR onPps() {
+    ppsLocal = esp_timer_get_time();
+    ppsCount++;
+}
+
+void hal_gps_pps_begin(uint8_t pin) {
+    pinMode(pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(pin), onPps, RISING);
+}
+
+uint32_t hal_gps_pps_last(uint64_t* local_us) {
+    uint32_t count;
+    do {
+        count = ppsCount;
+        *local_us = ppsLocal;
+    } while (count != ppsCount);
+    return count;
+}
+
+// =============================================================================
+// CLOCKS
+// =============================================================================
+// The RTC is the system clock; it survives soft resets and is restored from
+// the board RTC at boot when one is fitted.
+
+#define RTC_MIN_EPOCH           1704067200      // 2024-01-01, anything older was never set
+
+uint64_t hal_clock_us() {
+    return esp_timer_get_time();
+}
+
+bool hal_rtc_get(uint64_t* epoch_us) {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    if (tv.tv_sec < RTC_MIN_EPOCH) return false;
+    *epoch_us = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    return true;
+}
+
+void hal_rtc_set(uint64_t epoch_us) {
+    struct timeval tv = {(time_t)(epoch_us / 1000000), (suseconds_t)(epoch_us % 1000000)};
+    settimeofday(&tv, nullptr);
+}
+
+// =============================================================================
+// SD FILESYSTEM
+// =============================================================================
+bool hal_sd_begin() {
+    return instance.installSD();
+}
+
+uint64_t hal_sd_total_bytes() {
+    return SD.totalBytes();
+}
+
+uint64_t hal_sd_used_bytes() {
+    return SD.usedBytes();
+}
+
+// =============================================================================
+// DISPLAY SINK
+// =============================================================================
+bool hal_display_begin() {
+    beginLvglHelper(instance);
+    return true;
+}
+
+void hal_display_set_brightness(uint8_t level) {
+    instance.setBrightness(level);
+}
+
+void hal_display_flush(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    instance.pushColors(x, y, x + w, y + h, (uint16_t*)pixels);
+}
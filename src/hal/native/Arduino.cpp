@@ -0,0 +1,70 @@
+/**
+ * @file Arduino.cpp
+ * @brief RICK HAL - host stand-in for the Arduino core
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+EspClass ESP;
+
+// =============================================================================
+// TIME
+// =============================================================================
+static const auto bootTime = std::chrono::steady_clock::now();
+
+uint32_t millis() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+uint32_t micros() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// =============================================================================
+// RANDOM
+// =============================================================================
+long random(long max) {
+    if (max <= 0) return 0;
+    return ::random() % max;
+}
+
+long random(long min, long max) {
+    if (min >= max) return min;
+    return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    srandom(seed);
+}
+
+// =============================================================================
+// SERIAL
+// =============================================================================
+size_t HostSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+}
+
+// =============================================================================
+// CHIP INFO
+// =============================================================================
+uint64_t EspClass::getEfuseMac() {
+    // Locally administered, stable per host run
+    return 0x0000DEADBEEF0002ULL;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file Arduino.h
+ * @brief RICK HAL - host stand-in for the Arduino core
+ *
+ * Only the subset the RICK modules (and TinyGPSPlus) actually use.
+ */
+
+#ifndef RICK_NATIVE_ARDUINO_H
+#define RICK_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <arpa/inet.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#ifndef PI
+#define PI          3.1415926535897932384626433832795
+#endif
+#define HALF_PI     1.5707963267948966192313216916398
+#define TWO_PI      6.283185307179586476925286766559
+#define DEG_TO_RAD  0.017453292519943295769236907684886
+#define RAD_TO_DEG  57.295779513082320876798154814105
+
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x)        ((x) * (x))
+
+// =============================================================================
+// TIME
+// =============================================================================
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// =============================================================================
+// RANDOM
+// =============================================================================
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// =============================================================================
+// MEMORY (no PSRAM on the host - plain heap)
+// =============================================================================
+static inline void* ps_malloc(size_t size) { return malloc(size); }
+static inline void* ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+
+// =============================================================================
+// SERIAL (stdout)
+// =============================================================================
+class HostSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t print(const char* str) { return fputs(str, stdout) >= 0 ? strlen(str) : 0; }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t println() { return print("\n"); }
+    size_t println(const char* str) { return print(str) + println(); }
+    size_t println(long value) { return print(value) + println(); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    void flush() { fflush(stdout); }
+};
+
+extern HostSerial Serial;
+
+// =============================================================================
+// CHIP INFO
+// =============================================================================
+class EspClass {
+public:
+    uint64_t getEfuseMac();
+};
+
+extern EspClass ESP;
+
+#endif // RICK_NATIVE_ARDUINO_H
@@ -0,0 +1,199 @@
+/**
+ * @file SD.cpp
+ * @brief RICK HAL - host stand-in for the Arduino SD/File API
+ */
+
+#include "SD.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+SDClass SD;
+
+struct HostFileImpl {
+    std::string path;       // Card path, as the modules see it
+    std::string hostPath;
+    std::string name;
+    FILE* fp = nullptr;
+    DIR* dir = nullptr;
+
+    ~HostFileImpl() {
+        if (fp) fclose(fp);
+        if (dir) closedir(dir);
+    }
+};
+
+// =============================================================================
+// FILE
+// =============================================================================
+File::operator bool() const {
+    return impl_ && (impl_->fp || impl_->dir);
+}
+
+const char* File::name() const {
+    return impl_ ? impl_->name.c_str() : "";
+}
+
+const char* File::path() const {
+    return impl_ ? impl_->path.c_str() : "";
+}
+
+size_t File::size() const {
+    if (!impl_) return 0;
+    struct stat st;
+    if (impl_->fp) fflush(impl_->fp);
+    if (stat(impl_->hostPath.c_str(), &st) != 0) return 0;
+    return st.st_size;
+}
+
+bool File::isDirectory() const {
+    return impl_ && impl_->dir;
+}
+
+File File::openNextFile() {
+    if (!impl_ || !impl_->dir) return File();
+
+    struct dirent* ent;
+    while ((ent = readdir(impl_->dir)) != nullptr) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        std::string child = impl_->path;
+        if (child.empty() || child.back() != '/') child += '/';
+        child += ent->d_name;
+        return SD.open(child.c_str(), FILE_READ);
+    }
+    return File();
+}
+
+void File::close() {
+    impl_.reset();
+}
+
+size_t File::write(const uint8_t* buf, size_t len) {
+    if (!impl_ || !impl_->fp) return 0;
+    return fwrite(buf, 1, len, impl_->fp);
+}
+
+size_t File::printf(const char* fmt, ...) {
+    if (!impl_ || !impl_->fp) return 0;
+    va_list args;
+    va_start(args, fmt);
+    int n = vfprintf(impl_->fp, fmt, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+}
+
+int File::read() {
+    if (!impl_ || !impl_->fp) return -1;
+    int c = fgetc(impl_->fp);
+    return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+    if (!impl_ || !impl_->fp) return 0;
+    return fread(buf, 1, len, impl_->fp);
+}
+
+int File::available() {
+    if (!impl_ || !impl_->fp) return 0;
+    long pos = ftell(impl_->fp);
+    size_t total = size();
+    return pos < 0 || (size_t)pos >= total ? 0 : (int)(total - pos);
+}
+
+bool File::seek(uint32_t pos) {
+    if (!impl_ || !impl_->fp) return false;
+    return fseek(impl_->fp, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+    if (!impl_ || !impl_->fp) return 0;
+    long pos = ftell(impl_->fp);
+    return pos < 0 ? 0 : pos;
+}
+
+void File::flush() {
+    if (impl_ && impl_->fp) fflush(impl_->fp);
+}
+
+// =============================================================================
+// SD
+// =============================================================================
+bool SDClass::begin() {
+    if (root_.empty()) {
+        const char* env = getenv("RICK_SD_ROOT");
+        setRoot(env ? env : "./sdcard");
+    }
+    ::mkdir(root_.c_str(), 0755);
+
+    struct stat st;
+    return stat(root_.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+void SDClass::setRoot(const char* dir) {
+    root_ = dir;
+    while (root_.size() > 1 && root_.back() == '/') root_.pop_back();
+}
+
+std::string SDClass::hostPath(const char* path) const {
+    std::string p = root_;
+    if (path[0] != '/') p += '/';
+    p += path;
+    return p;
+}
+
+File SDClass::open(const char* path, const char* mode) {
+    auto impl = std::make_shared<HostFileImpl>();
+    impl->path = path;
+    impl->hostPath = hostPath(path);
+    const char* slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+
+    struct stat st;
+    if (stat(impl->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(impl->hostPath.c_str());
+    } else {
+        // Binary mode, "r" opens for read+seek like the ESP32 VFS
+        std::string m = mode;
+        if (m.find('b') == std::string::npos) m += 'b';
+        impl->fp = fopen(impl->hostPath.c_str(), m.c_str());
+    }
+
+    if (!impl->fp && !impl->dir) return File();
+    return File(impl);
+}
+
+bool SDClass::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool SDClass::mkdir(const char* path) {
+    // Single level, same as the ESP32 VFS
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool SDClass::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool SDClass::remove(const char* path) {
+    return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool SDClass::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+uint64_t SDClass::totalBytes() {
+    struct statvfs vfs;
+    if (statvfs(root_.c_str(), &vfs) != 0) return 0;
+    return (uint64_t)vfs.f_blocks * vfs.f_frsize;
+}
+
+uint64_t SDClass::usedBytes() {
+    struct statvfs vfs;
+    if (statvfs(root_.c_str(), &vfs) != 0) return 0;
+    return (uint64_t)(vfs.f_blocks - vfs.f_bfree) * vfs.f_frsize;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file SD.h
+ * @brief RICK HAL - host stand-in for the Arduino SD/File API
+ *
+ * Card paths are mapped under a local directory (RICK_SD_ROOT, default
+ * ./sdcard) so sessions written by the modules can be inspected directly.
+ */
+
+#ifndef RICK_NATIVE_SD_H
+#define RICK_NATIVE_SD_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+struct HostFileImpl;
+
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<HostFileImpl> impl) : impl_(impl) {}
+
+    operator bool() const;
+    const char* name() const;
+    const char* path() const;
+    size_t size() const;
+    bool isDirectory() const;
+    File openNextFile();
+    void close();
+
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t len);
+    size_t print(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+    size_t println() { return print("\n"); }
+    size_t println(const char* str) { return print(str) + println(); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    int read();
+    size_t read(uint8_t* buf, size_t len);
+    int available();
+    bool seek(uint32_t pos);
+    size_t position() const;
+    void flush();
+
+private:
+    std::shared_ptr<HostFileImpl> impl_;
+};
+
+class SDClass {
+public:
+    bool begin();
+    void setRoot(const char* dir);
+    const char* root() const { return root_.c_str(); }
+
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+
+private:
+    std::string hostPath(const char* path) const;
+    std::string root_;
+};
+
+extern SDClass SD;
+
+#endif // RICK_NATIVE_SD_H
@@ -0,0 +1,33 @@
+/**
+ * @file esp_wifi.h
+ * @brief RICK HAL - host stand-in for the ESP-IDF WiFi types
+ *
+ * Types only; radio access goes through hal.h.
+ */
+
+#ifndef RICK_NATIVE_ESP_WIFI_H
+#define RICK_NATIVE_ESP_WIFI_H
+
+#include <stdint.h>
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK,
+    WIFI_AUTH_WAPI_PSK,
+    WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+typedef enum {
+    WIFI_PKT_MGMT,
+    WIFI_PKT_CTRL,
+    WIFI_PKT_DATA,
+    WIFI_PKT_MISC,
+} wifi_promiscuous_pkt_type_t;
+
+#endif // RICK_NATIVE_ESP_WIFI_H
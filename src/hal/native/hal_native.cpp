@@ -0,0 +1,481 @@
+/**
+ * @file hal_native.cpp
+ * @brief RICK HAL - Linux stand-ins
+ *
+ * WiFi scans and frames come from replay files (or synthetic load), LoRa is
+ * an in-memory air, the GPS UART replays an NMEA log at line rate, the SD card
+ * is a local directory and the display is a RAM framebuffer.
+ */
+
+#include "hal_native.h"
+#include <SD.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// WIFI SCAN RESULTS
+// =============================================================================
+static uint8_t currentChannel = 1;
+static uint8_t stationMac[6] = {0x02, 0x00, 0xDE, 0xAD, 0xBE, 0xEF};
+
+static FILE* scanFile = nullptr;
+static std::vector<hal_ap_record_t> scanResults;
+static bool scanPending = false;
+static bool scanReady = false;
+
+static uint32_t synthPopulation = 0;
+static uint16_t synthPerSweep = 0;
+static uint32_t synthState = 0;
+
+static uint32_t synthNext() {
+    // xorshift32 - deterministic sweeps for a given seed
+    synthState ^= synthState << 13;
+    synthState ^= synthState >> 17;
+    synthState ^= synthState << 5;
+    return synthState;
+}
+
+static void synthRecord(uint32_t id, hal_ap_record_t* rec) {
+    rec->bssid[0] = 0x02;
+    rec->bssid[1] = 0x52;  // 'R'
+    rec->bssid[2] = (id >> 24) & 0xFF;
+    rec->bssid[3] = (id >> 16) & 0xFF;
+    rec->bssid[4] = (id >> 8) & 0xFF;
+    rec->bssid[5] = id & 0xFF;
+    if (id % 17 == 0) {
+        rec->ssid[0] = '\0';  // Some hidden networks
+    } else {
+        snprintf(rec->ssid, sizeof(rec->ssid), "Dimension-C%lu", (unsigned long)id);
+    }
+    rec->channel = 1 + id % 13;
+    rec->authmode = (wifi_auth_mode_t)(id % 5 == 0 ? WIFI_AUTH_OPEN : WIFI_AUTH_WPA2_PSK);
+    rec->rssi = -40 - (int8_t)(synthNext() % 55);
+}
+
+static void loadSweep() {
+    scanResults.clear();
+
+    if (synthPopulation > 0) {
+        for (uint16_t i = 0; i < synthPerSweep; i++) {
+            hal_ap_record_t rec;
+            synthRecord(synthNext() % synthPopulation, &rec);
+            scanResults.push_back(rec);
+        }
+        return;
+    }
+
+    if (!scanFile) return;
+
+    char line[160];
+    bool rewound = false;
+    while (true) {
+        if (!fgets(line, sizeof(line), scanFile)) {
+            if (!scanResults.empty() || rewound) break;
+            rewind(scanFile);
+            rewound = true;
+            continue;
+        }
+        if (line[0] == '\n' || line[0] == '\r') {
+            if (!scanResults.empty()) break;
+            continue;
+        }
+        if (line[0] == '#') continue;
+
+        hal_ap_record_t rec;
+        unsigned int b[6];
+        int rssi, channel, auth;
+        char ssid[64] = "";
+        int fields = sscanf(line, "%x:%x:%x:%x:%x:%x,%63[^,],%d,%d,%d",
+                            &b[0], &b[1], &b[2], &b[3], &b[4], &b[5],
+                            ssid, &rssi, &channel, &auth);
+        if (fields != 10) {
+            // Hidden network - empty SSID field
+            ssid[0] = '\0';
+            fields = sscanf(line, "%x:%x:%x:%x:%x:%x,,%d,%d,%d",
+                            &b[0], &b[1], &b[2], &b[3], &b[4], &b[5],
+                            &rssi, &channel, &auth);
+            if (fields != 9) continue;
+        }
+
+        for (int i = 0; i < 6; i++) rec.bssid[i] = b[i];
+        strncpy(rec.ssid, ssid, 32);
+        rec.ssid[32] = '\0';
+        rec.rssi = rssi;
+        rec.channel = channel;
+        rec.authmode = (wifi_auth_mode_t)auth;
+        scanResults.push_back(rec);
+    }
+}
+
+bool hal_native_scan_open(const char* path) {
+    if (scanFile) fclose(scanFile);
+    scanFile = fopen(path, "r");
+    synthPopulation = 0;
+    return scanFile != nullptr;
+}
+
+void hal_native_scan_synth(uint32_t population, uint16_t per_sweep, uint32_t seed) {
+    synthPopulation = population;
+    synthPerSweep = per_sweep;
+    synthState = seed ? seed : 0x5EED;
+}
+
+void hal_wifi_begin() {
+    Serial.println("[HAL] WiFi STA (host stand-in)");
+}
+
+void hal_wifi_end() {
+    hal_wifi_promisc(false);
+}
+
+bool hal_wifi_scan_start(bool show_hidden, bool passive, uint32_t ms_per_chan) {
+    (void)show_hidden; (void)passive; (void)ms_per_chan;
+    scanPending = true;
+    scanReady = false;
+    return true;
+}
+
+int16_t hal_wifi_scan_poll() {
+    if (scanPending) {
+        // Replayed sweeps complete on the first poll
+        loadSweep();
+        scanPending = false;
+        scanReady = true;
+    }
+    if (!scanReady) return HAL_SCAN_FAILED;
+    return scanResults.size();
+}
+
+bool hal_wifi_scan_get(uint16_t index, hal_ap_record_t* out) {
+    if (!scanReady || index >= scanResults.size()) return false;
+    *out = scanResults[index];
+    return true;
+}
+
+uint16_t hal_wifi_scan_fetch(hal_ap_record_t* out, uint16_t max) {
+    if (!scanReady) return 0;
+    uint16_t count = scanResults.size() < max ? scanResults.size() : max;
+    memcpy(out, scanResults.data(), count * sizeof(hal_ap_record_t));
+    return count;
+}
+
+void hal_wifi_scan_delete() {
+    scanResults.clear();
+    scanReady = false;
+}
+
+void hal_wifi_set_channel(uint8_t channel) {
+    currentChannel = channel;
+}
+
+// =============================================================================
+// PROMISCUOUS FRAME SOURCE
+// =============================================================================
+#define PCAP_MAGIC              0xA1B2C3D4
+#define PCAP_MAGIC_NS           0xA1B23C4D
+#define LINKTYPE_IEEE802_11     105
+#define LINKTYPE_RADIOTAP       127
+
+static hal_frame_cb_t frameCallback = nullptr;
+static bool promiscEnabled = false;
+static FILE* pcapFile = nullptr;
+static uint32_t pcapLinkType = 0;
+static std::vector<uint8_t> pcapBuf;
+
+bool hal_native_frames_open(const char* path) {
+    if (pcapFile) fclose(pcapFile);
+    pcapFile = fopen(path, "rb");
+    if (!pcapFile) return false;
+
+    uint32_t hdr[6];
+    if (fread(hdr, sizeof(hdr), 1, pcapFile) != 1 ||
+        (hdr[0] != PCAP_MAGIC && hdr[0] != PCAP_MAGIC_NS)) {
+        Serial.printf("[HAL] %s: not a little-endian pcap\n", path);
+        fclose(pcapFile);
+        pcapFile = nullptr;
+        return false;
+    }
+
+    pcapLinkType = hdr[5];
+    if (pcapLinkType != LINKTYPE_IEEE802_11 && pcapLinkType != LINKTYPE_RADIOTAP) {
+        Serial.printf("[HAL] %s: unsupported linktype %u\n", path, pcapLinkType);
+        fclose(pcapFile);
+        pcapFile = nullptr;
+        return false;
+    }
+    return true;
+}
+
+uint32_t hal_native_frames_pump(uint32_t max_frames) {
+    if (!pcapFile) return 0;
+
+    uint32_t delivered = 0;
+    while (delivered < max_frames) {
+        uint32_t rec[4];  // ts_sec, ts_usec, incl_len, orig_len
+        if (fread(rec, sizeof(rec), 1, pcapFile) != 1) break;
+
+        pcapBuf.resize(rec[2]);
+        if (fread(pcapBuf.data(), 1, rec[2], pcapFile) != rec[2]) break;
+
+        const uint8_t* payload = pcapBuf.data();
+        uint32_t len = rec[2];
+        int8_t rssi = -60;
+
+        if (pcapLinkType == LINKTYPE_RADIOTAP) {
+            if (len < 8) continue;
+            uint16_t rtLen = payload[2] | (payload[3] << 8);
+            if (rtLen > len) continue;
+            payload += rtLen;
+            len -= rtLen;
+        }
+        if (len < 2 || !promiscEnabled || !frameCallback) continue;
+
+        hal_frame_t frame;
+        frame.payload = payload;
+        frame.len = len > 0xFFFF ? 0xFFFF : len;
+        frame.rssi = rssi;
+        frame.channel = currentChannel;
+        frame.timestamp = rec[0] * 1000000UL + rec[1];
+        switch ((payload[0] >> 2) & 0x03) {
+            case 0: frame.type = WIFI_PKT_MGMT; break;
+            case 1: frame.type = WIFI_PKT_CTRL; break;
+            case 2: frame.type = WIFI_PKT_DATA; break;
+            default: frame.type = WIFI_PKT_MISC; break;
+        }
+        frameCallback(&frame);
+        delivered++;
+    }
+    return delivered;
+}
+
+void hal_wifi_promisc(bool enable) {
+    promiscEnabled = enable;
+}
+
+void hal_wifi_set_frame_cb(hal_frame_cb_t callback) {
+    frameCallback = callback;
+}
+
+bool hal_wifi_tx_raw(const uint8_t* frame, uint16_t len) {
+    (void)frame; (void)len;
+    return true;  // Nothing on the air
+}
+
+void hal_wifi_get_mac(uint8_t* mac) {
+    memcpy(mac, stationMac, 6);
+}
+
+void hal_wifi_set_mac(const uint8_t* mac) {
+    memcpy(stationMac, mac, 6);
+}
+
+// =============================================================================
+// LORA (SX1262) PACKET I/O
+// =============================================================================
+typedef struct {
+    std::vector<uint8_t> data;
+    int16_t rssi;
+} air_packet_t;
+
+static std::deque<air_packet_t> loraAir;
+static bool loraLoopback = false;
+static bool loraReceiving = false;
+
+void hal_native_lora_inject(const uint8_t* data, size_t len, int16_t rssi) {
+    air_packet_t pkt;
+    pkt.data.assign(data, data + len);
+    pkt.rssi = rssi;
+    loraAir.push_back(pkt);
+}
+
+void hal_native_lora_loopback(bool enable) {
+    loraLoopback = enable;
+}
+
+bool hal_lora_begin(float freq, float bw, uint8_t sf, uint8_t cr,
+                    uint8_t sync, int8_t power, uint16_t preamble) {
+    Serial.printf("[HAL] LoRa %.1f MHz BW%.1f SF%u CR4/%u sync 0x%02X %d dBm pre %u (host stand-in)\n",
+                  freq, bw, sf, cr, sync, power, preamble);
+    return true;
+}
+
+int hal_lora_transmit(const uint8_t* data, size_t len) {
+    if (loraLoopback) hal_native_lora_inject(data, len, -30);
+    return 0;
+}
+
+void hal_lora_start_receive() {
+    loraReceiving = true;
+}
+
+void hal_lora_standby() {
+    loraReceiving = false;
+}
+
+bool hal_lora_available() {
+    return loraReceiving && !loraAir.empty();
+}
+
+int hal_lora_receive(uint8_t* buf, size_t max_len, int16_t* rssi, float* snr) {
+    if (!hal_lora_available()) return 0;
+
+    air_packet_t pkt = loraAir.front();
+    loraAir.pop_front();
+    if (rssi) *rssi = pkt.rssi;
+    if (snr) *snr = 9.5f;
+    if (pkt.data.size() > max_len) return 0;
+    memcpy(buf, pkt.data.data(), pkt.data.size());
+    return pkt.data.size();
+}
+
+// =============================================================================
+// GPS NMEA BYTE STREAM
+// =============================================================================
+static FILE* nmeaFile = nullptr;
+static bool nmeaRealtime = true;
+static uint32_t gpsBaud = 9600;
+static uint32_t gpsLastRead = 0;
+static hal_gps_rx_cb_t gpsRx = nullptr;
+
+bool hal_native_gps_open(const char* path, bool realtime) {
+    if (nmeaFile) fclose(nmeaFile);
+    nmeaFile = fopen(path, "rb");
+    nmeaRealtime = realtime;
+    gpsLastRead = millis();
+    return nmeaFile != nullptr;
+}
+
+void hal_gps_begin(uint32_t baud, uint16_t rate_ms, size_t rx_buffer, hal_gps_rx_cb_t on_rx) {
+    (void)rate_ms; (void)rx_buffer;
+    gpsBaud = baud;
+    gpsLastRead = millis();
+    gpsRx = on_rx;
+}
+
+// No pulse on the host; the clock runs on NMEA time alone
+void hal_gps_pps_begin(uint8_t pin) {
+    (void)pin;
+}
+
+uint32_t hal_gps_pps_last(uint64_t* local_us) {
+    *local_us = 0;
+    return 0;
+}
+
+size_t hal_native_gps_pump(size_t max_bytes) {
+    if (!gpsRx) return 0;
+    uint8_t buf[256];
+    size_t total = 0;
+    while (total < max_bytes) {
+        size_t n = hal_gps_read(buf, min(sizeof(buf), max_bytes - total));
+        if (n == 0) break;
+        gpsRx(buf, n);
+        total += n;
+    }
+    return total;
+}
+
+size_t hal_gps_read(uint8_t* buf, size_t max_len) {
+    if (!nmeaFile) return 0;
+
+    size_t want = max_len;
+    if (nmeaRealtime) {
+        // 8N1 - ten bits on the wire per byte
+        uint32_t now = millis();
+        size_t due = (size_t)(now - gpsLastRead) * gpsBaud / 10000;
+        if (due == 0) return 0;
+        want = min(want, due);
+        gpsLastRead = now;
+    }
+
+    size_t n = fread(buf, 1, want, nmeaFile);
+    if (n < want) {
+        rewind(nmeaFile);
+        n += fread(buf + n, 1, want - n, nmeaFile);
+    }
+    return n;
+}
+
+// =============================================================================
+// CLOCKS
+// =============================================================================
+static const auto clockBoot = std::chrono::steady_clock::now();
+
+uint64_t hal_clock_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - clockBoot).count();
+}
+
+// The host clock stands in for the RTC but is never set from here
+bool hal_rtc_get(uint64_t* epoch_us) {
+    *epoch_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return true;
+}
+
+void hal_rtc_set(uint64_t epoch_us) {
+    (void)epoch_us;
+}
+
+// =============================================================================
+// SD FILESYSTEM
+// =============================================================================
+bool hal_sd_begin() {
+    bool ok = SD.begin();
+    if (ok) Serial.printf("[HAL] SD card -> %s\n", SD.root());
+    return ok;
+}
+
+uint64_t hal_sd_total_bytes() {
+    return SD.totalBytes();
+}
+
+uint64_t hal_sd_used_bytes() {
+    return SD.usedBytes();
+}
+
+// =============================================================================
+// DISPLAY SINK
+// =============================================================================
+#define FB_W 480
+#define FB_H 222
+
+static std::vector<uint16_t> framebuffer;
+static uint8_t displayBrightness = 0;
+
+bool hal_display_begin() {
+    framebuffer.assign(FB_W * FB_H, 0);
+    return true;
+}
+
+void hal_display_set_brightness(uint8_t level) {
+    displayBrightness = level;
+}
+
+void hal_display_flush(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    if (framebuffer.empty()) return;
+    for (uint16_t row = 0; row < h && y + row < FB_H; row++) {
+        uint16_t cols = min<uint16_t>(w, FB_W - min<uint16_t>(x, FB_W));
+        memcpy(&framebuffer[(y + row) * FB_W + x], &pixels[row * w], cols * sizeof(uint16_t));
+    }
+}
+
+bool hal_native_display_dump(const char* path) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    fprintf(fp, "P6\n%d %d\n255\n", FB_W, FB_H);
+    for (size_t i = 0; i < framebuffer.size(); i++) {
+        uint16_t px = framebuffer[i];
+        uint8_t rgb[3] = {
+            (uint8_t)((px >> 11) << 3),
+            (uint8_t)(((px >> 5) & 0x3F) << 2),
+            (uint8_t)((px & 0x1F) << 3)
+        };
+        fwrite(rgb, 1, 3, fp);
+    }
+    fclose(fp);
+    return true;
+}
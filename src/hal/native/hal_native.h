@@ -0,0 +1,82 @@
+/**
+ * @file hal_native.h
+ * @brief RICK HAL - host-only controls for the Linux stand-ins
+ *
+ * Feeds the stand-ins from replay files or synthetic load so the modules can
+ * be driven and timed off the device.
+ */
+
+#ifndef RICK_HAL_NATIVE_H
+#define RICK_HAL_NATIVE_H
+
+#include "../hal.h"
+
+// =============================================================================
+// WIFI SCAN REPLAY
+// =============================================================================
+
+/**
+ * Replay sweeps from a text file, one AP per line:
+ *   aa:bb:cc:dd:ee:ff,ssid,rssi,channel,authmode
+ * A blank line ends a sweep; the file loops at EOF.
+ */
+bool hal_native_scan_open(const char* path);
+
+/**
+ * Synthetic sweeps drawn from a fixed population of APs
+ */
+void hal_native_scan_synth(uint32_t population, uint16_t per_sweep, uint32_t seed);
+
+// =============================================================================
+// FRAME REPLAY
+// =============================================================================
+
+/**
+ * Replay a classic pcap (LINKTYPE_IEEE802_11 or _RADIOTAP) into the frame callback
+ */
+bool hal_native_frames_open(const char* path);
+
+/**
+ * Deliver up to max_frames frames, returns frames delivered (0 at EOF)
+ */
+uint32_t hal_native_frames_pump(uint32_t max_frames);
+
+// =============================================================================
+// LORA
+// =============================================================================
+
+/**
+ * Queue a packet as if received over the air
+ */
+void hal_native_lora_inject(const uint8_t* data, size_t len, int16_t rssi);
+
+/**
+ * Deliver transmitted packets back to our own receiver
+ */
+void hal_native_lora_loopback(bool enable);
+
+// =============================================================================
+// GPS
+// =============================================================================
+
+/**
+ * Replay an NMEA log, paced at the UART baud rate unless realtime is false
+ */
+bool hal_native_gps_open(const char* path, bool realtime);
+
+/**
+ * Deliver up to max_bytes of the log to the hal_gps_begin() callback, as the
+ * UART event task would
+ */
+size_t hal_native_gps_pump(size_t max_bytes);
+
+// =============================================================================
+// DISPLAY
+// =============================================================================
+
+/**
+ * Write the current framebuffer as a binary PPM
+ */
+bool hal_native_display_dump(const char* path);
+
+#endif // RICK_HAL_NATIVE_H
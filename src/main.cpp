@@ -6,13 +6,18 @@
  */
 
 #include <LilyGoLib.h>
-#include <LV_Helper.h>
-#include <WiFi.h>
-#include <esp_wifi.h>
 #include <NimBLEDevice.h>
 #include <SD.h>
-#include <TinyGPSPlus.h>
 #include "config.h"
+#include "hal/hal.h"
+#include "wifi/sniffer.h"
+#include "wifi/frame_ring.h"
+#include "wifi/hop_scheduler.h"
+#include "wifi/decloak.h"
+#include "gps/nmea_stream.h"
+#include "gps/nmea_parser.h"
+#include "gps/utc_clock.h"
+#include "core/service.h"
 
 // =============================================================================
 // HAPTIC FEEDBACK LEVELS
@@ -24,34 +29,48 @@
 // =============================================================================
 // STATE
 // =============================================================================
+// Each block is owned by one task (see TASKS); other tasks only reach it
+// through the queues and the service snapshots below.
 static screen_t currentScreen = SCREEN_BOOT;
 static int menuIndex = 0;
 static uint32_t totalXP = 0;
 static rick_rank_t currentRank = RANK_MORTY;
 static bool kbBacklightOn = true;
 
-// WiFi scanner state
-static bool wifiScanning = false;
-static uint16_t networkCount = 0;
+// WiFi scanner state (UI side)
+static bool wifiScanning = false;               // Portal asked for a scan
 static int8_t scanChannel = 1;
-static uint32_t lastChannelHop = 0;
-static uint32_t lastWifiScan = 0;
+static hop_policy_t portalHopPolicy = WIFI_HOP_POLICY;
+
+// Network table, merged in place from sniffed beacons (radio task)
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[33];
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+    uint32_t lastSeen;
+} portal_net_t;
+
+static portal_net_t portalNets[WIFI_MAX_NETWORKS];
+static uint16_t portalNetCount = 0;
+static frame_ring_t portalRing;
+static hop_scheduler_t portalHop;
+static hop_policy_t radioHopPolicy = WIFI_HOP_POLICY;
+static decloak_table_t portalDecloak;           // Hidden BSSIDs waiting to be named
+static uint32_t lastPortalPublish = 0;
 
 // BLE spam state
-static bool bleSpamming = false;
+static bool bleSpamming = false;                // UI side
 static ble_target_t bleTarget = BLE_TARGET_ALL;
-static uint32_t bleSpamCount = 0;
-static uint32_t lastBleSpam = 0;
+static ble_target_t radioBleTarget = BLE_TARGET_ALL;
+static uint32_t radioXP = 0;                    // Earned by the radio task, not yet posted
 
 // GPS Wardriving state
-static bool gpsActive = false;
-static bool gpsFix = false;
-static double gpsLat = 0, gpsLon = 0;
-static uint32_t gpsNetworksLogged = 0;
-static uint32_t lastGpsUpdate = 0;
-
-// LoRa Mesh state
-static bool loraActive = false;
+static bool gpsActive = false;                  // UI side
+static nmea_stream_t gpsStream;                 // UART event task -> GPS task
+static nmea_parser_t gpsParser;                 // GPS task
+
+// LoRa Mesh state (mesh task)
 static bool loraInitialized = false;
 static uint32_t loraMsgSent = 0;
 static uint32_t loraMsgRecv = 0;
@@ -64,12 +83,145 @@ static uint8_t settingsLoraFreq = 0;  // 0=915MHz, 1=868MHz
 static uint8_t settingsIndex = 0;
 static bool settingsEditing = false;
 
-// SD Card state
+// SD Card state (storage task)
 static bool sdCardReady = false;
 static uint32_t sdTotalMB = 0;
 static uint32_t sdUsedMB = 0;
 static int fileCount = 0;
 
+// =============================================================================
+// SERVICES
+// =============================================================================
+// Background subsystems run by their task on their own cadence, whichever
+// screen is showing. Screens only read the snapshots.
+
+typedef enum {
+    RUNNER_RADIO = 0,
+    RUNNER_GPS,
+    RUNNER_MESH
+} runner_t;
+
+// Strongest networks, published by the wifi service for the Portal screen
+typedef struct {
+    char ssid[33];
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} portal_row_t;
+
+typedef struct {
+    portal_row_t rows[WIFI_PORTAL_ROWS];
+    uint8_t rowCount;
+    uint16_t active;            // Networks heard within WIFI_SCAN_TIMEOUT_MS
+    int8_t channel;
+    hop_policy_t policy;
+} portal_view_t;
+
+typedef struct {
+    uint32_t sent;
+} ble_view_t;
+
+typedef struct {
+    bool fix;
+    int32_t lat, lon;           // 1e-7 degrees
+    uint32_t fixMs;             // millis() when the fix's sentence arrived
+} gps_view_t;
+
+typedef struct {
+    uint32_t logged;            // Network sightings logged with a fix
+} wardrive_view_t;
+
+typedef struct {
+    bool ready;
+    uint32_t sent, recv;
+    int16_t rssi;
+    char msg[64];
+} mesh_view_t;
+
+static service_registry_t services;
+static service_t svcWifi, svcBle, svcGps, svcWardrive, svcMesh;
+
+// Snapshot storage, written only through service_publish()
+static portal_view_t wifiState;
+static ble_view_t bleState;
+static gps_view_t gpsState;
+static wardrive_view_t wardriveState;
+static mesh_view_t meshState;
+
+// Runner-side working copies
+static ble_view_t bleNow;
+static gps_view_t gpsNow;
+static wardrive_view_t wardriveNow;
+
+// =============================================================================
+// TASK MESSAGES
+// =============================================================================
+// Workers never block on the UI: a full UI queue drops the event and counts
+// it. Commands from the UI are rare and small.
+
+typedef enum {
+    UI_EV_XP = 0,
+    UI_EV_SD_STATUS,
+    UI_EV_SD_FILE,
+    UI_EV_SD_FILES_DONE
+} ui_event_type_t;
+
+typedef struct {
+    ui_event_type_t type;
+    union {
+        uint32_t value;                                         // XP
+        struct { bool ready; uint32_t usedMB, totalMB; } sd;
+        struct { int8_t index; char line[64]; } file;           // DONE: index = count
+    };
+} ui_event_t;
+
+typedef enum {
+    TASK_CMD_WAKE = 0,          // A service request changed
+    RADIO_CMD_HOP_POLICY,       // value = policy | locked channel << 8
+    RADIO_CMD_BLE_TARGET,       // value = ble_target_t
+    MESH_CMD_BEACON,
+    STORAGE_CMD_MOUNT,
+    STORAGE_CMD_LIST
+} task_cmd_type_t;
+
+typedef struct {
+    task_cmd_type_t type;
+    int32_t value;
+} task_cmd_t;
+
+static TaskHandle_t taskUi, taskRadio, taskStorage, taskGps, taskMesh;
+static QueueHandle_t uiQueue;                   // ui_event_t, workers -> UI
+static QueueHandle_t radioQueue;                // task_cmd_t, UI -> radio
+static QueueHandle_t meshQueue;
+static QueueHandle_t storageQueue;
+static volatile uint32_t uiEventsDropped = 0;
+
+static bool uiPost(const ui_event_t* ev) {
+    if (xQueueSend(uiQueue, ev, 0) == pdTRUE) return true;
+    uiEventsDropped++;
+    return false;
+}
+
+static void earnXP(uint32_t points) {
+    ui_event_t ev = {};
+    ev.type = UI_EV_XP;
+    ev.value = points;
+    uiPost(&ev);
+}
+
+static void postCommand(QueueHandle_t queue, task_cmd_type_t type, int32_t value) {
+    task_cmd_t cmd = {type, value};
+    if (xQueueSend(queue, &cmd, pdMS_TO_TICKS(TASK_CMD_WAIT_MS)) != pdTRUE) {
+        Serial.printf("[TASKS] Command %d dropped\n", type);
+    }
+}
+
+// Enable or disable a service and wake its runner
+static void setService(service_t* svc, bool on) {
+    service_request(svc, on);
+    if (svc->runner == RUNNER_RADIO) postCommand(radioQueue, TASK_CMD_WAKE, 0);
+    else if (svc->runner == RUNNER_MESH) postCommand(meshQueue, TASK_CMD_WAKE, 0);
+}
+
 // =============================================================================
 // COLORS (Rick & Morty Theme)
 // =============================================================================
@@ -111,7 +263,7 @@ static lv_obj_t* lblRank;
 
 // Portal screen (WiFi Scanner)
 static lv_obj_t* lblPortalStatus;
-static lv_obj_t* lblPortalNetworks[8];
+static lv_obj_t* lblPortalNetworks[WIFI_PORTAL_ROWS];
 static lv_obj_t* lblPortalCount;
 
 // Schwifty screen (BLE Spam)
@@ -267,7 +419,7 @@ void createPortalScreen() {
     lv_obj_set_style_text_color(lblPortalCount, colCyan, 0);
     lv_label_set_text(lblPortalCount, "Networks: 0 | Ch: 1");
 
-    for (int i = 0; i < 8; i++) {
+    for (int i = 0; i < WIFI_PORTAL_ROWS; i++) {
         lblPortalNetworks[i] = lv_label_create(scrPortal);
         lv_obj_set_pos(lblPortalNetworks[i], 16, UI_MAIN_Y + 28 + i * 18);
         lv_obj_set_style_text_color(lblPortalNetworks[i], colWhite, 0);
@@ -277,7 +429,7 @@ void createPortalScreen() {
     lv_obj_t* lblHint = lv_label_create(scrPortal);
     lv_obj_set_pos(lblHint, 16, UI_BOT_Y + 4);
     lv_obj_set_style_text_color(lblHint, colGray, 0);
-    lv_label_set_text(lblHint, "Space: Start/Stop | B/Long: Back | M: Menu");
+    lv_label_set_text(lblHint, "Space: Start/Stop | H: Hop | B/Long: Back | M: Menu");
 }
 
 // =============================================================================
@@ -524,59 +676,202 @@ void menuSelect() { gotoScreen(MENU_ITEMS[menuIndex].screen); }
 // =============================================================================
 // WIFI SCANNER
 // =============================================================================
+// The wifi service (radio task) owns the table, hop schedule and decloaker;
+// the Portal screen draws its snapshot.
+
+// WiFi driver task - copy only, parsing happens in the radio task
+static void onPortalFrame(const hal_frame_t* frame) {
+    frame_ring_push(&portalRing, frame);
+}
+
+static void wifiStart() {
+    hal_wifi_begin();
+    if (!portalRing.slots) frame_ring_init(&portalRing, WIFI_FRAME_RING_SLOTS);
+    frame_ring_reset(&portalRing);
+    hal_wifi_set_frame_cb(onPortalFrame);
+    hal_wifi_promisc(true);
+    hop_init(&portalHop, radioHopPolicy, 1, 13, WIFI_CHANNEL_HOP_MS, WIFI_CHANNEL_FLOOR_MS);
+    decloak_init(&portalDecloak, WIFI_DECLOAK_EXPIRY_MS);
+    hal_wifi_set_channel(portalHop.channel);
+    portalNetCount = 0;
+    lastPortalPublish = 0;
+}
+
+static void wifiStop() {
+    hal_wifi_promisc(false);
+    hal_wifi_set_frame_cb(nullptr);
+    hal_wifi_end();
+}
+
+// Portal and wardriving each keep the scan alive
+static void syncWifiService() {
+    setService(&svcWifi, wifiScanning || gpsActive);
+}
+
 void startWifiScan() {
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect();
     wifiScanning = true;
-    networkCount = 0;
+    syncWifiService();
     lv_label_set_text(lblPortalStatus, "SCANNING");
     lv_obj_set_style_text_color(lblPortalStatus, colGreen, 0);
 }
 
 void stopWifiScan() {
     wifiScanning = false;
-    WiFi.mode(WIFI_OFF);
+    syncWifiService();
     lv_label_set_text(lblPortalStatus, "STOPPED");
     lv_obj_set_style_text_color(lblPortalStatus, colYellow, 0);
 }
 
-void updateWifiScan() {
-    if (!wifiScanning) return;
-    if (millis() - lastWifiScan < 500) return;
-    lastWifiScan = millis();
-
-    // Channel hopping
-    if (millis() - lastChannelHop > WIFI_CHANNEL_HOP_MS) {
-        lastChannelHop = millis();
-        scanChannel = (scanChannel % 13) + 1;
-        esp_wifi_set_channel(scanChannel, WIFI_SECOND_CHAN_NONE);
+// Merge one sweep record into the table
+static void mergeNetwork(const hal_ap_record_t* rec) {
+    portal_net_t* net = nullptr;
+    for (uint16_t i = 0; i < portalNetCount; i++) {
+        if (memcmp(portalNets[i].bssid, rec->bssid, 6) == 0) {
+            net = &portalNets[i];
+            break;
+        }
     }
 
-    int n = WiFi.scanComplete();
-    if (n == WIFI_SCAN_FAILED) {
-        WiFi.scanNetworks(true, true);
-    } else if (n >= 0) {
-        networkCount = n;
-        lv_label_set_text_fmt(lblPortalCount, "Networks: %d | Ch: %d", networkCount, scanChannel);
-
-        for (int i = 0; i < 8; i++) {
-            if (i < n) {
-                String ssid = WiFi.SSID(i);
-                if (ssid.length() == 0) ssid = "<hidden>";
-                if (ssid.length() > 18) ssid = ssid.substring(0, 15) + "...";
-                int8_t rssi = WiFi.RSSI(i);
-                const char* auth = WiFi.encryptionType(i) == WIFI_AUTH_OPEN ? "O" : "E";
-                lv_label_set_text_fmt(lblPortalNetworks[i], "%s %ddB [%s]", ssid.c_str(), rssi, auth);
-                lv_obj_set_style_text_color(lblPortalNetworks[i],
-                    rssi > -50 ? colGreen : rssi > -70 ? colYellow : colRed, 0);
-            } else {
-                lv_label_set_text(lblPortalNetworks[i], "");
+    if (!net) {
+        if (portalNetCount < WIFI_MAX_NETWORKS) {
+            net = &portalNets[portalNetCount++];
+        } else {
+            // Full - recycle the network we heard from longest ago
+            net = &portalNets[0];
+            for (uint16_t i = 1; i < portalNetCount; i++) {
+                if (portalNets[i].lastSeen < net->lastSeen) net = &portalNets[i];
             }
         }
-        WiFi.scanDelete();
-        WiFi.scanNetworks(true, true);
-        totalXP += n;
+        memcpy(net->bssid, rec->bssid, 6);
+        net->ssid[0] = '\0';
+        radioXP += XP_NETWORK_FOUND;
+        hop_note_new_bssid(&portalHop, rec->channel);
+    }
+
+    // Hidden beacons must not blank a name the decloaker recovered
+    if (rec->ssid[0] == '\0') {
+        if (net->ssid[0] == '\0') decloak_watch(&portalDecloak, net->bssid);
+    } else {
+        strncpy(net->ssid, rec->ssid, sizeof(net->ssid) - 1);
+        net->ssid[sizeof(net->ssid) - 1] = '\0';
+    }
+    net->rssi = rec->rssi;
+    net->authmode = rec->authmode;
+    net->lastSeen = millis();
+}
+
+// Probe response or (re)association request naming a hidden network
+static void decloakNetwork(const uint8_t* bssid, const char* ssid) {
+    for (uint16_t i = 0; i < portalNetCount; i++) {
+        portal_net_t* net = &portalNets[i];
+        if (memcmp(net->bssid, bssid, 6) != 0) continue;
+        if (net->ssid[0] != '\0') return;
+
+        memcpy(net->ssid, ssid, sizeof(net->ssid));
+        radioXP += XP_HIDDEN_FOUND;
+        return;
+    }
+}
+
+// Publish the strongest networks heard within the timeout, strongest first
+static void publishPortalView() {
+    int16_t rows[WIFI_PORTAL_ROWS];
+    int shown = 0;
+    uint16_t active = 0;
+    for (uint16_t i = 0; i < portalNetCount; i++) {
+        if (millis() - portalNets[i].lastSeen > WIFI_SCAN_TIMEOUT_MS) continue;
+        active++;
+
+        int pos = shown < WIFI_PORTAL_ROWS ? shown++ : WIFI_PORTAL_ROWS;
+        while (pos > 0 && portalNets[rows[pos - 1]].rssi < portalNets[i].rssi) {
+            if (pos < WIFI_PORTAL_ROWS) rows[pos] = rows[pos - 1];
+            pos--;
+        }
+        if (pos < WIFI_PORTAL_ROWS) rows[pos] = i;
+    }
+
+    // Zero-filled so the UI can compare rows bytewise
+    portal_view_t view;
+    memset(&view, 0, sizeof(view));
+    for (int i = 0; i < shown; i++) {
+        const portal_net_t* net = &portalNets[rows[i]];
+        strncpy(view.rows[i].ssid, net->ssid, sizeof(view.rows[i].ssid) - 1);
+        view.rows[i].rssi = net->rssi;
+        view.rows[i].authmode = net->authmode;
+    }
+    view.rowCount = shown;
+    view.active = active;
+    view.channel = portalHop.channel;
+    view.policy = portalHop.policy;
+    service_publish(&svcWifi, &view);
+}
+
+static void wifiTick(uint32_t now) {
+    // Channel hopping - dwell time follows activity unless round-robin/locked
+    if (hop_tick(&portalHop, now)) hal_wifi_set_channel(portalHop.channel);
+
+    // Merge everything sniffed since the last pass
+    const frame_slot_t* slot;
+    while ((slot = frame_ring_peek(&portalRing)) != nullptr) {
+        hal_frame_t frame;
+        hal_ap_record_t rec;
+        frame_ring_view(slot, &frame);
+        hop_note_frame(&portalHop, frame.channel);
+
+        uint8_t bssid[6];
+        char ssid[33];
+        if (decloak_match(&portalDecloak, &frame, bssid, ssid)) decloakNetwork(bssid, ssid);
+        if (sniffer_parse(&frame, &rec)) mergeNetwork(&rec);
+        frame_ring_release(&portalRing);
+    }
+
+    if (now - lastPortalPublish < 500) return;
+    lastPortalPublish = now;
+    publishPortalView();
+}
+
+// Redraw only the Portal labels whose row changed since they were drawn
+static void drawPortal() {
+    static portal_view_t drawn;
+    static uint32_t seen = 0;
+    static int32_t shownCount = -1;
+    static int8_t shownChannel = -1;
+    static int8_t shownPolicy = -1;
+
+    portal_view_t view;
+    if (!service_read(&svcWifi, &view, &seen)) return;
+
+    scanChannel = view.channel;
+    if (shownCount != view.active || shownChannel != view.channel || shownPolicy != view.policy) {
+        shownCount = view.active;
+        shownChannel = view.channel;
+        shownPolicy = view.policy;
+        lv_label_set_text_fmt(lblPortalCount, "Networks: %d | Ch: %d %s",
+                              view.active, view.channel, hop_policy_name(view.policy));
+    }
+
+    for (int i = 0; i < WIFI_PORTAL_ROWS; i++) {
+        bool had = i < drawn.rowCount;
+        if (i >= view.rowCount) {
+            if (had) lv_label_set_text(lblPortalNetworks[i], "");
+            continue;
+        }
+        const portal_row_t* row = &view.rows[i];
+        if (had && memcmp(row, &drawn.rows[i], sizeof(portal_row_t)) == 0) continue;
+
+        const char* auth = row->authmode == WIFI_AUTH_OPEN ? "O" : "E";
+        if (row->ssid[0] == '\0') {
+            lv_label_set_text_fmt(lblPortalNetworks[i], "<hidden> %ddB [%s]", row->rssi, auth);
+        } else if (strlen(row->ssid) > 18) {
+            lv_label_set_text_fmt(lblPortalNetworks[i], "%.15s... %ddB [%s]", row->ssid, row->rssi, auth);
+        } else {
+            lv_label_set_text_fmt(lblPortalNetworks[i], "%s %ddB [%s]", row->ssid, row->rssi, auth);
+        }
+        lv_obj_set_style_text_color(lblPortalNetworks[i],
+            row->rssi > -50 ? colGreen : row->rssi > -70 ? colYellow : colRed, 0);
     }
+
+    drawn = view;
 }
 
 // =============================================================================
@@ -592,22 +887,37 @@ void initBLE() {
 
 void startBleSpam() {
     bleSpamming = true;
-    bleSpamCount = 0;
+    setService(&svcBle, true);
     lv_label_set_text(lblSchwiftyStatus, "ACTIVE");
     lv_obj_set_style_text_color(lblSchwiftyStatus, colGreen, 0);
 }
 
 void stopBleSpam() {
     bleSpamming = false;
-    if (pAdvertising) pAdvertising->stop();
+    setService(&svcBle, false);
     lv_label_set_text(lblSchwiftyStatus, "STOPPED");
     lv_obj_set_style_text_color(lblSchwiftyStatus, colGray, 0);
 }
 
-void updateBleSpam() {
-    if (!bleSpamming || !pAdvertising) return;
-    if (millis() - lastBleSpam < BLE_SPAM_INTERVAL_MS) return;
-    lastBleSpam = millis();
+static void setBleTarget(ble_target_t target) {
+    bleTarget = target;
+    postCommand(radioQueue, RADIO_CMD_BLE_TARGET, target);
+    const char* targets[] = {"Apple", "Android", "Samsung", "Windows", "ALL"};
+    lv_label_set_text_fmt(lblSchwiftyTarget, "Target: %s", targets[bleTarget]);
+}
+
+static void bleStart() {
+    bleNow.sent = 0;
+    service_publish(&svcBle, &bleNow);
+}
+
+static void bleStop() {
+    if (pAdvertising) pAdvertising->stop();
+}
+
+// One advert per BLE_SPAM_INTERVAL_MS
+static void bleTick(uint32_t now) {
+    if (!pAdvertising) return;
 
     uint8_t data[8];
     for (int i = 0; i < 8; i++) data[i] = random(256);
@@ -615,7 +925,7 @@ void updateBleSpam() {
     NimBLEAdvertisementData advData;
     advData.setFlags(0x06);
 
-    if (bleTarget == BLE_TARGET_APPLE || (bleTarget == BLE_TARGET_ALL && random(2))) {
+    if (radioBleTarget == BLE_TARGET_APPLE || (radioBleTarget == BLE_TARGET_ALL && random(2))) {
         data[0] = 0x07; data[1] = 0x19; data[2] = 0x07; data[3] = 0x0e; data[4] = 0x20;
         advData.setManufacturerData(std::string((char*)data, 8));
     } else {
@@ -627,9 +937,16 @@ void updateBleSpam() {
     delay(10);
     pAdvertising->stop();
 
-    bleSpamCount++;
-    lv_label_set_text_fmt(lblSchwiftyCount, "%lu", bleSpamCount);
-    if (bleSpamCount % 100 == 0) totalXP += XP_BLE_SPAM_100;
+    bleNow.sent++;
+    if (bleNow.sent % 100 == 0) radioXP += XP_BLE_SPAM_100;
+    service_publish(&svcBle, &bleNow);
+}
+
+static void drawSchwifty() {
+    static uint32_t seen = 0;
+    ble_view_t view;
+    if (!service_read(&svcBle, &view, &seen)) return;
+    lv_label_set_text_fmt(lblSchwiftyCount, "%lu", view.sent);
 }
 
 // =============================================================================
@@ -637,144 +954,249 @@ void updateBleSpam() {
 // =============================================================================
 void startWardriving() {
     gpsActive = true;
-    startWifiScan();
+    syncWifiService();
+    setService(&svcWardrive, true);
     lv_label_set_text(lblWubbaStatus, "ACTIVE");
     lv_obj_set_style_text_color(lblWubbaStatus, colGreen, 0);
 }
 
 void stopWardriving() {
     gpsActive = false;
-    stopWifiScan();
+    setService(&svcWardrive, false);
+    syncWifiService();
     lv_label_set_text(lblWubbaStatus, "STOPPED");
     lv_obj_set_style_text_color(lblWubbaStatus, colGray, 0);
 }
 
-void updateGPS() {
-    if (millis() - lastGpsUpdate < 1000) return;
-    lastGpsUpdate = millis();
+// UART event task: copy and wake the GPS task
+static void onGpsBytes(const uint8_t* data, size_t len) {
+    nmea_stream_push(&gpsStream, data, len, millis());
+    if (taskGps) xTaskNotifyGive(taskGps);
+}
 
-    // Process GPS data from LilyGoLib
-    while (Serial1.available()) {
-        instance.gps.encode(Serial1.read());
+// Parses whatever has arrived and publishes each new fix, stamped with the
+// arrival of its sentence; also run on the service cadence to age out a fix
+static void gpsTick(uint32_t now) {
+    bool changed = false;
+    char c;
+    while (nmea_stream_getc(&gpsStream, &c)) {
+        uint8_t type = nmea_parse(&gpsParser, c, gpsStream.sentenceMs);
+        if (type == NMEA_RMC) utc_clock_fix(&utcClock, &gpsParser.fix);
+        if (!(type & (NMEA_RMC | NMEA_GGA)) || !gpsParser.fix.valid) continue;
+
+        gpsNow.lat = gpsParser.fix.lat;
+        gpsNow.lon = gpsParser.fix.lon;
+        gpsNow.fixMs = gpsParser.fix.stampMs;
+        changed = true;
     }
 
-    if (instance.gps.location.isValid()) {
-        gpsFix = true;
-        gpsLat = instance.gps.location.lat();
-        gpsLon = instance.gps.location.lng();
-
-        lv_label_set_text(lblWubbaGps, "FIX OK");
-        lv_obj_set_style_text_color(lblWubbaGps, colGreen, 0);
-        lv_label_set_text_fmt(lblWubbaCoords, "%.5f %c\n%.5f %c",
-            fabs(gpsLat), gpsLat >= 0 ? 'N' : 'S',
-            fabs(gpsLon), gpsLon >= 0 ? 'E' : 'W');
-
-        if (gpsActive && networkCount > 0) {
-            gpsNetworksLogged += networkCount;
-            lv_label_set_text_fmt(lblWubbaLogged, "%lu", gpsNetworksLogged);
-            totalXP += XP_GPS_WARDRIVING;
+    bool fix = gpsNow.fixMs && now - gpsNow.fixMs < GPS_FIX_TIMEOUT_MS;
+    if (changed || fix != gpsNow.fix) {
+        gpsNow.fix = fix;
+        service_publish(&svcGps, &gpsNow);
+    }
+}
+
+// Logs the networks in range on every fix - reads the wifi snapshot
+static void wardriveStart() {
+    wardriveNow.logged = 0;
+    service_publish(&svcWardrive, &wardriveNow);
+}
+
+static void wardriveTick(uint32_t now) {
+    static portal_view_t wifi;
+    static uint32_t wifiSeen = 0;
+    if (!service_read(&svcWifi, &wifi, &wifiSeen)) return;  // No fresh scan results
+    if (!gpsNow.fix || wifi.active == 0) return;
+
+    wardriveNow.logged += wifi.active;
+    service_publish(&svcWardrive, &wardriveNow);
+    earnXP(XP_GPS_WARDRIVING);
+}
+
+static void drawWubba() {
+    static uint32_t gpsSeen = 0;
+    static uint32_t wardriveSeen = 0;
+
+    gps_view_t gps;
+    if (service_read(&svcGps, &gps, &gpsSeen)) {
+        if (gps.fix) {
+            lv_label_set_text(lblWubbaGps, "FIX OK");
+            lv_obj_set_style_text_color(lblWubbaGps, colGreen, 0);
+            lv_label_set_text_fmt(lblWubbaCoords, "%.5f %c\n%.5f %c",
+                fabs(gps.lat * 1e-7), gps.lat >= 0 ? 'N' : 'S',
+                fabs(gps.lon * 1e-7), gps.lon >= 0 ? 'E' : 'W');
+        } else {
+            lv_label_set_text(lblWubbaGps, "NO FIX");
+            lv_obj_set_style_text_color(lblWubbaGps, colRed, 0);
         }
-    } else {
-        gpsFix = false;
-        lv_label_set_text(lblWubbaGps, "NO FIX");
-        lv_obj_set_style_text_color(lblWubbaGps, colRed, 0);
+    }
+
+    wardrive_view_t wardrive;
+    if (service_read(&svcWardrive, &wardrive, &wardriveSeen)) {
+        lv_label_set_text_fmt(lblWubbaLogged, "%lu", wardrive.logged);
     }
 }
 
 // =============================================================================
 // LORA MESH
 // =============================================================================
+// Mesh task - transmit blocks for the whole time on air, so it lives here
+
+static void publishMesh() {
+    mesh_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.ready = loraInitialized;
+    view.sent = loraMsgSent;
+    view.recv = loraMsgRecv;
+    view.rssi = loraLastRssi;
+    strncpy(view.msg, loraLastMsg, sizeof(view.msg) - 1);
+    service_publish(&svcMesh, &view);
+}
+
 void initLoRa() {
     if (loraInitialized) return;
-    // Use instance.initLoRa() which initializes the global 'radio' object
-    if (instance.initLoRa()) {
-        int state = radio.begin(LORA_FREQ, LORA_BW, LORA_SF, 7, LORA_SYNC, LORA_TX_POWER, 8, 0, false);
-        if (state == RADIOLIB_ERR_NONE) {
-            loraInitialized = true;
-            radio.startReceive();
-        }
+    if (hal_lora_begin(LORA_FREQ, LORA_BW, LORA_SF, 7, LORA_SYNC, LORA_TX_POWER, 8)) {
+        loraInitialized = true;
+        hal_lora_start_receive();
     }
+    publishMesh();
+}
+
+static void stopLoRa() {
+    if (loraInitialized) hal_lora_standby();
+    loraInitialized = false;
+    publishMesh();
 }
 
 void sendLoRaBeacon() {
     if (!loraInitialized) return;
     char beacon[32];
     snprintf(beacon, 32, "RICK-%04X BEACON", (uint16_t)random(0xFFFF));
-    int state = radio.transmit((uint8_t*)beacon, strlen(beacon));
-    if (state == RADIOLIB_ERR_NONE) {
+    int state = hal_lora_transmit((uint8_t*)beacon, strlen(beacon));
+    if (state == 0) {
         loraMsgSent++;
-        lv_label_set_text_fmt(lblCouncilStats, "TX: %lu | RX: %lu", loraMsgSent, loraMsgRecv);
-        lv_label_set_text(lblCouncilStatus, "TX OK");
-        lv_obj_set_style_text_color(lblCouncilStatus, colGreen, 0);
-        totalXP += XP_LORA_MESSAGE;
+        publishMesh();
+        earnXP(XP_LORA_MESSAGE);
     }
-    radio.startReceive();
+    hal_lora_start_receive();
 }
 
-void updateLoRa() {
+void updateLoRa(uint32_t now) {
     if (!loraInitialized) return;
 
-    // Check for received packet using IRQ flags
-    uint16_t irq = radio.getIrqFlags();
-    if (irq & RADIOLIB_SX126X_IRQ_RX_DONE) {
-        uint8_t buf[64];
-        size_t len = 0;
-        int state = radio.readData(buf, 64);
-        if (state == RADIOLIB_ERR_NONE) {
-            len = radio.getPacketLength();
-            if (len > 0 && len < 64) {
-                buf[len] = 0;
-                loraMsgRecv++;
-                loraLastRssi = radio.getRSSI();
-                strncpy(loraLastMsg, (char*)buf, 63);
-                lv_label_set_text_fmt(lblCouncilStats, "TX: %lu | RX: %lu", loraMsgSent, loraMsgRecv);
-                lv_label_set_text_fmt(lblCouncilRssi, "Last RSSI: %d dBm", loraLastRssi);
-                lv_label_set_text(lblCouncilMsg, loraLastMsg);
-                lv_label_set_text(lblCouncilStatus, "RX");
-                lv_obj_set_style_text_color(lblCouncilStatus, colCyan, 0);
-            }
-        }
-        radio.clearIrqFlags(RADIOLIB_SX126X_IRQ_RX_DONE);
-        radio.startReceive();
+    // Check for received packet
+    uint8_t buf[64];
+    int len = hal_lora_receive(buf, sizeof(buf) - 1, &loraLastRssi, nullptr);
+    if (len > 0) {
+        buf[len] = 0;
+        loraMsgRecv++;
+        strncpy(loraLastMsg, (char*)buf, 63);
+        publishMesh();
     }
 }
 
+static void drawCouncil() {
+    static uint32_t seen = 0;
+    static mesh_view_t drawn;
+
+    mesh_view_t view;
+    if (!service_read(&svcMesh, &view, &seen)) return;
+
+    lv_label_set_text_fmt(lblCouncilStats, "TX: %lu | RX: %lu", view.sent, view.recv);
+    if (view.recv != drawn.recv) {
+        lv_label_set_text_fmt(lblCouncilRssi, "Last RSSI: %d dBm", view.rssi);
+        lv_label_set_text(lblCouncilMsg, view.msg);
+        lv_label_set_text(lblCouncilStatus, "RX");
+        lv_obj_set_style_text_color(lblCouncilStatus, colCyan, 0);
+    } else if (view.sent != drawn.sent) {
+        lv_label_set_text(lblCouncilStatus, "TX OK");
+        lv_obj_set_style_text_color(lblCouncilStatus, colGreen, 0);
+    } else if (!view.ready) {
+        lv_label_set_text(lblCouncilStatus, "OFFLINE");
+        lv_obj_set_style_text_color(lblCouncilStatus, colGray, 0);
+    }
+    drawn = view;
+}
+
+// Council screen action: bring the mesh up if needed, then beacon
+static void requestLoRaBeacon() {
+    setService(&svcMesh, true);
+    postCommand(meshQueue, MESH_CMD_BEACON, 0);
+}
+
 // =============================================================================
 // FILE MANAGER
 // =============================================================================
+// Storage task - the card can stall for hundreds of ms, nothing else waits
+
 void initSD() {
-    sdCardReady = instance.installSD();
+    sdCardReady = hal_sd_begin();
     if (sdCardReady) {
-        sdTotalMB = SD.totalBytes() / (1024 * 1024);
-        sdUsedMB = SD.usedBytes() / (1024 * 1024);
-        lv_label_set_text_fmt(lblPlumbusSD, "SD: %luMB / %luMB", sdUsedMB, sdTotalMB);
-        lv_label_set_text(lblPlumbusStatus, "READY");
-        lv_obj_set_style_text_color(lblPlumbusStatus, colGreen, 0);
-    } else {
-        lv_label_set_text(lblPlumbusSD, "SD Card: Not found");
-        lv_label_set_text(lblPlumbusStatus, "NO SD");
-        lv_obj_set_style_text_color(lblPlumbusStatus, colRed, 0);
+        sdTotalMB = hal_sd_total_bytes() / (1024 * 1024);
+        sdUsedMB = hal_sd_used_bytes() / (1024 * 1024);
     }
+
+    ui_event_t ev = {};
+    ev.type = UI_EV_SD_STATUS;
+    ev.sd.ready = sdCardReady;
+    ev.sd.usedMB = sdUsedMB;
+    ev.sd.totalMB = sdTotalMB;
+    uiPost(&ev);
 }
 
 void refreshFiles() {
     if (!sdCardReady) { initSD(); return; }
 
+    ui_event_t ev = {};
+    ev.type = UI_EV_SD_FILE;
     File root = SD.open("/");
     int idx = 0;
     while (idx < 6) {
         File entry = root.openNextFile();
         if (!entry) break;
-        lv_label_set_text_fmt(lblPlumbusFiles[idx], "%s %s (%luB)",
+        snprintf(ev.file.line, sizeof(ev.file.line), "%s %s (%luB)",
             entry.isDirectory() ? "[D]" : "[F]",
             entry.name(),
-            entry.size());
+            (unsigned long)entry.size());
+        ev.file.index = idx;
+        uiPost(&ev);
         entry.close();
         idx++;
     }
-    for (; idx < 6; idx++) lv_label_set_text(lblPlumbusFiles[idx], "");
     root.close();
     fileCount = idx;
+
+    ev.type = UI_EV_SD_FILES_DONE;
+    ev.file.index = idx;
+    uiPost(&ev);
+}
+
+// UI task
+static void showSD(const ui_event_t* ev) {
+    switch (ev->type) {
+        case UI_EV_SD_STATUS:
+            if (ev->sd.ready) {
+                lv_label_set_text_fmt(lblPlumbusSD, "SD: %luMB / %luMB", ev->sd.usedMB, ev->sd.totalMB);
+                lv_label_set_text(lblPlumbusStatus, "READY");
+                lv_obj_set_style_text_color(lblPlumbusStatus, colGreen, 0);
+            } else {
+                lv_label_set_text(lblPlumbusSD, "SD Card: Not found");
+                lv_label_set_text(lblPlumbusStatus, "NO SD");
+                lv_obj_set_style_text_color(lblPlumbusStatus, colRed, 0);
+            }
+            break;
+        case UI_EV_SD_FILE:
+            if (ev->file.index >= 0 && ev->file.index < 6) {
+                lv_label_set_text(lblPlumbusFiles[ev->file.index], ev->file.line);
+            }
+            break;
+        case UI_EV_SD_FILES_DONE:
+            for (int idx = ev->file.index; idx < 6; idx++) lv_label_set_text(lblPlumbusFiles[idx], "");
+            break;
+        default:
+            break;
+    }
 }
 
 // =============================================================================
@@ -853,40 +1275,33 @@ void handleKeyboard() {
     // Convert to uppercase for easier matching
     char key = (c >= 'a' && c <= 'z') ? c - 32 : c;
 
-    // Global navigation shortcuts (work from any screen)
+    // Global navigation shortcuts (work from any screen) - services keep
+    // running in the background until stopped from their own screen
     switch (key) {
         case 'P':  // Portal Gun - WiFi Scanner
-            stopBleSpam(); stopWardriving();
             gotoScreen(SCREEN_PORTAL);
             return;
         case 'S':  // Get Schwifty - BLE Spam
-            stopWifiScan(); stopWardriving();
             gotoScreen(SCREEN_SCHWIFTY);
             return;
         case 'W':  // Wubba Lubba - GPS Wardriving
-            stopBleSpam();
             gotoScreen(SCREEN_WUBBA_LUBBA);
             return;
         case 'C':  // Council - LoRa Mesh
-            stopWifiScan(); stopBleSpam(); stopWardriving();
             gotoScreen(SCREEN_COUNCIL);
             return;
         case 'F':  // Plumbus - File Manager
-            stopWifiScan(); stopBleSpam(); stopWardriving();
             gotoScreen(SCREEN_PLUMBUS);
             return;
         case 'M':  // Menu
-            stopWifiScan(); stopBleSpam(); stopWardriving();
             gotoScreen(SCREEN_MENU);
             return;
         case 'X':  // Settings
-            stopWifiScan(); stopBleSpam(); stopWardriving();
             gotoScreen(SCREEN_SETTINGS);
             return;
         case 'B':  // Back to menu
         case 27:   // ESC
         case '$':  // Alt+4 on some keyboards
-            stopWifiScan(); stopBleSpam(); stopWardriving();
             gotoScreen(SCREEN_MENU);
             return;
         case 'L':  // Toggle keyboard backlight
@@ -914,6 +1329,9 @@ void handleKeyboard() {
         case SCREEN_PORTAL:
             if (key == ' ' || key == '\n' || key == '\r') {
                 if (wifiScanning) stopWifiScan(); else startWifiScan();
+            } else if (key == 'H' || c == 'h') {  // H = cycle hop mode, LOCK holds the current channel
+                portalHopPolicy = (hop_policy_t)((portalHopPolicy + 1) % HOP_POLICY_COUNT);
+                postCommand(radioQueue, RADIO_CMD_HOP_POLICY, portalHopPolicy | (scanChannel << 8));
             }
             break;
 
@@ -921,9 +1339,7 @@ void handleKeyboard() {
             if (key == ' ' || key == '\n' || key == '\r') {
                 if (bleSpamming) stopBleSpam(); else startBleSpam();
             } else if (c >= '1' && c <= '5') {
-                bleTarget = (ble_target_t)(c - '1');
-                const char* targets[] = {"Apple", "Android", "Samsung", "Windows", "ALL"};
-                lv_label_set_text_fmt(lblSchwiftyTarget, "Target: %s", targets[bleTarget]);
+                setBleTarget((ble_target_t)(c - '1'));
             }
             break;
 
@@ -935,14 +1351,13 @@ void handleKeyboard() {
 
         case SCREEN_COUNCIL:
             if (key == ' ' || key == '\n' || key == '\r') {
-                if (!loraInitialized) initLoRa();
-                sendLoRaBeacon();
+                requestLoRaBeacon();
             }
             break;
 
         case SCREEN_PLUMBUS:
             if (key == ' ' || key == '\n' || key == '\r' || key == 'R') {
-                refreshFiles();
+                postCommand(storageQueue, STORAGE_CMD_LIST, 0);
             }
             break;
 
@@ -950,7 +1365,7 @@ void handleKeyboard() {
             if (key == ' ' || key == '\n' || key == '\r') {
                 if (settingsIndex == 0) {
                     settingsBrightness = (settingsBrightness % 16) + 1;
-                    instance.setBrightness(settingsBrightness);
+                    hal_display_set_brightness(settingsBrightness);
                 } else if (settingsIndex == 1) {
                     settingsLoraFreq = !settingsLoraFreq;
                 } else if (settingsIndex == 4) {
@@ -986,12 +1401,9 @@ void handleRotary() {
             case SCREEN_MENU:
                 if (dir > 0) menuNext(); else menuPrev();
                 break;
-            case SCREEN_SCHWIFTY: {
-                bleTarget = (ble_target_t)((bleTarget + dir + BLE_TARGET_COUNT) % BLE_TARGET_COUNT);
-                const char* targets[] = {"Apple", "Android", "Samsung", "Windows", "ALL"};
-                lv_label_set_text_fmt(lblSchwiftyTarget, "Target: %s", targets[bleTarget]);
+            case SCREEN_SCHWIFTY:
+                setBleTarget((ble_target_t)((bleTarget + dir + BLE_TARGET_COUNT) % BLE_TARGET_COUNT));
                 break;
-            }
             case SCREEN_SETTINGS:
                 settingsIndex = (settingsIndex + dir + 5) % 5;
                 updateSettingsDisplay();
@@ -1014,8 +1426,6 @@ void handleRotary() {
 
         if (dur > 800) {
             // Long press - back to menu
-            stopWifiScan(); stopBleSpam(); stopWardriving();
-            loraActive = false;
             gotoScreen(SCREEN_MENU);
         } else {
             // Short press - action
@@ -1031,16 +1441,15 @@ void handleRotary() {
                     if (gpsActive) stopWardriving(); else startWardriving();
                     break;
                 case SCREEN_COUNCIL:
-                    if (!loraInitialized) initLoRa();
-                    sendLoRaBeacon();
+                    requestLoRaBeacon();
                     break;
                 case SCREEN_PLUMBUS:
-                    refreshFiles();
+                    postCommand(storageQueue, STORAGE_CMD_LIST, 0);
                     break;
                 case SCREEN_SETTINGS:
                     if (settingsIndex == 0) {
                         settingsBrightness = (settingsBrightness % 16) + 1;
-                        instance.setBrightness(settingsBrightness);
+                        hal_display_set_brightness(settingsBrightness);
                     } else if (settingsIndex == 1) {
                         settingsLoraFreq = !settingsLoraFreq;
                     } else if (settingsIndex == 4) {
@@ -1085,6 +1494,180 @@ void updateStatus() {
     updateXPDisplay();
 }
 
+// =============================================================================
+// TASKS
+// =============================================================================
+// UI on core 1 owns LVGL and input. Radio (WiFi sniffing, BLE) sits on core 0
+// with the WiFi/BT stacks at the highest priority so the frame ring never
+// backs up. Mesh shares core 0, GPS and storage share core 1; storage runs at
+// the lowest priority so a slow card only delays itself. Radio, GPS and mesh
+// run whatever services they own; see SERVICES.
+
+static void registerServices() {
+    service_init(&svcWifi, "wifi", RUNNER_RADIO, TASK_RADIO_PERIOD_MS,
+                 wifiStart, wifiStop, wifiTick, &wifiState, sizeof(wifiState));
+    service_init(&svcBle, "ble", RUNNER_RADIO, BLE_SPAM_INTERVAL_MS,
+                 bleStart, bleStop, bleTick, &bleState, sizeof(bleState));
+    service_init(&svcGps, "gps", RUNNER_GPS, TASK_GPS_PERIOD_MS,
+                 nullptr, nullptr, gpsTick, &gpsState, sizeof(gpsState));
+    service_init(&svcWardrive, "wardrive", RUNNER_GPS, GPS_UPDATE_INTERVAL_MS,
+                 wardriveStart, nullptr, wardriveTick, &wardriveState, sizeof(wardriveState));
+    service_init(&svcMesh, "mesh", RUNNER_MESH, TASK_MESH_PERIOD_MS,
+                 initLoRa, stopLoRa, updateLoRa, &meshState, sizeof(meshState));
+
+    service_register(&services, &svcWifi);
+    service_register(&services, &svcBle);
+    service_register(&services, &svcGps);
+    service_register(&services, &svcWardrive);
+    service_register(&services, &svcMesh);
+
+    // The receiver is always worth listening to
+    service_request(&svcGps, true);
+}
+
+static TickType_t serviceWait(uint32_t wait) {
+    return wait == SERVICE_IDLE ? portMAX_DELAY : pdMS_TO_TICKS(wait);
+}
+
+// Screens subscribe to the snapshots they show; the rest catch up when shown
+static void drawScreen() {
+    switch (currentScreen) {
+        case SCREEN_PORTAL: drawPortal(); break;
+        case SCREEN_SCHWIFTY: drawSchwifty(); break;
+        case SCREEN_WUBBA_LUBBA: drawWubba(); break;
+        case SCREEN_COUNCIL: drawCouncil(); break;
+        default: break;
+    }
+}
+
+static void handleUiEvent(const ui_event_t* ev) {
+    if (ev->type == UI_EV_XP) totalXP += ev->value;
+    else showSD(ev);
+}
+
+static void reportTasks() {
+    static uint32_t lastReport = 0;
+    if (millis() - lastReport < TASK_STACK_REPORT_MS) return;
+    lastReport = millis();
+
+    // High-water marks: bytes of stack never touched
+    Serial.printf("[TASKS] Stack free: ui %u radio %u storage %u gps %u mesh %u | "
+                  "UI events dropped %lu | frames dropped %lu | NMEA bytes dropped %lu\n",
+                  uxTaskGetStackHighWaterMark(taskUi), uxTaskGetStackHighWaterMark(taskRadio),
+                  uxTaskGetStackHighWaterMark(taskStorage), uxTaskGetStackHighWaterMark(taskGps),
+                  uxTaskGetStackHighWaterMark(taskMesh), uiEventsDropped, portalRing.dropped,
+                  gpsStream.dropped);
+
+    Serial.printf("[CLOCK] %s | error %lu us | drift %ld ppb | PPS locks %lu | steps %lu\n",
+                  utc_source_name(utcClock.source), utc_clock_error_us(&utcClock, hal_clock_us()),
+                  utcClock.driftPpb, utcClock.ppsLocks, utcClock.steps);
+
+    for (uint8_t i = 0; i < services.count; i++) {
+        const service_t* svc = services.services[i];
+        if (!svc->runs) continue;
+        Serial.printf("[SERVICE] %-8s %s runs %lu | max %lu us | overruns %lu\n", svc->name,
+                      svc->active ? "on " : "off", svc->runs, svc->maxUs, svc->overruns);
+    }
+}
+
+static void uiTask(void* arg) {
+    for (;;) {
+        lv_timer_handler();
+        handleInput();
+
+        ui_event_t ev;
+        while (xQueueReceive(uiQueue, &ev, 0) == pdTRUE) handleUiEvent(&ev);
+        drawScreen();
+
+        updateStatus();
+        reportTasks();
+        vTaskDelay(pdMS_TO_TICKS(TASK_UI_PERIOD_MS));
+    }
+}
+
+static void radioCommand(const task_cmd_t* cmd) {
+    switch (cmd->type) {
+        case RADIO_CMD_HOP_POLICY:
+            radioHopPolicy = (hop_policy_t)(cmd->value & 0xFF);
+            if (svcWifi.active) hop_set_policy(&portalHop, radioHopPolicy, cmd->value >> 8);
+            break;
+        case RADIO_CMD_BLE_TARGET:
+            radioBleTarget = (ble_target_t)cmd->value;
+            break;
+        default:
+            break;     // TASK_CMD_WAKE: the next service_run() picks it up
+    }
+}
+
+static void radioTask(void* arg) {
+    for (;;) {
+        // Sleep until the next service is due or a command arrives
+        uint32_t wait = service_run(&services, RUNNER_RADIO, millis());
+        task_cmd_t cmd;
+        if (xQueueReceive(radioQueue, &cmd, serviceWait(wait)) == pdTRUE) {
+            do radioCommand(&cmd); while (xQueueReceive(radioQueue, &cmd, 0) == pdTRUE);
+        }
+
+        if (radioXP) {
+            ui_event_t ev = {};
+            ev.type = UI_EV_XP;
+            ev.value = radioXP;
+            if (uiPost(&ev)) radioXP = 0;
+        }
+    }
+}
+
+static void storageTask(void* arg) {
+    for (;;) {
+        task_cmd_t cmd;
+        if (xQueueReceive(storageQueue, &cmd, portMAX_DELAY) != pdTRUE) continue;
+        if (cmd.type == STORAGE_CMD_MOUNT) initSD();
+        else if (cmd.type == STORAGE_CMD_LIST) refreshFiles();
+    }
+}
+
+static void gpsTask(void* arg) {
+    for (;;) {
+        // No command queue - never sleep past one period so requests are seen.
+        // NMEA bytes wake the task early and are parsed straight away
+        uint32_t wait = service_run(&services, RUNNER_GPS, millis());
+        if (wait > TASK_GPS_PERIOD_MS) wait = TASK_GPS_PERIOD_MS;
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait ? wait : 1)) && svcGps.active) gpsTick(millis());
+    }
+}
+
+static void meshTask(void* arg) {
+    for (;;) {
+        uint32_t wait = service_run(&services, RUNNER_MESH, millis());
+        task_cmd_t cmd;
+        if (xQueueReceive(meshQueue, &cmd, serviceWait(wait)) == pdTRUE && cmd.type == MESH_CMD_BEACON) {
+            service_run(&services, RUNNER_MESH, millis());     // Bring the radio up first
+            sendLoRaBeacon();
+        }
+    }
+}
+
+static bool startTasks() {
+    uiQueue = xQueueCreate(QUEUE_UI_DEPTH, sizeof(ui_event_t));
+    radioQueue = xQueueCreate(QUEUE_CMD_DEPTH, sizeof(task_cmd_t));
+    meshQueue = xQueueCreate(QUEUE_CMD_DEPTH, sizeof(task_cmd_t));
+    storageQueue = xQueueCreate(QUEUE_CMD_DEPTH, sizeof(task_cmd_t));
+    if (!uiQueue || !radioQueue || !meshQueue || !storageQueue) return false;
+
+    registerServices();
+
+    return xTaskCreatePinnedToCore(radioTask, "radio", TASK_RADIO_STACK, nullptr,
+                                   TASK_RADIO_PRIO, &taskRadio, TASK_RADIO_CORE) == pdPASS &&
+           xTaskCreatePinnedToCore(meshTask, "mesh", TASK_MESH_STACK, nullptr,
+                                   TASK_MESH_PRIO, &taskMesh, TASK_MESH_CORE) == pdPASS &&
+           xTaskCreatePinnedToCore(gpsTask, "gps", TASK_GPS_STACK, nullptr,
+                                   TASK_GPS_PRIO, &taskGps, TASK_GPS_CORE) == pdPASS &&
+           xTaskCreatePinnedToCore(storageTask, "storage", TASK_STORAGE_STACK, nullptr,
+                                   TASK_STORAGE_PRIO, &taskStorage, TASK_STORAGE_CORE) == pdPASS &&
+           xTaskCreatePinnedToCore(uiTask, "ui", TASK_UI_STACK, nullptr,
+                                   TASK_UI_PRIO, &taskUi, TASK_UI_CORE) == pdPASS;
+}
+
 // =============================================================================
 // SETUP
 // =============================================================================
@@ -1102,7 +1685,7 @@ void setup() {
 
     // LVGL
     Serial.println("[2] LVGL...");
-    beginLvglHelper(instance);
+    hal_display_begin();
     initColors();
     Serial.println("OK");
 
@@ -1113,11 +1696,15 @@ void setup() {
 
     // GPS Serial
     Serial.println("[4] GPS...");
-    Serial1.begin(9600, SERIAL_8N1, GPS_RX, GPS_TX);
+    utc_clock_init(&utcClock);
+    nmea_stream_init(&gpsStream, GPS_RING_SIZE, GPS_BAUD_RATE);
+    nmea_parser_init(&gpsParser);
+    hal_gps_begin(GPS_BAUD_RATE, GPS_RATE_MS, GPS_RX_BUFFER, onGpsBytes);
+    hal_gps_pps_begin(GPS_PPS_PIN);
     Serial.println("OK");
 
     // Brightness
-    instance.setBrightness(settingsBrightness);
+    hal_display_set_brightness(settingsBrightness);
 
     // Create screens
     Serial.println("[5] UI...");
@@ -1140,6 +1727,11 @@ void setup() {
     gotoScreen(SCREEN_MENU);
     updateMenuHighlight();
 
+    // Tasks - LVGL belongs to the UI task from here on
+    Serial.println("[6] Tasks...");
+    if (!startTasks()) { Serial.println("FAILED!"); while(1); }
+    Serial.println("OK");
+
     Serial.println("\n=== READY ===\n");
 }
 
@@ -1147,17 +1739,6 @@ void setup() {
 // LOOP
 // =============================================================================
 void loop() {
-    lv_timer_handler();
-    handleInput();
-    updateStatus();
-
-    switch (currentScreen) {
-        case SCREEN_PORTAL: updateWifiScan(); break;
-        case SCREEN_SCHWIFTY: updateBleSpam(); break;
-        case SCREEN_WUBBA_LUBBA: updateGPS(); if (gpsActive) updateWifiScan(); break;
-        case SCREEN_COUNCIL: updateLoRa(); break;
-        default: break;
-    }
-
-    delay(5);
+    // Everything runs in the tasks started by setup()
+    vTaskDelete(NULL);
 }
@@ -0,0 +1,1292 @@
+/**
+ * @file native_main.cpp
+ * @brief RICK host runner - drives the modules through the HAL stand-ins
+ *
+ * Replays recorded scans, frames, NMEA and LoRa traffic (or synthetic load)
+ * through the scanner, capture, wardrive and mesh logic and reports the time
+ * each subsystem spends per tick.
+ *
+ *   rick_native [--scan FILE | --synth N] [--pcap FILE] [--nmea FILE]
+ *               [--sd DIR] [--ticks N] [--loopback] [--sniff] [--pcapng FILE_KB]
+ *               [--filter EXPR]
+ *   rick_native --hop-bench MINUTES
+ *   rick_native --fuzz ITERATIONS
+ *   rick_native --hc-bench RECORDS
+ *   rick_native --filter-bench FRAMES
+ *   rick_native --nmea-bench FILE
+ *   rick_native --journal-bench APS
+ *   rick_native --locate-bench APS
+ *   rick_native --wlog-bench POINTS
+ *   rick_native --export-bench POINTS
+ *   rick_native [--sd DIR] --wlog-export LOG.rwl OUT.csv|OUT.kml|OUT.geojson
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <TinyGPSPlus.h>
+#include "hal/hal.h"
+#include "hal/native/hal_native.h"
+#include "../src_backup/wifi/wifi_scanner.h"
+#include "../src_backup/wifi/handshake_capture.h"
+#include "../src_backup/gps/wardriving.h"
+#include "../src_backup/lora/lora_mesh.h"
+#include "wifi/hop_scheduler.h"
+#include "wifi/dot11.h"
+#include "wifi/hc22000.h"
+#include "wifi/pcapng.h"
+#include "wifi/capture_filter.h"
+#include "gps/nmea_stream.h"
+#include "gps/nmea_parser.h"
+#include "gps/utc_clock.h"
+#include "gps/ap_locator.h"
+#include "gps/wardrive_log.h"
+
+// =============================================================================
+// STATE
+// =============================================================================
+static scanner_state_t scanner;
+static capture_state_t capture;
+static wardrive_state_t wardrive;
+static lora_mesh_state_t mesh;
+static nmea_parser_t gps;
+static nmea_stream_t gpsStream;
+static pcapng_sink_t pcap;
+static capfilter_t filter;
+
+typedef struct {
+    const char* name;
+    uint64_t totalUs;
+    uint32_t maxUs;
+    uint32_t calls;
+} tick_stats_t;
+
+enum { STAT_SCAN = 0, STAT_CAPTURE, STAT_WARDRIVE, STAT_MESH, STAT_COUNT };
+
+static tick_stats_t stats[STAT_COUNT] = {
+    {"scanner", 0, 0, 0},
+    {"capture", 0, 0, 0},
+    {"wardrive", 0, 0, 0},
+    {"mesh", 0, 0, 0},
+};
+
+static void record(int idx, uint32_t start) {
+    uint32_t us = micros() - start;
+    stats[idx].totalUs += us;
+    if (us > stats[idx].maxUs) stats[idx].maxUs = us;
+    stats[idx].calls++;
+}
+
+// =============================================================================
+// FRAME DISPATCH
+// =============================================================================
+static void onFrame(const hal_frame_t* frame) {
+    if (frame->type == WIFI_PKT_DATA) {
+        capture_process_eapol(&capture, frame->payload, frame->len);
+    } else if (frame->type == WIFI_PKT_MGMT) {
+        capture_process_beacon(&capture, frame->payload, frame->len);
+    }
+}
+
+static bool lookupEssid(const uint8_t* bssid, char* essid) {
+    network_info_t* net = scanner_find_bssid(&scanner, bssid);
+    if (!net || !net->ssid[0]) return false;
+    strcpy(essid, net->ssid);
+    return true;
+}
+
+static void onEssid(const uint8_t* bssid, const char* ssid) {
+    capture_essid_learned(&capture, bssid, ssid);
+}
+
+// =============================================================================
+// GPS INGEST
+// =============================================================================
+static void onGpsBytes(const uint8_t* data, size_t len) {
+    nmea_stream_push(&gpsStream, data, len, millis());
+}
+
+// Parse whatever has arrived
+static void readGps() {
+    char c;
+    while (nmea_stream_getc(&gpsStream, &c)) {
+        if (nmea_parse(&gps, c, gpsStream.sentenceMs) == NMEA_RMC) utc_clock_fix(&utcClock, &gps.fix);
+    }
+}
+
+// =============================================================================
+// HOP SCHEDULER BENCHMARK
+// =============================================================================
+// Simulated drive: APs come into range at a steady rate and stay for 1-5 s,
+// crowded onto 1/6/11, a third of them carrying data traffic. Time is virtual
+// (10 ms steps) so every policy sees the identical air.
+
+#define SIM_STEP_MS         10
+#define SIM_ARRIVALS_PER_S  5
+#define SIM_BEACON_MS       102.4f
+#define SIM_BEACON_RX       0.6f    // Chance a beacon on our channel is heard
+#define SIM_DATA_FPS        50.0f   // Frames/s from a busy AP
+
+typedef struct {
+    uint32_t arrive;
+    uint32_t leave;
+    float phase;
+    uint8_t channel;
+    bool busy;
+    bool found;
+} sim_ap_t;
+
+static uint32_t simRng;
+
+static uint32_t sim_rand() {
+    simRng ^= simRng << 13;
+    simRng ^= simRng >> 17;
+    simRng ^= simRng << 5;
+    return simRng;
+}
+
+static float sim_unit() {
+    return (sim_rand() & 0xFFFFFF) / 16777216.0f;
+}
+
+static uint8_t sim_channel() {
+    float r = sim_unit();
+    if (r < 0.25f) return 1;
+    if (r < 0.55f) return 6;
+    if (r < 0.80f) return 11;
+    static const uint8_t others[] = {2, 3, 4, 5, 7, 8, 9, 10, 12, 13};
+    return others[sim_rand() % sizeof(others)];
+}
+
+static void run_hop_bench(uint32_t minutes) {
+    uint32_t duration = minutes * 60000;
+    uint32_t total = duration / 1000 * SIM_ARRIVALS_PER_S;
+    sim_ap_t* aps = (sim_ap_t*)malloc(sizeof(sim_ap_t) * total);
+
+    const hop_policy_t policies[] = {HOP_ROUND_ROBIN, HOP_WEIGHTED, HOP_LOCKED};
+    Serial.printf("%-8s %10s %10s %12s %12s\n", "policy", "APs", "found", "found/min", "latency ms");
+
+    for (int p = 0; p < 3; p++) {
+        simRng = 0x5EED1234;
+        for (uint32_t i = 0; i < total; i++) {
+            aps[i].arrive = i * 1000 / SIM_ARRIVALS_PER_S;
+            aps[i].leave = aps[i].arrive + 1000 + sim_rand() % 4000;
+            aps[i].phase = sim_unit() * SIM_BEACON_MS;
+            aps[i].channel = sim_channel();
+            aps[i].busy = sim_unit() < 0.33f;
+            aps[i].found = false;
+        }
+
+        hop_scheduler_t hop;
+        hop_init(&hop, policies[p], WIFI_CHANNEL_MIN, WIFI_CHANNEL_MAX, CHANNEL_HOP_INTERVAL_MS, CHANNEL_HOP_FLOOR_MS);
+        hop_set_policy(&hop, policies[p], 6);
+        hop.dwellStart = 0;
+
+        uint32_t found = 0;
+        uint64_t latency = 0;
+        uint32_t first = 0;
+
+        for (uint32_t t = 0; t < duration; t += SIM_STEP_MS) {
+            hop_tick(&hop, t);
+
+            // Skip APs that have already left
+            while (first < total && aps[first].leave < t) first++;
+
+            for (uint32_t i = first; i < total && aps[i].arrive <= t; i++) {
+                sim_ap_t* ap = &aps[i];
+                if (ap->leave < t || ap->channel != hop.channel) continue;
+
+                // Beacon boundaries crossed in this step
+                int beacons = (int)((t + SIM_STEP_MS - ap->phase) / SIM_BEACON_MS) -
+                              (int)((t - ap->phase) / SIM_BEACON_MS);
+                for (int b = 0; b < beacons; b++) {
+                    if (sim_unit() >= SIM_BEACON_RX) continue;
+                    hop_note_frame(&hop, hop.channel);
+                    if (!ap->found) {
+                        ap->found = true;
+                        found++;
+                        latency += t - ap->arrive;
+                        hop_note_new_bssid(&hop, hop.channel);
+                    }
+                }
+                if (ap->busy && sim_unit() < SIM_DATA_FPS * SIM_STEP_MS / 1000.0f) {
+                    hop_note_frame(&hop, hop.channel);
+                }
+            }
+        }
+
+        Serial.printf("%-8s %10u %10u %12.1f %12.0f\n", hop_policy_name(policies[p]), total, found,
+                      found / (float)minutes, found ? (double)latency / found : 0.0);
+    }
+    free(aps);
+}
+
+// =============================================================================
+// PARSER FUZZ
+// =============================================================================
+// Mutates well-formed frames (bit flips, random bytes, truncation) and checks
+// that every view the 802.11 parser hands out stays inside the frame. Each
+// frame sits in its own exact-size allocation, so building with
+// -fsanitize=address also catches any stray read.
+
+static uint16_t fuzz_template(int kind, uint8_t* buf) {
+    static const uint8_t mac1[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+    static const uint8_t mac2[6] = {0x02, 0x66, 0x77, 0x88, 0x99, 0xAA};
+    static const uint8_t snap[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x88, 0x8E};
+    static const uint8_t rsn[] = {48, 38, 1, 0, 0x00, 0x0F, 0xAC, 4, 1, 0, 0x00, 0x0F, 0xAC, 4,
+                                  1, 0, 0x00, 0x0F, 0xAC, 2, 0, 0, 1, 0,
+                                  0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8,
+                                  0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0};
+    uint16_t n = 0;
+    memset(buf, 0, 512);
+
+    switch (kind) {
+        case 0:  // Beacon with SSID, DS and RSN (with a PMKID list)
+        case 1:  // Association request
+            buf[0] = kind == 0 ? 0x80 : 0x00;
+            memcpy(buf + 4, kind == 0 ? "\xff\xff\xff\xff\xff\xff" : (const char*)mac1, 6);
+            memcpy(buf + 10, kind == 0 ? mac1 : mac2, 6);
+            memcpy(buf + 16, mac1, 6);
+            n = kind == 0 ? 36 : 28;
+            buf[n++] = 0; buf[n++] = 4; memcpy(buf + n, "rick", 4); n += 4;
+            buf[n++] = 3; buf[n++] = 1; buf[n++] = 6;
+            memcpy(buf + n, rsn, sizeof(rsn)); n += sizeof(rsn);
+            return n;
+
+        default: {  // QoS data carrying an EAPOL-Key (M1/M2), optionally WDS
+            bool wds = kind == 3;
+            buf[0] = 0x88;
+            buf[1] = wds ? 0x03 : 0x02;  // From DS (+To DS for WDS)
+            memcpy(buf + 4, mac2, 6);
+            memcpy(buf + 10, mac1, 6);
+            memcpy(buf + 16, mac1, 6);
+            n = 24;
+            if (wds) { memcpy(buf + n, mac2, 6); n += 6; }
+            n += 2;  // QoS control
+            memcpy(buf + n, snap, 8); n += 8;
+            uint8_t* eapol = buf + n;
+            eapol[0] = 2; eapol[1] = 3; eapol[2] = 0; eapol[3] = 95 + 22;
+            eapol[4] = 2; eapol[5] = 0x00; eapol[6] = 0x8A;  // Pairwise, Ack, HMAC-SHA1
+            for (int i = 0; i < 32; i++) eapol[17 + i] = i;
+            eapol[97] = 0; eapol[98] = 22;
+            memcpy(eapol + 99, "\xdd\x14\x00\x0f\xac\x04", 6);
+            n += 4 + 95 + 22;
+            return n;
+        }
+    }
+}
+
+static uint32_t fuzzBad;
+
+static void fuzz_check(const uint8_t* p, uint32_t len, const uint8_t* frame, uint16_t frameLen, const char* what) {
+    if (!p && len == 0) return;
+    if (!p || p < frame || p + len > frame + frameLen) {
+        if (fuzzBad++ < 10) Serial.printf("  out of bounds: %s\n", what);
+    }
+}
+
+static void fuzz_one(const uint8_t* frame, uint16_t len) {
+    dot11_view_t view;
+    if (!dot11_parse(frame, len, &view)) return;
+
+    fuzz_check(view.body, view.bodyLen, frame, len, "body");
+    fuzz_check(view.ra, view.ra ? 6 : 0, frame, len, "ra");
+    fuzz_check(view.ta, view.ta ? 6 : 0, frame, len, "ta");
+    fuzz_check(view.sa, view.sa ? 6 : 0, frame, len, "sa");
+    fuzz_check(view.da, view.da ? 6 : 0, frame, len, "da");
+    fuzz_check(view.bssid, view.bssid ? 6 : 0, frame, len, "bssid");
+
+    const uint8_t* ies;
+    uint16_t iesLen;
+    if (dot11_mgmt_ies(&view, &ies, &iesLen)) {
+        fuzz_check(ies, iesLen, frame, len, "ies");
+        dot11_ie_iter_t it;
+        dot11_ie_t ie;
+        dot11_ie_begin(&it, ies, iesLen);
+        while (dot11_ie_next(&it, &ie)) {
+            fuzz_check(ie.data, ie.len, frame, len, "ie");
+            dot11_rsn_t rsn;
+            if (ie.id == DOT11_IE_RSN && dot11_parse_rsn(ie.data, ie.len, &rsn)) {
+                fuzz_check(rsn.pmkids, rsn.pmkidCount * 16, frame, len, "pmkids");
+            }
+        }
+    }
+
+    dot11_eapol_key_t key;
+    if (dot11_eapol_key(&view, &key)) {
+        fuzz_check(key.eapol, key.eapolLen, frame, len, "eapol");
+        fuzz_check(key.nonce, 32, frame, len, "nonce");
+        fuzz_check(key.mic, 16, frame, len, "mic");
+        fuzz_check(key.keyData, key.keyDataLen, frame, len, "key data");
+        const uint8_t* pmkid;
+        if (dot11_eapol_pmkid(&key, &pmkid)) fuzz_check(pmkid, 16, frame, len, "pmkid");
+    }
+
+    hal_frame_t hf = {frame, len, -50, 6, 0, WIFI_PKT_MGMT};
+    hal_ap_record_t rec;
+    sniffer_parse(&hf, &rec);
+}
+
+static int run_fuzz(uint32_t iterations) {
+    uint8_t base[512];
+    simRng = 0xF00DCAFE;
+    fuzzBad = 0;
+    uint32_t parsed = 0;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint16_t len = fuzz_template(i % 4, base);
+
+        // Mutate: a few byte writes, a bit flip or two, maybe truncate
+        int edits = 1 + sim_rand() % 4;
+        for (int e = 0; e < edits; e++) {
+            uint16_t at = sim_rand() % len;
+            if (sim_rand() & 1) base[at] ^= 1 << (sim_rand() % 8);
+            else base[at] = sim_rand();
+        }
+        if (sim_rand() % 3 == 0) len = sim_rand() % (len + 1);
+
+        uint8_t* frame = (uint8_t*)malloc(len ? len : 1);
+        memcpy(frame, base, len);
+        dot11_view_t view;
+        if (dot11_parse(frame, len, &view)) parsed++;
+        fuzz_one(frame, len);
+        free(frame);
+    }
+
+    Serial.printf("fuzz: %u frames, %u parsed, %u out-of-bounds views\n", iterations, parsed, fuzzBad);
+    return fuzzBad ? 1 : 0;
+}
+
+// =============================================================================
+// 22000 WRITER BENCHMARK
+// =============================================================================
+// Writes the same synthetic handshakes the old way (snprintf/strcat per byte,
+// one open/append/close per record) and through the staged writer, then
+// offers every record to the writer a second time to exercise the dedupe.
+
+static void legacy_save(const handshake_t* hs, const char* path) {
+    File file = SD.open(path, FILE_APPEND);
+    if (!file) return;
+
+    char line[1024];
+    snprintf(line, sizeof(line), "WPA*02*");
+    for (int i = 0; i < 16; i++) { char h[3]; snprintf(h, 3, "%02x", hs->mic[i]); strcat(line, h); }
+    strcat(line, "*");
+    for (int i = 0; i < 6; i++) { char h[3]; snprintf(h, 3, "%02x", hs->bssid[i]); strcat(line, h); }
+    strcat(line, "*");
+    for (int i = 0; i < 6; i++) { char h[3]; snprintf(h, 3, "%02x", hs->station[i]); strcat(line, h); }
+    strcat(line, "**");
+    for (int i = 0; i < 32; i++) { char h[3]; snprintf(h, 3, "%02x", hs->anonce[i]); strcat(line, h); }
+    strcat(line, "*");
+    for (int i = 0; i < hs->eapolLen; i++) { char h[3]; snprintf(h, 3, "%02x", hs->eapol[i]); strcat(line, h); }
+    strcat(line, "*02\n");
+
+    file.print(line);
+    file.close();
+}
+
+static void run_hc_bench(uint32_t records) {
+    handshake_t* hs = (handshake_t*)calloc(records, sizeof(handshake_t));
+    simRng = 0x22000;
+    for (uint32_t i = 0; i < records; i++) {
+        for (int b = 0; b < 16; b++) hs[i].mic[b] = sim_rand();
+        for (int b = 0; b < 32; b++) hs[i].anonce[b] = sim_rand();
+        for (int b = 0; b < 6; b++) hs[i].bssid[b] = sim_rand();
+        for (int b = 0; b < 6; b++) hs[i].station[b] = sim_rand();
+        hs[i].eapolLen = 121;
+        for (int b = 0; b < hs[i].eapolLen; b++) hs[i].eapol[b] = sim_rand();
+        hs[i].messagePair = MSGPAIR_M2M3;
+    }
+
+    SD.mkdir("/bench");
+    SD.remove("/bench/legacy.22000");
+    SD.remove("/bench/staged.22000");
+
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < records; i++) legacy_save(&hs[i], "/bench/legacy.22000");
+    uint32_t legacyUs = micros() - start;
+
+    hc22000_writer_t w;
+    hc22000_init(&w, records);
+    start = micros();
+    hc22000_open(&w, "/bench/staged.22000");
+    for (uint32_t i = 0; i < records; i++) {
+        hc22000_write_eapol(&w, hs[i].mic, hs[i].bssid, hs[i].station, hs[i].ssid,
+                            hs[i].anonce, hs[i].eapol, hs[i].eapolLen, hs[i].messagePair);
+    }
+    hc22000_close(&w);
+    uint32_t stagedUs = micros() - start;
+
+    hc22000_open(&w, "/bench/staged.22000");
+    for (uint32_t i = 0; i < records; i++) {
+        hc22000_write_eapol(&w, hs[i].mic, hs[i].bssid, hs[i].station, hs[i].ssid,
+                            hs[i].anonce, hs[i].eapol, hs[i].eapolLen, hs[i].messagePair);
+    }
+    hc22000_close(&w);
+
+    Serial.printf("%-8s %10s %12s %10s\n", "writer", "records", "records/s", "writes");
+    Serial.printf("%-8s %10u %12.0f %10u\n", "legacy", records, records * 1e6 / (legacyUs ? legacyUs : 1), records);
+    Serial.printf("%-8s %10u %12.0f %10u\n", "staged", w.records, w.records * 1e6 / (stagedUs ? stagedUs : 1),
+                  w.sectorWrites);
+    Serial.printf("second pass: %u duplicates skipped, %u bytes written\n", w.duplicates, w.bytes);
+
+    hc22000_free(&w);
+    free(hs);
+}
+
+// =============================================================================
+// FILTER BENCHMARK
+// =============================================================================
+// Time per frame for filters holding 1 and 256 BSSIDs, over frames that
+// mostly miss, to show the set lookup does not grow with the filter.
+
+static void run_filter_bench(uint32_t frames) {
+    const uint32_t POOL = 4096;
+    uint8_t* pool = (uint8_t*)malloc(POOL * 24);
+    simRng = 0xF117E6;
+    for (uint32_t i = 0; i < POOL * 24; i++) pool[i] = sim_rand();
+    for (uint32_t i = 0; i < POOL; i++) {
+        pool[i * 24] = 0x80;                    // Beacon
+        pool[i * 24 + 1] = 0x00;
+    }
+
+    const uint16_t sizes[] = {1, 16, 256};
+    Serial.printf("%-8s %12s %10s %10s\n", "bssids", "frames", "accepted", "ns/frame");
+    for (int s = 0; s < 3; s++) {
+        capfilter_t f;
+        capfilter_compile(&f, "mgmt rssi>=-90");
+        for (uint16_t i = 0; i < sizes[s]; i++) {
+            capfilter_add_bssid(&f, pool + (i * 7 % POOL) * 24 + 16);
+        }
+
+        hal_frame_t hf = {nullptr, 24, -60, 6, 0, WIFI_PKT_MGMT};
+        uint32_t start = micros();
+        for (uint32_t i = 0; i < frames; i++) {
+            hf.payload = pool + (i % POOL) * 24;
+            capfilter_match(&f, &hf);
+        }
+        uint32_t us = micros() - start;
+        Serial.printf("%-8u %12u %10u %10.1f\n", sizes[s], frames, f.accepted, us * 1000.0 / frames);
+    }
+    free(pool);
+}
+
+// =============================================================================
+// NMEA PARSER BENCHMARK
+// =============================================================================
+// The fixed-point parser against TinyGPSPlus over the same log, replayed
+// until at least NMEA_BENCH_BYTES have gone through each. A checking pass
+// first compares the positions both commit.
+
+#define NMEA_BENCH_BYTES    (8 * 1024 * 1024)
+
+static int run_nmea_bench(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        Serial.printf("Cannot open %s\n", path);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    rewind(f);
+    char* log = (char*)malloc(len > 0 ? len : 1);
+    if (len <= 0 || fread(log, 1, len, f) != (size_t)len) {
+        Serial.printf("Cannot read %s\n", path);
+        fclose(f);
+        free(log);
+        return 1;
+    }
+    fclose(f);
+    uint32_t passes = (NMEA_BENCH_BYTES + len - 1) / len;
+
+    // Agreement
+    static nmea_parser_t fixed;
+    static TinyGPSPlus tiny;
+    nmea_parser_init(&fixed);
+    uint32_t compared = 0;
+    double worst = 0;
+    for (long i = 0; i < len; i++) {
+        uint8_t type = nmea_parse(&fixed, log[i], 0);
+        if (!tiny.encode(log[i]) || !(type & (NMEA_RMC | NMEA_GGA)) || !fixed.fix.valid) continue;
+        double d = fmax(fabs(tiny.location.lat() - fixed.fix.lat * 1e-7),
+                        fabs(tiny.location.lng() - fixed.fix.lon * 1e-7));
+        if (d > worst) worst = d;
+        compared++;
+    }
+    Serial.printf("%ld bytes, %u sentences, %u checksum errors | %u fixes compared, worst %.7f deg\n",
+                  len, fixed.sentences, fixed.checksumErrors, compared, worst);
+
+    // Throughput
+    nmea_parser_init(&fixed);
+    uint32_t start = micros();
+    for (uint32_t p = 0; p < passes; p++) {
+        for (long i = 0; i < len; i++) nmea_parse(&fixed, log[i], 0);
+    }
+    uint32_t fixedUs = micros() - start;
+
+    TinyGPSPlus bench;
+    start = micros();
+    for (uint32_t p = 0; p < passes; p++) {
+        for (long i = 0; i < len; i++) bench.encode(log[i]);
+    }
+    uint32_t tinyUs = micros() - start;
+
+    double bytes = (double)len * passes;
+    Serial.printf("%-12s %10s %10s %10s\n", "parser", "fixes", "ns/byte", "us/fix");
+    Serial.printf("%-12s %10u %10.2f %10.3f\n", "fixed-point", fixed.fix.fixes,
+                  fixedUs * 1000.0 / bytes, fixed.fix.fixes ? (double)fixedUs / fixed.fix.fixes : 0.0);
+    Serial.printf("%-12s %10u %10.2f %10.3f\n", "TinyGPSPlus", bench.sentencesWithFix(),
+                  tinyUs * 1000.0 / bytes, bench.sentencesWithFix() ? (double)tinyUs / bench.sentencesWithFix() : 0.0);
+
+    free(log);
+    return 0;
+}
+
+// =============================================================================
+// WARDRIVE JOURNAL BENCHMARK
+// =============================================================================
+// A drive past aps access points in a line, JOURNAL_NEW_PER_TICK new ones per
+// scan. Each is heard from JOURNAL_RANGE slots away and gets stronger until
+// the car passes it. The journal flushes as it would on the device; the old
+// save (every row, each time the count passes a multiple of 100) runs alongside
+// on the same table. Its file is removed after each save so the bench does
+// not need gigabytes of disk; the work per save is unchanged.
+
+#define JOURNAL_NEW_PER_TICK    10
+#define JOURNAL_RANGE           20
+
+static uint32_t legacy_wardrive_save(const wardrive_state_t* state, const char* path) {
+    File file = SD.open(path, FILE_APPEND);
+    if (!file) return 0;
+
+    uint32_t bytes = 0;
+    for (uint32_t i = 0; i < state->pointCount; i++) {
+        const wardrive_point_t* p = &state->points[i];
+        char seen[24];
+        utc_format(p->firstSeen, seen, sizeof(seen));
+        bytes += file.printf("%02X:%02X:%02X:%02X:%02X:%02X,%s,%s,%s,%d,%d,%.8f,%.8f,%.1f,10,WIFI\n",
+                             p->bssid[0], p->bssid[1], p->bssid[2],
+                             p->bssid[3], p->bssid[4], p->bssid[5],
+                             p->ssid, "[WPA2-PSK]", seen,
+                             p->channel, p->rssi,
+                             p->latitude, p->longitude, p->altitude);
+    }
+    file.close();
+    return bytes;
+}
+
+// Start a session with the car at the first slot
+static void journal_drive_begin(wardrive_state_t* w, scanner_state_t* sweep, nmea_fix_t* fix) {
+    utc_clock_init(&utcClock);
+    sweep->networks = (network_info_t*)calloc(2 * JOURNAL_RANGE + 1, sizeof(network_info_t));
+
+    SD.mkdir("/sd");
+    SD.mkdir(DIR_ROOT);
+    SD.mkdir(DIR_WARDRIVING);
+    SD.mkdir("/bench");
+    wardrive_start(w);
+
+    memset(fix, 0, sizeof(nmea_fix_t));
+    fix->valid = true;
+    fix->satellites = 9;
+    fix->lat = 515000000;
+}
+
+// Move the car to scan t and fill the sweep with what it hears there
+static void journal_drive_step(scanner_state_t* sweep, nmea_fix_t* fix, uint32_t aps, uint32_t t) {
+    int32_t car = t * JOURNAL_NEW_PER_TICK;
+    fix->lon = car * 1000;                          // About 7 m per slot
+    fix->stampMs = t + 1;
+
+    sweep->count = 0;
+    for (int32_t ap = car - JOURNAL_RANGE; ap <= car + JOURNAL_RANGE; ap++) {
+        if (ap < 0 || ap >= (int32_t)aps) continue;
+        network_info_t* n = &sweep->networks[sweep->count++];
+        n->bssid[0] = 0x02;
+        n->bssid[1] = 0xB3;
+        memcpy(n->bssid + 2, &ap, 4);
+        snprintf(n->ssid, sizeof(n->ssid), "drive-%ld", (long)ap);
+        n->rssi = -40 - 2 * abs(ap - car) - (int)(sim_rand() % 4);
+        n->channel = 1 + ap % 11;
+        n->authmode = WIFI_AUTH_WPA2_PSK;
+    }
+}
+
+static void run_journal_bench(uint32_t aps) {
+    static wardrive_state_t w;
+    static scanner_state_t sweep;
+    if (!wardrive_init(&w, aps)) return;
+    nmea_fix_t fix;
+    journal_drive_begin(&w, &sweep, &fix);
+
+    uint32_t legacySaves = 0, legacyMaxUs = 0;
+    uint64_t legacyRows = 0, legacyBytes = 0, legacyUs = 0;
+    uint32_t ticks = aps / JOURNAL_NEW_PER_TICK + JOURNAL_RANGE;
+    simRng = 0x3A7D;
+
+    for (uint32_t t = 0; t < ticks; t++) {
+        journal_drive_step(&sweep, &fix, aps, t);
+        uint32_t before = w.pointCount;
+        wardrive_tick(&w, &sweep, &fix);
+        if (w.pointCount / 100 != before / 100) {
+            uint32_t start = micros();
+            legacyBytes += legacy_wardrive_save(&w, "/bench/legacy.csv");
+            uint32_t us = micros() - start;
+            SD.remove("/bench/legacy.csv");
+            legacySaves++;
+            legacyRows += w.pointCount;
+            legacyUs += us;
+            if (us > legacyMaxUs) legacyMaxUs = us;
+        }
+    }
+
+    uint32_t journalRows = w.journalRows + wardrive_pending(&w);
+    wardrive_stop(&w);
+    File final = SD.open(w.sessionFile, FILE_READ);
+    size_t finalBytes = final ? final.size() : 0;
+    if (final) final.close();
+
+    Serial.printf("%u APs over %u scans\n", w.pointCount, ticks);
+    Serial.printf("%-8s %8s %12s %14s %12s %12s\n", "writer", "flushes", "rows", "bytes", "avg us", "max us");
+    Serial.printf("%-8s %8u %12llu %14llu %12.0f %12u\n", "legacy", legacySaves,
+                  (unsigned long long)legacyRows, (unsigned long long)legacyBytes,
+                  legacySaves ? (double)legacyUs / legacySaves : 0.0, legacyMaxUs);
+    Serial.printf("%-8s %8u %12u %14u %12.0f %12u\n", "journal", w.flushes, journalRows, w.journalBytes,
+                  w.flushes ? (double)w.flushUs / w.flushes : 0.0, w.flushMaxUs);
+    Serial.printf("final WiGLE CSV %u rows, %zu bytes\n", w.pointCount, finalBytes);
+    free(sweep.networks);
+}
+
+// =============================================================================
+// AP LOCATION BENCHMARK
+// =============================================================================
+// An hour's drive at 10 m/s on a grid of streets LOCATE_BLOCK_M apart, turning
+// at random at each crossing, one scan a second. APs sit at random inside the
+// blocks. RSSI follows a path loss deliberately unlike the locator's model,
+// with log-normal shadowing, and scans miss some APs. Compares the error of
+// the best-RSSI position, the centroid and the final estimate.
+
+#define LOCATE_AREA_M       1000
+#define LOCATE_BLOCK_M      100
+#define LOCATE_SPEED_MS     10
+#define LOCATE_SCANS        3600
+#define LOCATE_RSSI_1M      -38.0f
+#define LOCATE_PATH_LOSS    3.0f
+#define LOCATE_SHADOW_DB    4.0f
+#define LOCATE_FLOOR_DBM    -92
+#define LOCATE_MISS         0.2f
+
+typedef struct {
+    float x, y;
+    ap_locator_t loc;
+    int8_t bestRssi;
+    float bestX, bestY;
+} locate_ap_t;
+
+static float sim_gauss() {
+    float u = fmaxf(sim_unit(), 1e-7f);
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)M_PI * sim_unit());
+}
+
+static int cmp_float(const void* a, const void* b) {
+    float d = *(const float*)a - *(const float*)b;
+    return d < 0 ? -1 : d > 0;
+}
+
+static void print_errors(const char* name, float* err, uint32_t n) {
+    qsort(err, n, sizeof(float), cmp_float);
+    double sum = 0;
+    for (uint32_t i = 0; i < n; i++) sum += err[i];
+    Serial.printf("%-10s %10.1f %10.1f %10.1f\n", name, n ? sum / n : 0.0,
+                  n ? err[n / 2] : 0.0f, n ? err[n * 9 / 10] : 0.0f);
+}
+
+static void run_locate_bench(uint32_t aps) {
+    const double LAT0 = 51.5, LON0 = -0.12;
+    const double mPerLon = 111320.0 * cos(LAT0 * M_PI / 180.0);
+    locate_ap_t* ap = (locate_ap_t*)calloc(aps, sizeof(locate_ap_t));
+    simRng = 0x10CA7E;
+    for (uint32_t i = 0; i < aps; i++) {
+        // Off the street by at least 5 m
+        do {
+            ap[i].x = sim_unit() * LOCATE_AREA_M;
+            ap[i].y = sim_unit() * LOCATE_AREA_M;
+        } while (fabsf(fmodf(ap[i].x + 5, LOCATE_BLOCK_M) - 5) < 5 || fabsf(fmodf(ap[i].y + 5, LOCATE_BLOCK_M) - 5) < 5);
+        ap_locator_init(&ap[i].loc);
+        ap[i].bestRssi = -128;
+    }
+
+    // Car on the grid: position, heading (0 E, 1 N, 2 W, 3 S)
+    float cx = 0, cy = 0;
+    int heading = 0;
+    uint64_t sightings = 0;
+    for (uint32_t s = 0; s < LOCATE_SCANS; s++) {
+        for (int m = 0; m < LOCATE_SPEED_MS; m++) {
+            cx += heading == 0 ? 1 : heading == 2 ? -1 : 0;
+            cy += heading == 1 ? 1 : heading == 3 ? -1 : 0;
+            if ((int)cx % LOCATE_BLOCK_M == 0 && (int)cy % LOCATE_BLOCK_M == 0) {
+                int turn = sim_rand() % 3;                  // Left, straight, right
+                heading = (heading + 3 + turn) % 4;
+                if ((heading == 0 && cx >= LOCATE_AREA_M) || (heading == 2 && cx <= 0)) heading ^= 2;
+                if ((heading == 1 && cy >= LOCATE_AREA_M) || (heading == 3 && cy <= 0)) heading ^= 2;
+            }
+        }
+
+        double lat = LAT0 + cy / 110574.0;
+        double lon = LON0 + cx / mPerLon;
+        for (uint32_t i = 0; i < aps; i++) {
+            float d = fmaxf(hypotf(ap[i].x - cx, ap[i].y - cy), 1.0f);
+            float rssi = LOCATE_RSSI_1M - 10.0f * LOCATE_PATH_LOSS * log10f(d) + LOCATE_SHADOW_DB * sim_gauss();
+            if (rssi < LOCATE_FLOOR_DBM || sim_unit() < LOCATE_MISS) continue;
+            int8_t r = (int8_t)fmaxf(rssi, -127.0f);
+
+            ap_locator_add(&ap[i].loc, lat, lon, r);
+            sightings++;
+            if (r > ap[i].bestRssi) {
+                ap[i].bestRssi = r;
+                ap[i].bestX = cx;
+                ap[i].bestY = cy;
+            }
+        }
+    }
+
+    // Cost of a sighting on its own
+    ap_locator_t scratch;
+    ap_locator_init(&scratch);
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < 1000000; i++) {
+        ap_locator_add(&scratch, LAT0 + (i & 255) * 1e-6, LON0 + (i >> 8 & 255) * 1e-6, -50 - (int8_t)(i % 40));
+    }
+    uint32_t addUs = micros() - start;
+
+    float* best = (float*)malloc(aps * sizeof(float));
+    float* centroid = (float*)malloc(aps * sizeof(float));
+    float* estimate = (float*)malloc(aps * sizeof(float));
+    uint32_t located = 0, refined = 0;
+    start = micros();
+    for (uint32_t i = 0; i < aps; i++) {
+        const ap_locator_t* loc = &ap[i].loc;
+        double lat, lon;
+        locator_method_t method = ap_locator_estimate(loc, &lat, &lon);
+        if (method == LOCATOR_NONE) continue;
+        if (method == LOCATOR_REFINED) refined++;
+
+        float ex = (float)((lon - LON0) * mPerLon);
+        float ey = (float)((lat - LAT0) * 110574.0);
+        float gx = (float)((loc->lon0 * 1e-7 - LON0) * mPerLon) + loc->sx / loc->sw;
+        float gy = (float)((loc->lat0 * 1e-7 - LAT0) * 110574.0) + loc->sy / loc->sw;
+        best[located] = hypotf(ap[i].bestX - ap[i].x, ap[i].bestY - ap[i].y);
+        centroid[located] = hypotf(gx - ap[i].x, gy - ap[i].y);
+        estimate[located] = hypotf(ex - ap[i].x, ey - ap[i].y);
+        located++;
+    }
+    uint32_t estimateUs = micros() - start;
+
+    Serial.printf("%u of %u APs heard, %llu sightings, %u refined | %.3f us/sighting, %.3f us/estimate\n",
+                  located, aps, (unsigned long long)sightings, refined,
+                  addUs / 1e6, located ? (double)estimateUs / located : 0.0);
+    Serial.printf("%-10s %10s %10s %10s\n", "position", "mean m", "median m", "p90 m");
+    print_errors("best RSSI", best, located);
+    print_errors("centroid", centroid, located);
+    print_errors("estimate", estimate, located);
+
+    free(best);
+    free(centroid);
+    free(estimate);
+    free(ap);
+}
+
+// =============================================================================
+// BINARY WARDRIVE LOG
+// =============================================================================
+// --wlog-export runs the device's streaming export job over a session
+// journal, to WiGLE CSV, KML or GeoJSON by extension; both paths are on the
+// SD stand-in. --wlog-bench writes one synthetic session both ways, checks
+// that the log decodes back to what went in, then flips a byte to show the
+// damage stays inside one block. --export-bench exports a synthetic journal
+// with superseded records through the table and through the job, then checks
+// the job against wardrive_stop() on a drive like the journal bench's.
+
+static int run_wlog_export(const char* in, const char* out) {
+    if (!hal_sd_begin()) return 1;
+    static wardrive_export_t job;
+    if (!wardrive_export_init(&job, WARDRIVE_EXPORT_MAX_APS)) return 1;
+    if (!wardrive_export_begin(&job, in, out, wardrive_export_format(out))) return 1;
+
+    uint32_t steps = 0;
+    while (wardrive_export_step(&job, WARDRIVE_EXPORT_SLICE_US)) steps++;
+    Serial.printf("%u steps, longest %u us\n", steps + 1, job.stepMaxUs);
+
+    bool ok = job.phase == EXPORT_DONE;
+    wardrive_export_free(&job);
+    return ok ? 0 : 1;
+}
+
+static const char* const SIM_SSIDS[] = {
+    "xfinitywifi", "BTWiFi-with-FON", "NETGEAR", "linksys", "TP-Link_Guest", "Starbucks WiFi",
+    "attwifi", "eduroam", "HP-Print-Direct", "Vodafone Homespot", "Telekom_FON", "DIRECT-roku",
+};
+
+typedef struct {
+    int32_t lat, lon;
+    uint32_t time;
+} sim_drive_t;
+
+// Next AP along a drive, within 40 m of the road
+static void sim_record(wlog_record_t* r, uint32_t i, sim_drive_t* d) {
+    memset(r, 0, sizeof(wlog_record_t));
+    r->bssid[0] = 0x02;
+    for (int b = 1; b < 6; b++) r->bssid[b] = sim_rand();
+    float kind = sim_unit();
+    if (kind < 0.1f) r->ssid[0] = '\0';
+    else if (kind < 0.4f) strcpy(r->ssid, SIM_SSIDS[sim_rand() % (sizeof(SIM_SSIDS) / sizeof(SIM_SSIDS[0]))]);
+    else snprintf(r->ssid, sizeof(r->ssid), "Home-%04X%02X", (unsigned)(sim_rand() & 0xFFFF), i & 0xFF);
+    r->rssi = -45 - (int8_t)(sim_rand() % 45);
+    r->channel = sim_channel();
+    r->authmode = WIFI_AUTH_WPA2_PSK;
+
+    d->lat += 300 + (int32_t)(sim_rand() % 300);
+    d->lon += 200 + (int32_t)(sim_rand() % 400);
+    d->time += sim_rand() % 3;
+    r->lat = d->lat + (int32_t)(sim_rand() % 7000) - 3500;
+    r->lon = d->lon + (int32_t)(sim_rand() % 7000) - 3500;
+    r->altDm = 450 + (int32_t)(sim_rand() % 40);
+    r->time = d->time;
+    r->sightings = 1 + sim_rand() % 30;
+}
+
+typedef struct {
+    const wlog_record_t* expect;
+    uint32_t next;
+    uint32_t mismatches;
+} wlog_check_t;
+
+static void check_record(const wlog_record_t* rec, void* ctx) {
+    wlog_check_t* c = (wlog_check_t*)ctx;
+    const wlog_record_t* e = &c->expect[c->next++];
+    if (memcmp(rec->bssid, e->bssid, 6) || strcmp(rec->ssid, e->ssid) || rec->rssi != e->rssi ||
+        rec->channel != e->channel || rec->authmode != e->authmode || rec->lat != e->lat ||
+        rec->lon != e->lon || rec->altDm != e->altDm || rec->time != e->time || rec->sightings != e->sightings) {
+        c->mismatches++;
+    }
+}
+
+static void count_record(const wlog_record_t* rec, void* ctx) {
+    (void)rec;
+    (*(uint32_t*)ctx)++;
+}
+
+static void run_wlog_bench(uint32_t points) {
+    static wardrive_state_t w;
+    if (!wardrive_init(&w, points)) return;
+    wlog_record_t* recs = (wlog_record_t*)calloc(points, sizeof(wlog_record_t));
+
+    simRng = 0xB1A7;
+    sim_drive_t drive = {515000000, -1200000, 1750000000};
+    for (uint32_t i = 0; i < points; i++) {
+        sim_record(&recs[i], i, &drive);
+        wardrive_restore(&w, &recs[i]);
+    }
+
+    SD.mkdir("/bench");
+    uint32_t start = micros();
+    wardrive_export_wigle(&w, "/bench/points.csv");
+    uint32_t csvUs = micros() - start;
+    File csv = SD.open("/bench/points.csv", FILE_READ);
+    size_t csvBytes = csv ? csv.size() : 0;
+    if (csv) csv.close();
+
+    wlog_writer_t writer;
+    wlog_writer_init(&writer);
+    start = micros();
+    wlog_create(&writer, "/bench/points.rwl");
+    for (uint32_t i = 0; i < w.pointCount; i++) {
+        wlog_record_t rec;
+        wardrive_to_record(&w.points[i], &rec);
+        wlog_write(&writer, &rec);
+    }
+    wlog_close(&writer);
+    uint32_t binUs = micros() - start;
+
+    // Read back
+    File file = SD.open("/bench/points.rwl", FILE_READ);
+    size_t len = file ? file.size() : 0;
+    uint8_t* data = (uint8_t*)malloc(len ? len : 1);
+    if (file) {
+        file.read(data, len);
+        file.close();
+    }
+    wlog_reader_t reader;
+    wlog_reader_init(&reader);
+    wlog_check_t check = {recs, 0, 0};
+    start = micros();
+    wlog_read(&reader, data, len, true, check_record, &check);
+    uint32_t decodeUs = micros() - start;
+
+    Serial.printf("%-8s %12s %12s %12s\n", "format", "bytes", "bytes/point", "us/point");
+    Serial.printf("%-8s %12zu %12.1f %12.3f\n", "csv", csvBytes, (double)csvBytes / points, (double)csvUs / points);
+    Serial.printf("%-8s %12zu %12.1f %12.3f\n", "binary", len, (double)len / points, (double)binUs / points);
+    Serial.printf("%u blocks, %u SSID definitions | decoded %u points in %u us, %u mismatches\n",
+                  writer.blocks, writer.ssids, check.next, decodeUs, check.mismatches);
+
+    // One flipped byte mid-file
+    data[len / 2] ^= 0x5A;
+    uint32_t survived = 0;
+    wlog_reader_init(&reader);
+    wlog_read(&reader, data, len, true, count_record, &survived);
+    Serial.printf("byte flipped at %zu: %u of %u points recovered, %u bad blocks, %u bytes skipped\n",
+                  len / 2, survived, points, reader.badBlocks, reader.skippedBytes);
+
+    wlog_writer_free(&writer);
+    free(data);
+    free(recs);
+}
+
+static void restore_record(const wlog_record_t* rec, void* ctx) {
+    wardrive_restore((wardrive_state_t*)ctx, rec);
+}
+
+// Lines of a text file in any order: a count and a sum of line hashes, less
+// the comma GeoJSON puts after every feature but the last
+static uint64_t line_digest(const char* path, uint32_t* lines) {
+    *lines = 0;
+    File file = SD.open(path, FILE_READ);
+    if (!file) return 0;
+
+    uint64_t sum = 0;
+    char line[WARDRIVE_MAX_ROW];
+    size_t len = 0;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (buf[i] != '\n') {
+                if (len < sizeof(line)) line[len++] = buf[i];
+                continue;
+            }
+            if (len && line[len - 1] == ',') len--;
+            uint64_t h = 14695981039346656037ULL;
+            for (size_t k = 0; k < len; k++) h = (h ^ (uint8_t)line[k]) * 1099511628211ULL;
+            sum += h;
+            (*lines)++;
+            len = 0;
+        }
+    }
+    file.close();
+    return sum;
+}
+
+// A wardrive_tick() session with a moving fix, so estimates shift and points
+// are journaled again. The job's CSV of its journal must have the lines of
+// the CSV wardrive_stop() writes from the table
+static bool export_session_matches(wardrive_export_t* job, uint32_t aps, uint32_t* lines) {
+    static wardrive_state_t w;
+    static scanner_state_t sweep;
+    if (!wardrive_init(&w, aps)) return false;
+    nmea_fix_t fix;
+    journal_drive_begin(&w, &sweep, &fix);
+
+    simRng = 0x5E55;
+    uint32_t ticks = aps / JOURNAL_NEW_PER_TICK + JOURNAL_RANGE;
+    for (uint32_t t = 0; t < ticks; t++) {
+        journal_drive_step(&sweep, &fix, aps, t);
+        wardrive_tick(&w, &sweep, &fix);
+    }
+    wardrive_stop(&w);
+    free(sweep.networks);
+
+    wardrive_export_begin(job, w.journalFile, "/bench/session.csv", EXPORT_WIGLE);
+    while (wardrive_export_step(job, WARDRIVE_EXPORT_SLICE_US)) {}
+
+    uint32_t stopLines;
+    uint64_t stopSum = line_digest(w.sessionFile, &stopLines);
+    return job->phase == EXPORT_DONE && line_digest("/bench/session.csv", lines) == stopSum &&
+           *lines == stopLines;
+}
+
+static void run_export_bench(uint32_t points) {
+    wlog_record_t* recs = (wlog_record_t*)calloc(points, sizeof(wlog_record_t));
+    wlog_writer_t writer;
+    wlog_writer_init(&writer);
+    SD.mkdir("/bench");
+    wlog_create(&writer, "/bench/session.rwl");
+
+    // Every new AP, now and then a better sighting of an earlier one that
+    // supersedes its record, and a flush every WARDRIVE_FLUSH_ROWS records
+    simRng = 0xE7B0;
+    sim_drive_t drive = {515000000, -1200000, 1750000000};
+    uint32_t records = 0, pending = 0;
+    for (uint32_t i = 0; i < points; i++) {
+        sim_record(&recs[i], i, &drive);
+        wlog_write(&writer, &recs[i]);
+        records++;
+        pending++;
+        if (i > 0 && sim_unit() < 0.3f) {
+            wlog_record_t* r = &recs[sim_rand() % i];
+            if (r->rssi < -30) r->rssi++;
+            r->sightings++;
+            wlog_write(&writer, r);
+            records++;
+            pending++;
+        }
+        if (pending >= WARDRIVE_FLUSH_ROWS) {
+            wlog_flush(&writer);
+            pending = 0;
+        }
+    }
+    wlog_close(&writer);
+    Serial.printf("journal: %u networks, %u records, %u bytes\n", points, records, writer.bytes);
+
+    // Whole session in the table, as wardrive_stop() has it
+    static wardrive_state_t w;
+    if (!wardrive_init(&w, points)) return;
+    uint32_t start = micros();
+    File file = SD.open("/bench/session.rwl", FILE_READ);
+    wlog_reader_t reader;
+    wlog_reader_init(&reader);
+    uint8_t buf[WARDRIVE_EXPORT_CHUNK + WLOG_BLOCK_SIZE];
+    size_t have = 0;
+    for (;;) {
+        size_t n = file.read(buf + have, WARDRIVE_EXPORT_CHUNK);
+        have += n;
+        size_t used = wlog_read(&reader, buf, have, n == 0, restore_record, &w);
+        memmove(buf, buf + used, have - used);
+        have -= used;
+        if (n == 0) break;
+    }
+    file.close();
+    uint32_t loadUs = micros() - start;
+
+    static wardrive_export_t job;
+    if (!wardrive_export_init(&job, WARDRIVE_EXPORT_MAX_APS)) return;
+    size_t tableBytes = (size_t)points * (sizeof(wardrive_point_t) + sizeof(uint32_t)) +
+                        (w.indexMask + 1) * sizeof(uint32_t);
+    size_t jobBytes = (job.seenMask + 1) * sizeof(uint64_t) + WARDRIVE_EXPORT_CHUNK + WLOG_BLOCK_SIZE +
+                      WARDRIVE_STAGE_SIZE;
+
+    static const char* const EXTS[] = {"csv", "kml", "geojson"};
+    uint32_t tableUs[3], jobUs[3], steps[3], stepMax[3], lines[3];
+    bool match[3];
+    for (int f = 0; f < 3; f++) {
+        char tablePath[32], jobPath[32];
+        snprintf(tablePath, sizeof(tablePath), "/bench/table.%s", EXTS[f]);
+        snprintf(jobPath, sizeof(jobPath), "/bench/stream.%s", EXTS[f]);
+
+        start = micros();
+        if (f == EXPORT_WIGLE) wardrive_export_wigle(&w, tablePath);
+        else if (f == EXPORT_KML) wardrive_export_kml(&w, tablePath);
+        else wardrive_export_geojson(&w, tablePath);
+        tableUs[f] = micros() - start;
+
+        start = micros();
+        steps[f] = 1;
+        wardrive_export_begin(&job, "/bench/session.rwl", jobPath, (export_format_t)f);
+        while (wardrive_export_step(&job, WARDRIVE_EXPORT_SLICE_US)) steps[f]++;
+        jobUs[f] = micros() - start;
+        stepMax[f] = job.stepMaxUs;
+
+        uint32_t tableLines;
+        match[f] = line_digest(tablePath, &tableLines) == line_digest(jobPath, &lines[f]) &&
+                   tableLines == lines[f] && job.phase == EXPORT_DONE;
+    }
+
+    Serial.printf("\nRAM: table %zu KB for these %u networks | export job %zu KB for up to %u\n",
+                  tableBytes / 1024, points, jobBytes / 1024, (unsigned)WARDRIVE_EXPORT_MAX_APS);
+    Serial.printf("table load from the journal: %u ms\n\n", loadUs / 1000);
+    Serial.printf("%-8s %10s %10s %8s %12s %10s %6s\n", "format", "table ms", "stream ms", "steps",
+                  "longest us", "lines", "same");
+    for (int f = 0; f < 3; f++) {
+        Serial.printf("%-8s %10u %10u %8u %12u %10u %6s\n", EXTS[f], tableUs[f] / 1000, jobUs[f] / 1000,
+                      steps[f], stepMax[f], lines[f], match[f] ? "yes" : "NO");
+    }
+
+    uint32_t sessionLines = 0;
+    bool sessionSame = export_session_matches(&job, points, &sessionLines);
+    Serial.printf("\nmoving session: job CSV of the journal vs wardrive_stop() CSV, %u lines, same %s\n",
+                  sessionLines, sessionSame ? "yes" : "NO");
+
+    wardrive_export_free(&job);
+    wlog_writer_free(&writer);
+    free(recs);
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+int main(int argc, char** argv) {
+    uint32_t ticks = 1000;
+    bool haveFrames = false;
+    bool sniff = false;
+    uint32_t pcapKB = 0;
+    const char* filterExpr = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (!strcmp(arg, "--scan") && val) {
+            if (!hal_native_scan_open(val)) { Serial.printf("Cannot open %s\n", val); return 1; }
+            i++;
+        } else if (!strcmp(arg, "--synth") && val) {
+            hal_native_scan_synth(atol(val), 40, 1);
+            i++;
+        } else if (!strcmp(arg, "--pcap") && val) {
+            if (!hal_native_frames_open(val)) return 1;
+            haveFrames = true;
+            i++;
+        } else if (!strcmp(arg, "--nmea") && val) {
+            if (!hal_native_gps_open(val, false)) { Serial.printf("Cannot open %s\n", val); return 1; }
+            i++;
+        } else if (!strcmp(arg, "--sd") && val) {
+            SD.setRoot(val);
+            i++;
+        } else if (!strcmp(arg, "--ticks") && val) {
+            ticks = atol(val);
+            i++;
+        } else if (!strcmp(arg, "--hop-bench") && val) {
+            run_hop_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--hc-bench") && val) {
+            if (!hal_sd_begin()) return 1;
+            run_hc_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--fuzz") && val) {
+            return run_fuzz(atol(val));
+        } else if (!strcmp(arg, "--pcapng") && val) {
+            pcapKB = atol(val);
+            i++;
+        } else if (!strcmp(arg, "--filter") && val) {
+            filterExpr = val;
+            i++;
+        } else if (!strcmp(arg, "--nmea-bench") && val) {
+            return run_nmea_bench(val);
+        } else if (!strcmp(arg, "--journal-bench") && val) {
+            if (!hal_sd_begin()) return 1;
+            run_journal_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--wlog-bench") && val) {
+            if (!hal_sd_begin()) return 1;
+            run_wlog_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--export-bench") && val) {
+            if (!hal_sd_begin()) return 1;
+            run_export_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--wlog-export") && val && i + 2 < argc) {
+            return run_wlog_export(val, argv[i + 2]);
+        } else if (!strcmp(arg, "--locate-bench") && val) {
+            run_locate_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--filter-bench") && val) {
+            run_filter_bench(atol(val));
+            return 0;
+        } else if (!strcmp(arg, "--sniff")) {
+            sniff = true;
+        } else if (!strcmp(arg, "--loopback")) {
+            hal_native_lora_loopback(true);
+        } else {
+            Serial.printf("Unknown option: %s\n", arg);
+            return 1;
+        }
+    }
+
+    Serial.println("=== RICK native ===");
+
+    if (!hal_sd_begin()) { Serial.println("SD stand-in unavailable"); return 1; }
+    SD.mkdir("/sd");
+    SD.mkdir(DIR_ROOT);
+    SD.mkdir(DIR_HANDSHAKES);
+    SD.mkdir(DIR_PMKID);
+    SD.mkdir(DIR_WARDRIVING);
+    SD.mkdir(DIR_LOGS);
+    SD.mkdir(DIR_PCAP);
+
+    hal_display_begin();
+    utc_clock_init(&utcClock);
+    nmea_stream_init(&gpsStream, GPS_RING_SIZE, GPS_BAUD_RATE);
+    nmea_parser_init(&gps);
+    hal_gps_begin(GPS_BAUD_RATE, GPS_RATE_MS, GPS_RX_BUFFER, onGpsBytes);
+
+    scanner_init(&scanner, 10000);
+    capture_init(&capture, MAX_CAPTURED_HANDSHAKES, 256);
+    capture_set_essid_source(&capture, lookupEssid);
+    scanner_set_essid_callback(&scanner, onEssid);
+    wardrive_init(&wardrive, 10000);
+    lora_mesh_init(&mesh);
+
+    scanner_start(&scanner);
+    if (filterExpr) {
+        if (!capfilter_compile(&filter, filterExpr)) return 1;
+        scanner_set_filter(&filter);
+    }
+    if (haveFrames) {
+        scanner_set_callback(onFrame);
+        scanner_enable_promisc(&scanner);
+        capture_start_all(&capture);
+    }
+    if (sniff) scanner_start_sniffing(&scanner);
+    if (haveFrames && pcapKB && pcapng_init(&pcap, DIR_PCAP, pcapKB * 1024, PCAP_ROTATE_MS, PCAP_SNAPLEN)) {
+        pcapng_start(&pcap);
+        scanner_set_pcap(&scanner, &pcap);
+    }
+    wardrive_start(&wardrive);
+    lora_mesh_enable(&mesh, true);
+
+    for (uint32_t t = 0; t < ticks; t++) {
+        uint32_t start = micros();
+        scanner_tick(&scanner);
+        record(STAT_SCAN, start);
+
+        if (haveFrames) {
+            start = micros();
+            hal_native_frames_pump(256);
+            record(STAT_CAPTURE, start);
+        }
+
+        start = micros();
+        hal_native_gps_pump(256);
+        readGps();
+        wardrive_tick(&wardrive, &scanner, &gps.fix);
+        record(STAT_WARDRIVE, start);
+
+        start = micros();
+        lora_mesh_update(&mesh);
+        record(STAT_MESH, start);
+    }
+
+    wardrive_stop(&wardrive);
+    capture_stop(&capture);
+    scanner_stop(&scanner);
+    pcapng_stop(&pcap);
+
+    Serial.printf("\n%-10s %10s %10s %10s\n", "subsystem", "ticks", "avg us", "max us");
+    for (int i = 0; i < STAT_COUNT; i++) {
+        if (stats[i].calls == 0) continue;
+        Serial.printf("%-10s %10u %10.1f %10u\n", stats[i].name, stats[i].calls,
+                      (double)stats[i].totalUs / stats[i].calls, stats[i].maxUs);
+    }
+    Serial.printf("networks %u | wardrive points %u | handshakes %u | pmkids %u | mesh rx %u\n",
+                  scanner.count, wardrive.pointCount, capture.handshakeCount,
+                  capture.pmkidCount, mesh.msgReceived);
+    Serial.printf("hidden %u | decloaked %u | watching %u | expired %u\n",
+                  scanner_count_hidden(&scanner), scanner_count_decloaked(&scanner),
+                  scanner.decloak.count, scanner.decloak.expired);
+    char now[24];
+    utc_format(utc_now_us(), now, sizeof(now));
+    Serial.printf("clock %s UTC (%s) | NMEA syncs %u | PPS locks %u | steps %u\n", now,
+                  utc_source_name(utcClock.source), utcClock.nmeaSyncs, utcClock.ppsLocks, utcClock.steps);
+    Serial.printf("nmea bytes %u | dropped %u | sentences %u | ring high-water %u\n",
+                  gpsStream.received, gpsStream.dropped, gpsStream.sentences, gpsStream.highWater);
+    if (scanner.ring) {
+        Serial.printf("frames %u | dropped %u | truncated %u | ring high-water %u\n",
+                      scanner.ring->received, scanner.ring->dropped,
+                      scanner.ring->truncated, scanner.ring->highWater);
+    }
+    if (filterExpr) {
+        Serial.printf("filter accepted %u | rejected %u\n", filter.accepted, filter.rejected);
+    }
+    if (scanner.pcap) {
+        Serial.printf("pcapng %u packets | %u bytes | %u bursts | %u rotations | %u errors\n",
+                      pcap.packets, pcap.bytes, pcap.bursts, pcap.rotations, pcap.errors);
+    }
+    return 0;
+}
@@ -0,0 +1,262 @@
+/**
+ * @file capture_filter.cpp
+ * @brief RICK Capture Filter - frame predicates for the RX callback
+ */
+
+#include "capture_filter.h"
+#include "dot11.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define MAC_TAG                 (1ULL << 48)    // Keeps 00:00:00:00:00:00 nonzero
+#define SLOT_BITS               9               // log2(CAPFILTER_MAC_SLOTS)
+
+static_assert(CAPFILTER_MAC_SLOTS == 1 << SLOT_BITS, "slot count and SLOT_BITS must agree");
+
+typedef struct {
+    const char* name;
+    uint8_t type;
+    uint8_t subtype;
+} subtype_name_t;
+
+static const subtype_name_t SUBTYPE_NAMES[] = {
+    {"assoc-req",    DOT11_TYPE_MGMT, DOT11_MGMT_ASSOC_REQ},
+    {"assoc-resp",   DOT11_TYPE_MGMT, DOT11_MGMT_ASSOC_RESP},
+    {"reassoc-req",  DOT11_TYPE_MGMT, DOT11_MGMT_REASSOC_REQ},
+    {"reassoc-resp", DOT11_TYPE_MGMT, DOT11_MGMT_REASSOC_RESP},
+    {"probe-req",    DOT11_TYPE_MGMT, DOT11_MGMT_PROBE_REQ},
+    {"probe-resp",   DOT11_TYPE_MGMT, DOT11_MGMT_PROBE_RESP},
+    {"beacon",       DOT11_TYPE_MGMT, DOT11_MGMT_BEACON},
+    {"disassoc",     DOT11_TYPE_MGMT, DOT11_MGMT_DISASSOC},
+    {"auth",         DOT11_TYPE_MGMT, DOT11_MGMT_AUTH},
+    {"deauth",       DOT11_TYPE_MGMT, DOT11_MGMT_DEAUTH},
+    {"action",       DOT11_TYPE_MGMT, DOT11_MGMT_ACTION},
+    {"rts",          DOT11_TYPE_CTRL, 11},
+    {"cts",          DOT11_TYPE_CTRL, 12},
+    {"ack",          DOT11_TYPE_CTRL, 13},
+    {"data",         DOT11_TYPE_DATA, 0},
+    {"null",         DOT11_TYPE_DATA, 4},
+    {"qos",          DOT11_TYPE_DATA, 8},
+    {"qos-null",     DOT11_TYPE_DATA, 12},
+};
+
+static const char* const TYPE_NAMES[] = {"mgmt", "ctrl", "data"};
+
+// =============================================================================
+// ADDRESS SETS
+// =============================================================================
+static inline uint64_t mac_key(const uint8_t* mac) {
+    return MAC_TAG | ((uint64_t)mac[0] << 40) | ((uint64_t)mac[1] << 32) |
+           ((uint64_t)mac[2] << 24) | ((uint64_t)mac[3] << 16) | ((uint64_t)mac[4] << 8) | mac[5];
+}
+
+static inline uint64_t mac_hash(uint64_t key) {
+    return key * 0x9E3779B97F4A7C15ULL;
+}
+
+static bool macset_add(capfilter_macset_t* set, const uint8_t* mac) {
+    uint64_t key = mac_key(mac);
+    uint64_t h = mac_hash(key);
+    uint32_t slot = h >> (64 - SLOT_BITS);
+
+    while (set->slots[slot]) {
+        if (set->slots[slot] == key) return true;
+        slot = (slot + 1) & (CAPFILTER_MAC_SLOTS - 1);
+    }
+    if (set->count >= CAPFILTER_MAX_MACS) return false;
+
+    set->slots[slot] = key;
+    uint32_t bit = (h >> 20) & (CAPFILTER_BLOOM_BITS - 1);
+    set->bloom[bit >> 5] |= 1UL << (bit & 31);
+    set->count++;
+    return true;
+}
+
+static inline bool macset_has(const capfilter_macset_t* set, const uint8_t* mac) {
+    uint64_t key = mac_key(mac);
+    uint64_t h = mac_hash(key);
+    uint32_t bit = (h >> 20) & (CAPFILTER_BLOOM_BITS - 1);
+    if (!(set->bloom[bit >> 5] & (1UL << (bit & 31)))) return false;
+
+    // At most half full, so probes stay short
+    uint32_t slot = h >> (64 - SLOT_BITS);
+    while (set->slots[slot]) {
+        if (set->slots[slot] == key) return true;
+        slot = (slot + 1) & (CAPFILTER_MAC_SLOTS - 1);
+    }
+    return false;
+}
+
+bool capfilter_add_bssid(capfilter_t* filter, const uint8_t* mac) {
+    return macset_add(&filter->bssids, mac);
+}
+
+bool capfilter_add_station(capfilter_t* filter, const uint8_t* mac) {
+    return macset_add(&filter->stations, mac);
+}
+
+// =============================================================================
+// COMPILE
+// =============================================================================
+void capfilter_clear(capfilter_t* filter) {
+    memset(filter, 0, sizeof(capfilter_t));
+    for (int t = 0; t < 4; t++) filter->subtypes[t] = 0xFFFF;
+    filter->channels = 0xFFFF;
+    filter->rssiFloor = -128;
+}
+
+static bool parse_mac(const char* s, size_t len, uint8_t* mac) {
+    if (len != 17) return false;
+    for (int i = 0; i < 6; i++) {
+        char hex[3] = {s[i * 3], s[i * 3 + 1], 0};
+        char* end;
+        mac[i] = strtoul(hex, &end, 16);
+        if (*end || (i < 5 && s[i * 3 + 2] != ':')) return false;
+    }
+    return true;
+}
+
+static int type_index(const char* s, size_t len) {
+    for (int t = 0; t < 3; t++) {
+        if (strlen(TYPE_NAMES[t]) == len && strncmp(s, TYPE_NAMES[t], len) == 0) return t;
+    }
+    return -1;
+}
+
+static bool compile_term(capfilter_t* filter, const char* s, size_t len, bool* typed, bool* chans) {
+    uint8_t mac[6];
+
+    if (len > 6 && strncmp(s, "bssid=", 6) == 0) {
+        return parse_mac(s + 6, len - 6, mac) && macset_add(&filter->bssids, mac);
+    }
+    if (len > 4 && strncmp(s, "sta=", 4) == 0) {
+        return parse_mac(s + 4, len - 4, mac) && macset_add(&filter->stations, mac);
+    }
+    if (len > 6 && strncmp(s, "rssi>=", 6) == 0) {
+        int v = atoi(s + 6);
+        if (v < -128 || v > 0) return false;
+        filter->rssiFloor = v;
+        return true;
+    }
+    if (len > 3 && strncmp(s, "ch=", 3) == 0) {
+        if (!*chans) filter->channels = 0;
+        *chans = true;
+        const char* p = s + 3;
+        const char* end = s + len;
+        while (p < end) {
+            int ch = atoi(p);
+            if (ch < 1 || ch > 14) return false;
+            filter->channels |= 1 << ch;
+            while (p < end && *p != ',') p++;
+            p++;
+        }
+        return true;
+    }
+
+    // Frame type, optionally with .subtype
+    const char* dot = (const char*)memchr(s, '.', len);
+    int type = type_index(s, dot ? (size_t)(dot - s) : len);
+    if (type < 0) return false;
+
+    if (!*typed) memset(filter->subtypes, 0, sizeof(filter->subtypes));
+    *typed = true;
+
+    if (!dot) {
+        filter->subtypes[type] = 0xFFFF;
+        return true;
+    }
+
+    const char* sub = dot + 1;
+    size_t subLen = len - (sub - s);
+    if (subLen == 0) return false;
+    if (sub[0] >= '0' && sub[0] <= '9') {
+        int n = atoi(sub);
+        if (n > 15) return false;
+        filter->subtypes[type] |= 1 << n;
+        return true;
+    }
+    for (size_t i = 0; i < sizeof(SUBTYPE_NAMES) / sizeof(SUBTYPE_NAMES[0]); i++) {
+        const subtype_name_t* n = &SUBTYPE_NAMES[i];
+        if (n->type == type && strlen(n->name) == subLen && strncmp(sub, n->name, subLen) == 0) {
+            filter->subtypes[type] |= 1 << n->subtype;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool capfilter_compile(capfilter_t* filter, const char* expr) {
+    capfilter_clear(filter);
+    bool typed = false;
+    bool chans = false;
+
+    const char* p = expr;
+    while (*p) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        const char* start = p;
+        while (*p && *p != ' ') p++;
+
+        if (!compile_term(filter, start, p - start, &typed, &chans)) {
+            Serial.printf("[FILTER] Bad term: %.*s\n", (int)(p - start), start);
+            capfilter_clear(filter);
+            return false;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// MATCH
+// =============================================================================
+// Only the MAC header is read; addresses that fall outside a short frame are
+// treated as absent.
+
+bool capfilter_match(capfilter_t* filter, const hal_frame_t* frame) {
+    const uint8_t* p = frame->payload;
+    uint16_t len = frame->len;
+    bool ok = false;
+
+    do {
+        if (len < 2) break;
+        uint16_t fc = p[0] | (p[1] << 8);
+        uint8_t type = (fc >> 2) & 0x3;
+        uint8_t subtype = (fc >> 4) & 0xF;
+
+        if (!(filter->subtypes[type] & (1 << subtype))) break;
+        if (frame->channel < 16 && !(filter->channels & (1 << frame->channel))) break;
+        if (frame->rssi < filter->rssiFloor) break;
+
+        const uint8_t* a1 = len >= 10 ? p + 4 : nullptr;
+        const uint8_t* a2 = len >= 16 ? p + 10 : nullptr;
+        const uint8_t* a3 = len >= 22 ? p + 16 : nullptr;
+
+        if (filter->bssids.count) {
+            bool hit;
+            if (type == DOT11_TYPE_CTRL) {
+                hit = (a1 && macset_has(&filter->bssids, a1)) || (a2 && macset_has(&filter->bssids, a2));
+            } else {
+                const uint8_t* bssid;
+                switch ((fc >> 8) & 0x3) {
+                    case 0:  bssid = a3; break;     // Mgmt, IBSS data
+                    case 1:  bssid = a1; break;     // To DS
+                    case 2:  bssid = a2; break;     // From DS
+                    default: bssid = nullptr;       // WDS
+                }
+                if (type == DOT11_TYPE_MGMT) bssid = a3;
+                hit = bssid && macset_has(&filter->bssids, bssid);
+            }
+            if (!hit) break;
+        }
+
+        // The client is address 1 or 2 in every layout that has one
+        if (filter->stations.count) {
+            if (!(a1 && macset_has(&filter->stations, a1)) && !(a2 && macset_has(&filter->stations, a2))) break;
+        }
+        ok = true;
+    } while (0);
+
+    if (ok) filter->accepted++;
+    else filter->rejected++;
+    return ok;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file capture_filter.h
+ * @brief RICK Capture Filter - frame predicates for the RX callback
+ *
+ * A filter is compiled once from a short expression and then evaluated on
+ * every received frame, before it is copied into the frame ring. Evaluation
+ * reads only the MAC header and costs the same however many addresses the
+ * filter holds: each address set is a hash table with a 1024-bit prefilter,
+ * so a miss is usually settled by one bit test.
+ *
+ * Expression terms, space separated; a category left out matches anything:
+ *
+ *   mgmt ctrl data          whole frame types
+ *   mgmt.beacon data.8      one subtype, by name or number
+ *   bssid=AA:BB:CC:DD:EE:FF network (repeatable)
+ *   sta=AA:BB:CC:DD:EE:FF   client, either direction (repeatable)
+ *   rssi>=-80               signal floor
+ *   ch=1,6,11               channels
+ */
+
+#ifndef CAPTURE_FILTER_H
+#define CAPTURE_FILTER_H
+
+#include <Arduino.h>
+#include "hal/hal.h"
+
+#define CAPFILTER_MAX_MACS      256     // Per address set
+#define CAPFILTER_MAC_SLOTS     (2 * CAPFILTER_MAX_MACS)
+#define CAPFILTER_BLOOM_BITS    1024
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    uint64_t slots[CAPFILTER_MAC_SLOTS];    // 48-bit MAC | 1 << 48, 0 = empty
+    uint32_t bloom[CAPFILTER_BLOOM_BITS / 32];
+    uint16_t count;
+} capfilter_macset_t;
+
+typedef struct {
+    uint16_t subtypes[4];       // Per frame type, bit n = subtype n accepted
+    uint16_t channels;          // Bit n = channel n accepted
+    int8_t rssiFloor;
+    capfilter_macset_t bssids;
+    capfilter_macset_t stations;
+
+    // Updated from the RX callback
+    volatile uint32_t accepted;
+    volatile uint32_t rejected;
+} capfilter_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Filter that accepts everything
+ */
+void capfilter_clear(capfilter_t* filter);
+
+/**
+ * Compile an expression; on a bad term returns false and leaves the filter
+ * accepting everything
+ */
+bool capfilter_compile(capfilter_t* filter, const char* expr);
+
+/**
+ * Add to the address sets, false when full
+ */
+bool capfilter_add_bssid(capfilter_t* filter, const uint8_t* mac);
+bool capfilter_add_station(capfilter_t* filter, const uint8_t* mac);
+
+/**
+ * Evaluate against a received frame - safe to call from the RX callback
+ */
+bool capfilter_match(capfilter_t* filter, const hal_frame_t* frame);
+
+#endif // CAPTURE_FILTER_H
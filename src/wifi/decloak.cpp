@@ -0,0 +1,118 @@
+/**
+ * @file decloak.cpp
+ * @brief RICK Decloaker - passive SSID recovery for hidden networks
+ */
+
+#include "decloak.h"
+#include "dot11.h"
+#include <string.h>
+
+// =============================================================================
+// WATCH TABLE
+// =============================================================================
+// Small enough that a linear scan beats hashing; a free slot is found the
+// same way.
+
+void decloak_init(decloak_table_t* table, uint32_t expiry_ms) {
+    memset(table, 0, sizeof(decloak_table_t));
+    table->expiryMs = expiry_ms;
+}
+
+static decloak_entry_t* find_entry(decloak_table_t* table, const uint8_t* bssid) {
+    for (int i = 0; i < DECLOAK_SLOTS; i++) {
+        decloak_entry_t* e = &table->entries[i];
+        if (e->inUse && memcmp(e->bssid, bssid, 6) == 0) return e;
+    }
+    return nullptr;
+}
+
+static void release(decloak_table_t* table, decloak_entry_t* e) {
+    e->inUse = false;
+    table->count--;
+}
+
+static void expire(decloak_table_t* table, uint32_t now) {
+    if (now - table->lastExpiry < DECLOAK_EXPIRY_CHECK_MS) return;
+    table->lastExpiry = now;
+
+    for (int i = 0; i < DECLOAK_SLOTS && table->count; i++) {
+        decloak_entry_t* e = &table->entries[i];
+        if (e->inUse && now - e->lastSeen > table->expiryMs) {
+            release(table, e);
+            table->expired++;
+        }
+    }
+}
+
+void decloak_watch(decloak_table_t* table, const uint8_t* bssid) {
+    uint32_t now = millis();
+    expire(table, now);
+
+    decloak_entry_t* e = find_entry(table, bssid);
+    if (!e) {
+        // Take a free slot, else the one whose beacons went quiet longest ago
+        decloak_entry_t* oldest = nullptr;
+        for (int i = 0; i < DECLOAK_SLOTS; i++) {
+            decloak_entry_t* c = &table->entries[i];
+            if (!c->inUse) {
+                e = c;
+                break;
+            }
+            if (!oldest || c->lastSeen < oldest->lastSeen) oldest = c;
+        }
+        if (!e) {
+            e = oldest;
+            release(table, e);
+            table->displaced++;
+        }
+
+        memcpy(e->bssid, bssid, 6);
+        e->inUse = true;
+        e->firstSeen = now;
+        table->count++;
+    }
+    e->lastSeen = now;
+}
+
+void decloak_forget(decloak_table_t* table, const uint8_t* bssid) {
+    decloak_entry_t* e = find_entry(table, bssid);
+    if (e) release(table, e);
+}
+
+// =============================================================================
+// CORRELATION
+// =============================================================================
+bool decloak_match(decloak_table_t* table, const hal_frame_t* frame, uint8_t* bssid, char* ssid) {
+    if (table->count == 0 || frame->type != WIFI_PKT_MGMT) return false;
+
+    dot11_view_t view;
+    if (!dot11_parse(frame->payload, frame->len, &view)) return false;
+    if (view.subtype != DOT11_MGMT_PROBE_RESP && view.subtype != DOT11_MGMT_ASSOC_REQ &&
+        view.subtype != DOT11_MGMT_REASSOC_REQ) {
+        return false;
+    }
+
+    decloak_entry_t* e = find_entry(table, view.bssid);
+    if (!e) return false;
+
+    const uint8_t* ies;
+    uint16_t iesLen;
+    if (!dot11_mgmt_ies(&view, &ies, &iesLen)) return false;
+
+    dot11_ie_iter_t it;
+    dot11_ie_t ie;
+    dot11_ie_begin(&it, ies, iesLen);
+    while (dot11_ie_next(&it, &ie)) {
+        if (ie.id != DOT11_IE_SSID) continue;
+        // Some APs answer probes with the same blank SSID they beacon
+        if (ie.len == 0 || ie.len > 32 || ie.data[0] == '\0') return false;
+
+        memcpy(bssid, view.bssid, 6);
+        memcpy(ssid, ie.data, ie.len);
+        ssid[ie.len] = '\0';
+        release(table, e);
+        table->decloaked++;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file decloak.h
+ * @brief RICK Decloaker - passive SSID recovery for hidden networks
+ *
+ * A hidden AP beacons with a blank SSID but has to name itself in probe
+ * responses, and its clients name it in (re)association requests. BSSIDs
+ * heard with a blank SSID are watched in a small table; the first such
+ * frame that names a watched BSSID decloaks it. Nothing is transmitted -
+ * this only reads frames already drained from the ring. Entries not
+ * refreshed by a beacon within the expiry are dropped.
+ */
+
+#ifndef DECLOAK_H
+#define DECLOAK_H
+
+#include <Arduino.h>
+#include "hal/hal.h"
+
+#define DECLOAK_SLOTS           32      // Hidden BSSIDs watched at once
+#define DECLOAK_EXPIRY_CHECK_MS 1000
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    uint8_t bssid[6];
+    bool inUse;
+    uint32_t firstSeen;
+    uint32_t lastSeen;
+} decloak_entry_t;
+
+typedef struct {
+    decloak_entry_t entries[DECLOAK_SLOTS];
+    uint8_t count;
+    uint32_t expiryMs;
+    uint32_t lastExpiry;
+
+    // Stats
+    uint32_t decloaked;
+    uint32_t expired;
+    uint32_t displaced;         // Oldest entry dropped for a new one
+} decloak_table_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Empty table; watched BSSIDs are dropped expiry_ms after their last beacon
+ */
+void decloak_init(decloak_table_t* table, uint32_t expiry_ms);
+
+/**
+ * Start or keep watching a BSSID heard with a blank SSID
+ */
+void decloak_watch(decloak_table_t* table, const uint8_t* bssid);
+
+/**
+ * Stop watching a BSSID (its SSID became known some other way)
+ */
+void decloak_forget(decloak_table_t* table, const uint8_t* bssid);
+
+/**
+ * Check a drained frame: true when it is a probe response or (re)association
+ * request naming a watched BSSID. bssid and ssid (33 bytes) are filled in
+ * and the entry is released. Returns at once while nothing is watched.
+ */
+bool decloak_match(decloak_table_t* table, const hal_frame_t* frame, uint8_t* bssid, char* ssid);
+
+#endif // DECLOAK_H
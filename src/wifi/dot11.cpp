@@ -0,0 +1,308 @@
+/**
+ * @file dot11.cpp
+ * @brief RICK 802.11 Parser - bounds-checked, zero-copy frame views
+ */
+
+#include "dot11.h"
+#include <string.h>
+
+// Frame control flags
+#define FC_TO_DS            0x0100
+#define FC_FROM_DS          0x0200
+#define FC_PROTECTED        0x4000
+#define FC_ORDER            0x8000
+
+// Control subtypes with only a receiver address
+#define CTRL_CTS            12
+#define CTRL_ACK            13
+
+// EAPOL-Key key information bits
+#define KEYINFO_PAIRWISE    0x0008
+#define KEYINFO_INSTALL     0x0040
+#define KEYINFO_ACK         0x0080
+#define KEYINFO_MIC         0x0100
+#define KEYINFO_ENCRYPTED   0x1000
+
+// Key data encapsulation: vendor element, 00-0F-AC, data type
+#define KDE_TYPE_PMKID      4
+
+// EAPOL PDU: version(1) type(1) length(2), then the key descriptor
+#define EAPOL_HDR_LEN       4
+#define EAPOL_TYPE_KEY      3
+#define EAPOL_KEY_FIXED     95      // Descriptor through key data length
+#define EAPOL_OFF_REPLAY    9
+#define EAPOL_OFF_NONCE     17
+#define EAPOL_OFF_MIC       81
+#define EAPOL_OFF_DATALEN   97
+#define EAPOL_OFF_DATA      99
+
+static const uint8_t LLC_SNAP_EAPOL[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x88, 0x8E};
+
+static inline uint16_t be16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+static inline uint16_t le16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+// =============================================================================
+// MAC HEADER
+// =============================================================================
+bool dot11_parse(const uint8_t* frame, uint16_t len, dot11_view_t* out) {
+    memset(out, 0, sizeof(dot11_view_t));
+    if (!frame || len < 10) return false;
+
+    uint16_t fc = le16(frame);
+    if (fc & 0x0003) return false;  // Protocol version must be 0
+
+    out->frame = frame;
+    out->len = len;
+    out->fc = fc;
+    out->type = (fc >> 2) & 0x3;
+    out->subtype = (fc >> 4) & 0xF;
+    out->toDS = (fc & FC_TO_DS) != 0;
+    out->fromDS = (fc & FC_FROM_DS) != 0;
+    out->isProtected = (fc & FC_PROTECTED) != 0;
+
+    const uint8_t* a1 = frame + 4;
+    const uint8_t* a2 = frame + 10;
+    const uint8_t* a3 = frame + 16;
+    uint16_t hdr;
+
+    switch (out->type) {
+        case DOT11_TYPE_CTRL:
+            out->ra = a1;
+            if (out->subtype == CTRL_CTS || out->subtype == CTRL_ACK) {
+                hdr = 10;
+            } else {
+                hdr = 16;
+                out->ta = a2;
+            }
+            break;
+
+        case DOT11_TYPE_MGMT:
+            hdr = 24;
+            if (fc & FC_ORDER) hdr += 4;  // HT control
+            out->ra = out->da = a1;
+            out->ta = out->sa = a2;
+            out->bssid = a3;
+            break;
+
+        case DOT11_TYPE_DATA:
+            hdr = 24;
+            out->isQos = (out->subtype & 0x8) != 0;
+            out->ra = a1;
+            out->ta = a2;
+            if (out->toDS && out->fromDS) {
+                // WDS/mesh: RA, TA, DA, SA - no BSSID
+                out->da = a3;
+                out->sa = frame + 24;
+                hdr += 6;
+            } else if (out->toDS) {
+                out->bssid = a1;
+                out->sa = a2;
+                out->da = a3;
+            } else if (out->fromDS) {
+                out->da = a1;
+                out->bssid = a2;
+                out->sa = a3;
+            } else {
+                out->da = a1;
+                out->sa = a2;
+                out->bssid = a3;
+            }
+            if (out->isQos) {
+                hdr += 2;
+                if (fc & FC_ORDER) hdr += 4;  // HT control
+            }
+            break;
+
+        default:
+            return false;  // Extension frames
+    }
+
+    if (len < hdr) return false;
+    out->headerLen = hdr;
+    out->body = frame + hdr;
+    out->bodyLen = len - hdr;
+    return true;
+}
+
+// =============================================================================
+// MANAGEMENT BODY
+// =============================================================================
+bool dot11_mgmt_ies(const dot11_view_t* view, const uint8_t** ies, uint16_t* len) {
+    if (view->type != DOT11_TYPE_MGMT || view->isProtected) return false;
+
+    // Fixed fields ahead of the tagged parameters
+    uint16_t fixed;
+    switch (view->subtype) {
+        case DOT11_MGMT_BEACON:
+        case DOT11_MGMT_PROBE_RESP:   fixed = 12; break;  // Timestamp, interval, caps
+        case DOT11_MGMT_ASSOC_REQ:    fixed = 4;  break;  // Caps, listen interval
+        case DOT11_MGMT_REASSOC_REQ:  fixed = 10; break;  // + current AP
+        case DOT11_MGMT_ASSOC_RESP:
+        case DOT11_MGMT_REASSOC_RESP: fixed = 6;  break;  // Caps, status, AID
+        case DOT11_MGMT_PROBE_REQ:    fixed = 0;  break;
+        case DOT11_MGMT_AUTH:         fixed = 6;  break;  // Algorithm, sequence, status
+        default:                      return false;
+    }
+
+    if (view->bodyLen < fixed) return false;
+    *ies = view->body + fixed;
+    *len = view->bodyLen - fixed;
+    return true;
+}
+
+// =============================================================================
+// INFORMATION ELEMENTS
+// =============================================================================
+void dot11_ie_begin(dot11_ie_iter_t* it, const uint8_t* ies, uint16_t len) {
+    it->pos = ies;
+    it->end = ies + len;
+}
+
+bool dot11_ie_next(dot11_ie_iter_t* it, dot11_ie_t* ie) {
+    if (it->end - it->pos < 2) return false;
+
+    uint8_t ieLen = it->pos[1];
+    if (it->end - it->pos - 2 < ieLen) {
+        it->pos = it->end;  // Truncated, nothing after it can be trusted
+        return false;
+    }
+
+    ie->id = it->pos[0];
+    ie->len = ieLen;
+    ie->data = it->pos + 2;
+    it->pos += 2 + ieLen;
+    return true;
+}
+
+bool dot11_ie_find(const uint8_t* ies, uint16_t len, uint8_t id, dot11_ie_t* ie) {
+    dot11_ie_iter_t it;
+    dot11_ie_begin(&it, ies, len);
+    while (dot11_ie_next(&it, ie)) {
+        if (ie->id == id) return true;
+    }
+    return false;
+}
+
+bool dot11_parse_rsn(const uint8_t* data, uint16_t len, dot11_rsn_t* out) {
+    memset(out, 0, sizeof(dot11_rsn_t));
+    out->groupCipher = 0xFF;
+    if (len < 2) return false;
+
+    out->version = le16(data);
+    if (out->version != 1) return false;
+
+    // Every field after the version is optional, but only from the end
+    uint16_t pos = 2;
+    if (pos == len) return true;
+    if (len - pos < 4) return false;
+    if (data[pos] == 0x00 && data[pos + 1] == 0x0F && data[pos + 2] == 0xAC) {
+        out->groupCipher = data[pos + 3];
+    }
+    pos += 4;
+
+    if (pos == len) return true;
+    if (len - pos < 2) return false;
+    out->pairwiseCount = le16(data + pos);
+    pos += 2;
+    if ((uint32_t)(len - pos) < (uint32_t)out->pairwiseCount * 4) return false;
+    pos += out->pairwiseCount * 4;
+
+    if (pos == len) return true;
+    if (len - pos < 2) return false;
+    out->akmCount = le16(data + pos);
+    pos += 2;
+    if ((uint32_t)(len - pos) < (uint32_t)out->akmCount * 4) return false;
+    for (uint16_t i = 0; i < out->akmCount; i++, pos += 4) {
+        const uint8_t* s = data + pos;
+        if (s[0] == 0x00 && s[1] == 0x0F && s[2] == 0xAC && s[3] < 16) {
+            out->akmMask |= 1 << s[3];
+        }
+    }
+
+    if (pos == len) return true;
+    if (len - pos < 2) return false;
+    out->caps = le16(data + pos);
+    pos += 2;
+
+    if (pos == len) return true;
+    if (len - pos < 2) return false;
+    uint16_t pmkids = le16(data + pos);
+    pos += 2;
+    if ((uint32_t)(len - pos) < (uint32_t)pmkids * 16) return false;
+    out->pmkidCount = pmkids;
+    out->pmkids = pmkids ? data + pos : nullptr;
+
+    // Group management cipher may follow; nothing here needs it
+    return true;
+}
+
+// =============================================================================
+// EAPOL-KEY
+// =============================================================================
+bool dot11_eapol_key(const dot11_view_t* view, dot11_eapol_key_t* out) {
+    memset(out, 0, sizeof(dot11_eapol_key_t));
+    if (view->type != DOT11_TYPE_DATA || view->isProtected) return false;
+    if (view->subtype & 0x4) return false;  // Null data, no body
+    if (view->bodyLen < sizeof(LLC_SNAP_EAPOL) + EAPOL_HDR_LEN) return false;
+    if (memcmp(view->body, LLC_SNAP_EAPOL, sizeof(LLC_SNAP_EAPOL)) != 0) return false;
+
+    const uint8_t* eapol = view->body + sizeof(LLC_SNAP_EAPOL);
+    uint16_t avail = view->bodyLen - sizeof(LLC_SNAP_EAPOL);
+    if (eapol[1] != EAPOL_TYPE_KEY) return false;
+
+    // Trust the declared length, the frame may carry padding after it
+    uint16_t bodyLen = be16(eapol + 2);
+    if (bodyLen < EAPOL_KEY_FIXED || (uint32_t)EAPOL_HDR_LEN + bodyLen > avail) return false;
+
+    uint16_t eapolLen = EAPOL_HDR_LEN + bodyLen;
+    uint16_t keyDataLen = be16(eapol + EAPOL_OFF_DATALEN);
+    if ((uint32_t)EAPOL_OFF_DATA + keyDataLen > eapolLen) return false;
+
+    out->eapol = eapol;
+    out->eapolLen = eapolLen;
+    out->descriptor = eapol[4];
+    out->keyInfo = be16(eapol + 5);
+    out->keyVersion = out->keyInfo & 0x0007;
+    out->replayCounter = eapol + EAPOL_OFF_REPLAY;
+    out->nonce = eapol + EAPOL_OFF_NONCE;
+    out->mic = eapol + EAPOL_OFF_MIC;
+    out->micOffset = EAPOL_OFF_MIC;
+    out->keyData = eapol + EAPOL_OFF_DATA;
+    out->keyDataLen = keyDataLen;
+
+    // Which 4-way message; group key handshakes are left at 0
+    uint16_t ki = out->keyInfo;
+    if (ki & KEYINFO_PAIRWISE) {
+        bool ack = ki & KEYINFO_ACK;
+        bool mic = ki & KEYINFO_MIC;
+        if (ack && !mic) out->message = DOT11_EAPOL_M1;
+        else if (ack && mic && (ki & KEYINFO_INSTALL)) out->message = DOT11_EAPOL_M3;
+        else if (!ack && mic) out->message = keyDataLen ? DOT11_EAPOL_M2 : DOT11_EAPOL_M4;
+    }
+    return true;
+}
+
+bool dot11_eapol_pmkid(const dot11_eapol_key_t* key, const uint8_t** pmkid) {
+    if (!key->eapol || (key->keyInfo & KEYINFO_ENCRYPTED)) return false;
+
+    // KDEs share the IE layout; padding (DD 00) ends the walk harmlessly
+    dot11_ie_iter_t it;
+    dot11_ie_t ie;
+    dot11_ie_begin(&it, key->keyData, key->keyDataLen);
+    while (dot11_ie_next(&it, &ie)) {
+        if (ie.id != DOT11_IE_VENDOR || ie.len < 4 + 16) continue;
+        if (ie.data[0] != 0x00 || ie.data[1] != 0x0F || ie.data[2] != 0xAC) continue;
+        if (ie.data[3] != KDE_TYPE_PMKID) continue;
+
+        static const uint8_t zero[16] = {0};
+        if (memcmp(ie.data + 4, zero, 16) == 0) return false;  // Placeholder some APs send
+        *pmkid = ie.data + 4;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file dot11.h
+ * @brief RICK 802.11 Parser - bounds-checked, zero-copy frame views
+ *
+ * Views point into the caller's buffer and are valid as long as it is.
+ * Every accessor checks lengths first; a truncated or malformed frame
+ * yields false, never a read past the end.
+ */
+
+#ifndef DOT11_H
+#define DOT11_H
+
+#include <Arduino.h>
+
+// Frame types (FC bits 2-3)
+#define DOT11_TYPE_MGMT         0
+#define DOT11_TYPE_CTRL         1
+#define DOT11_TYPE_DATA         2
+
+// Management subtypes
+#define DOT11_MGMT_ASSOC_REQ    0
+#define DOT11_MGMT_ASSOC_RESP   1
+#define DOT11_MGMT_REASSOC_REQ  2
+#define DOT11_MGMT_REASSOC_RESP 3
+#define DOT11_MGMT_PROBE_REQ    4
+#define DOT11_MGMT_PROBE_RESP   5
+#define DOT11_MGMT_BEACON       8
+#define DOT11_MGMT_DISASSOC     10
+#define DOT11_MGMT_AUTH         11
+#define DOT11_MGMT_DEAUTH       12
+#define DOT11_MGMT_ACTION       13
+
+// Information element IDs
+#define DOT11_IE_SSID           0
+#define DOT11_IE_DS_PARAMS      3
+#define DOT11_IE_RSN            48
+#define DOT11_IE_VENDOR         221
+
+// RSN AKM suite types (00-0F-AC)
+#define DOT11_AKM_8021X         1
+#define DOT11_AKM_PSK           2
+#define DOT11_AKM_PSK_SHA256    6
+#define DOT11_AKM_SAE           8
+
+// EAPOL-Key message of the 4-way handshake
+#define DOT11_EAPOL_M1          1
+#define DOT11_EAPOL_M2          2
+#define DOT11_EAPOL_M3          3
+#define DOT11_EAPOL_M4          4
+
+// =============================================================================
+// FRAME VIEW
+// =============================================================================
+typedef struct {
+    const uint8_t* frame;
+    uint16_t len;
+    uint16_t fc;                // Frame control, host order
+    uint8_t type;               // DOT11_TYPE_*
+    uint8_t subtype;
+    bool toDS;
+    bool fromDS;
+    bool isProtected;
+    bool isQos;
+    uint16_t headerLen;         // Incl. address 4, QoS and HT control
+
+    // Addresses by role; nullptr when the layout has no such address
+    const uint8_t* ra;          // Receiver (address 1)
+    const uint8_t* ta;          // Transmitter (address 2), nullptr for CTS/ACK
+    const uint8_t* da;
+    const uint8_t* sa;
+    const uint8_t* bssid;       // nullptr for WDS (To+From DS) frames
+
+    const uint8_t* body;        // After the MAC header
+    uint16_t bodyLen;
+} dot11_view_t;
+
+// =============================================================================
+// INFORMATION ELEMENTS
+// =============================================================================
+typedef struct {
+    uint8_t id;
+    uint8_t len;
+    const uint8_t* data;
+} dot11_ie_t;
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+} dot11_ie_iter_t;
+
+typedef struct {
+    uint16_t version;
+    uint8_t groupCipher;        // Suite type, 0xFF for non 00-0F-AC suites
+    uint16_t pairwiseCount;
+    uint16_t akmCount;
+    uint16_t akmMask;           // Bit n set for 00-0F-AC AKM type n (n < 16)
+    uint16_t caps;
+    uint16_t pmkidCount;
+    const uint8_t* pmkids;      // pmkidCount x 16 bytes
+} dot11_rsn_t;
+
+// =============================================================================
+// EAPOL-KEY
+// =============================================================================
+typedef struct {
+    const uint8_t* eapol;       // Whole EAPOL PDU (header onwards), as hashed for the MIC
+    uint16_t eapolLen;
+    uint8_t descriptor;
+    uint16_t keyInfo;
+    uint8_t keyVersion;         // keyInfo bits 0-2
+    uint8_t message;            // DOT11_EAPOL_M1..M4, 0 if not 4-way
+    const uint8_t* replayCounter;   // 8 bytes
+    const uint8_t* nonce;           // 32 bytes
+    const uint8_t* mic;             // 16 bytes
+    uint16_t micOffset;             // Of the MIC within eapol, for zeroing
+    const uint8_t* keyData;
+    uint16_t keyDataLen;
+} dot11_eapol_key_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Parse the MAC header, false if the frame is too short for its own header
+ */
+bool dot11_parse(const uint8_t* frame, uint16_t len, dot11_view_t* out);
+
+/**
+ * Tagged parameters of a management frame (after its fixed fields)
+ */
+bool dot11_mgmt_ies(const dot11_view_t* view, const uint8_t** ies, uint16_t* len);
+
+/**
+ * Iterate IEs; dot11_ie_next() stops at the end or at a truncated element
+ */
+void dot11_ie_begin(dot11_ie_iter_t* it, const uint8_t* ies, uint16_t len);
+bool dot11_ie_next(dot11_ie_iter_t* it, dot11_ie_t* ie);
+
+/**
+ * First IE with the given id
+ */
+bool dot11_ie_find(const uint8_t* ies, uint16_t len, uint8_t id, dot11_ie_t* ie);
+
+/**
+ * Parse an RSN IE body; trailing optional fields may be absent
+ */
+bool dot11_parse_rsn(const uint8_t* data, uint16_t len, dot11_rsn_t* out);
+
+/**
+ * EAPOL-Key carried in a data frame (LLC/SNAP 88-8E), false for anything else
+ */
+bool dot11_eapol_key(const dot11_view_t* view, dot11_eapol_key_t* out);
+
+/**
+ * PMKID KDE from unencrypted key data (as sent in M1), false if absent or
+ * all zero
+ */
+bool dot11_eapol_pmkid(const dot11_eapol_key_t* key, const uint8_t** pmkid);
+
+#endif // DOT11_H
@@ -0,0 +1,122 @@
+/**
+ * @file frame_ring.cpp
+ * @brief RICK Frame Ring - lock-free handoff from the promiscuous callback
+ */
+
+#include "frame_ring.h"
+#include <string.h>
+
+static_assert(sizeof(frame_slot_t) == FRAME_RING_SLOT_SIZE, "slot header must stay 16 bytes");
+
+// =============================================================================
+// SETUP
+// =============================================================================
+bool frame_ring_init(frame_ring_t* ring, uint32_t slot_count) {
+    uint32_t slots = 2;
+    while (slots < slot_count) slots <<= 1;
+
+    size_t bytes = sizeof(frame_slot_t) * slots + FRAME_RING_ALIGN;
+    ring->block = ps_malloc(bytes);
+    if (!ring->block) {
+        Serial.println("[RING] PSRAM alloc failed, trying heap...");
+        ring->block = malloc(bytes);
+    }
+    if (!ring->block) {
+        Serial.println("[RING] Failed to allocate frame ring");
+        ring->slots = nullptr;
+        ring->mask = 0;
+        return false;
+    }
+
+    uintptr_t base = ((uintptr_t)ring->block + FRAME_RING_ALIGN - 1) & ~(uintptr_t)(FRAME_RING_ALIGN - 1);
+    ring->slots = (frame_slot_t*)base;
+    ring->mask = slots - 1;
+    frame_ring_reset(ring);
+
+    Serial.printf("[RING] %lu slots x %d bytes\n", (unsigned long)slots, FRAME_RING_SLOT_SIZE);
+    return true;
+}
+
+void frame_ring_free(frame_ring_t* ring) {
+    free(ring->block);
+    ring->block = nullptr;
+    ring->slots = nullptr;
+    ring->mask = 0;
+}
+
+void frame_ring_reset(frame_ring_t* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->received = 0;
+    ring->dropped = 0;
+    ring->truncated = 0;
+    ring->highWater = 0;
+}
+
+// =============================================================================
+// PRODUCER
+// =============================================================================
+// Indices run free and wrap at 2^32; head - tail is the fill level.
+
+bool frame_ring_push(frame_ring_t* ring, const hal_frame_t* frame) {
+    ring->received++;
+    if (!ring->slots) {
+        ring->dropped++;
+        return false;
+    }
+
+    uint32_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) > ring->mask) {
+        ring->dropped++;
+        return false;
+    }
+
+    frame_slot_t* slot = &ring->slots[head & ring->mask];
+    uint16_t len = frame->len;
+    if (len > FRAME_RING_SNAPLEN) {
+        len = FRAME_RING_SNAPLEN;
+        ring->truncated++;
+    }
+
+    slot->timestamp = frame->timestamp;
+    slot->rxLocal = (uint32_t)hal_clock_us();
+    slot->len = len;
+    slot->origLen = frame->len;
+    slot->rssi = frame->rssi;
+    slot->channel = frame->channel;
+    slot->type = frame->type;
+    memcpy(slot->payload, frame->payload, len);
+
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// =============================================================================
+// CONSUMER
+// =============================================================================
+const frame_slot_t* frame_ring_peek(frame_ring_t* ring) {
+    uint32_t tail = ring->tail;
+    uint32_t fill = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    if (fill == 0) return nullptr;
+
+    if (fill > ring->highWater) ring->highWater = fill;
+    return &ring->slots[tail & ring->mask];
+}
+
+void frame_ring_release(frame_ring_t* ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+void frame_ring_view(const frame_slot_t* slot, hal_frame_t* out) {
+    out->payload = slot->payload;
+    out->len = slot->len;
+    out->rssi = slot->rssi;
+    out->channel = slot->channel;
+    out->timestamp = slot->timestamp;
+    out->type = (wifi_promiscuous_pkt_type_t)slot->type;
+}
+
+uint64_t frame_ring_rx_us(const frame_slot_t* slot) {
+    uint64_t now = hal_clock_us();
+    return now - (uint32_t)((uint32_t)now - slot->rxLocal);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file frame_ring.h
+ * @brief RICK Frame Ring - lock-free handoff from the promiscuous callback
+ *
+ * Fixed-size single-producer/single-consumer ring of captured frames. The
+ * producer is the WiFi driver task and only copies; all parsing happens on
+ * the consumer side. Slots live in PSRAM and are cache-line aligned, and the
+ * producer and consumer indices sit on separate lines so the two sides never
+ * share a line they write.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <Arduino.h>
+#include "hal/hal.h"
+
+#define FRAME_RING_ALIGN        64      // Covers the S3 data cache line
+#define FRAME_RING_SLOT_SIZE    512
+#define FRAME_RING_SNAPLEN      (FRAME_RING_SLOT_SIZE - 16)
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    uint32_t timestamp;         // Microseconds, radio local time
+    uint32_t rxLocal;           // hal_clock_us() at the push, low 32 bits
+    uint16_t len;               // Bytes stored in payload
+    uint16_t origLen;           // Length on air, > len when truncated
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t type;               // wifi_promiscuous_pkt_type_t
+    uint8_t reserved;
+    uint8_t payload[FRAME_RING_SNAPLEN];
+} frame_slot_t;
+
+typedef struct {
+    // Producer line
+    alignas(FRAME_RING_ALIGN) volatile uint32_t head;
+    volatile uint32_t received;         // Frames offered by the callback
+    volatile uint32_t dropped;          // Frames lost to a full ring
+    volatile uint32_t truncated;        // Frames cut to FRAME_RING_SNAPLEN
+
+    // Consumer line
+    alignas(FRAME_RING_ALIGN) volatile uint32_t tail;
+    uint32_t highWater;                 // Deepest backlog seen by the consumer
+
+    // Read-only after init
+    alignas(FRAME_RING_ALIGN) frame_slot_t* slots;
+    void* block;                        // Unaligned allocation backing slots
+    uint32_t mask;                      // Slot count - 1 (power of two)
+} frame_ring_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Allocate a ring of slot_count slots (rounded up to a power of two)
+ */
+bool frame_ring_init(frame_ring_t* ring, uint32_t slot_count);
+
+/**
+ * Release the slot memory
+ */
+void frame_ring_free(frame_ring_t* ring);
+
+/**
+ * Empty the ring and zero the counters - only while the producer is idle
+ */
+void frame_ring_reset(frame_ring_t* ring);
+
+/**
+ * Copy a frame in (producer side), false if the ring is full
+ */
+bool frame_ring_push(frame_ring_t* ring, const hal_frame_t* frame);
+
+/**
+ * Oldest unconsumed frame (consumer side), nullptr if empty
+ */
+const frame_slot_t* frame_ring_peek(frame_ring_t* ring);
+
+/**
+ * Hand the slot returned by frame_ring_peek back to the producer
+ */
+void frame_ring_release(frame_ring_t* ring);
+
+/**
+ * Frame view over a slot, valid until the slot is released
+ */
+void frame_ring_view(const frame_slot_t* slot, hal_frame_t* out);
+
+/**
+ * hal_clock_us() when the slot was pushed (within the last 71 minutes)
+ */
+uint64_t frame_ring_rx_us(const frame_slot_t* slot);
+
+#endif // FRAME_RING_H
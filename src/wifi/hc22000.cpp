@@ -0,0 +1,227 @@
+/**
+ * @file hc22000.cpp
+ * @brief RICK 22000 Writer - append-only hashcat sink with write-behind
+ */
+
+#include "hc22000.h"
+#include <string.h>
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static inline char* hex_put(char* out, const uint8_t* data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        *out++ = HEX_DIGITS[data[i] >> 4];
+        *out++ = HEX_DIGITS[data[i] & 0x0F];
+    }
+    return out;
+}
+
+// ESSIDs are hex in 22000 too, so any byte value survives
+static inline char* essid_put(char* out, const char* essid) {
+    size_t len = essid ? strnlen(essid, 32) : 0;
+    return hex_put(out, (const uint8_t*)essid, len);
+}
+
+// =============================================================================
+// SETUP
+// =============================================================================
+bool hc22000_init(hc22000_writer_t* w, uint32_t max_records) {
+    *w = hc22000_writer_t();
+
+    uint32_t slots = 16;
+    while (slots < max_records * 2) slots <<= 1;
+
+    w->stage = (char*)ps_malloc(HC22000_STAGE_SIZE);
+    if (!w->stage) w->stage = (char*)malloc(HC22000_STAGE_SIZE);
+    w->seen = (uint64_t*)ps_malloc(sizeof(uint64_t) * slots);
+    if (!w->seen) w->seen = (uint64_t*)malloc(sizeof(uint64_t) * slots);
+
+    if (!w->stage || !w->seen) {
+        Serial.println("[HC22000] Failed to allocate buffers");
+        hc22000_free(w);
+        return false;
+    }
+
+    memset(w->seen, 0, sizeof(uint64_t) * slots);
+    w->seenMask = slots - 1;
+    return true;
+}
+
+void hc22000_free(hc22000_writer_t* w) {
+    hc22000_close(w);
+    free(w->stage);
+    free(w->seen);
+    w->stage = nullptr;
+    w->seen = nullptr;
+    w->seenMask = 0;
+}
+
+bool hc22000_open(hc22000_writer_t* w, const char* path) {
+    if (w->isOpen) hc22000_close(w);
+    if (!w->stage) return false;
+
+    w->file = SD.open(path, FILE_APPEND);
+    if (!w->file) {
+        Serial.printf("[HC22000] Cannot open %s\n", path);
+        return false;
+    }
+    w->isOpen = true;
+    w->staged = 0;
+    w->filePos = w->file.size();  // Append streams may report 0 until written
+    return true;
+}
+
+// =============================================================================
+// STAGING
+// =============================================================================
+// Write the staged bytes up to the last sector boundary of the file, so after
+// the first drain every write covers whole sectors only.
+
+static void drain(hc22000_writer_t* w, bool all) {
+    if (w->staged == 0) return;
+
+    uint32_t pos = w->filePos;
+    uint16_t n = w->staged;
+    if (!all) {
+        uint16_t head = (HC22000_SECTOR - pos % HC22000_SECTOR) % HC22000_SECTOR;
+        if (n < head) return;
+        n = head + (n - head) / HC22000_SECTOR * HC22000_SECTOR;
+        if (n == 0) return;
+    }
+
+    size_t written = w->file.write((const uint8_t*)w->stage, n);
+    w->sectorWrites++;
+    if (written != n) w->errors++;
+    w->bytes += written;
+    w->filePos += written;
+
+    w->staged -= n;
+    memmove(w->stage, w->stage + n, w->staged);
+}
+
+void hc22000_flush(hc22000_writer_t* w) {
+    if (!w->isOpen) return;
+    drain(w, true);
+    w->file.flush();
+}
+
+void hc22000_close(hc22000_writer_t* w) {
+    if (!w->isOpen) return;
+    hc22000_flush(w);
+    w->file.close();
+    w->isOpen = false;
+}
+
+// =============================================================================
+// DEDUPE
+// =============================================================================
+static uint64_t fingerprint(uint8_t type, const uint8_t* ap, const uint8_t* sta, const uint8_t* key) {
+    // FNV-1a over type, both MACs and the MIC or PMKID; EAPOL types carry the
+    // message pair, so an authorized M2+M3 line still follows an M1+M2 one
+    uint64_t h = 0xCBF29CE484222325ULL;
+    h = (h ^ type) * 0x100000001B3ULL;
+    for (int i = 0; i < 6; i++) h = (h ^ ap[i]) * 0x100000001B3ULL;
+    for (int i = 0; i < 6; i++) h = (h ^ sta[i]) * 0x100000001B3ULL;
+    for (int i = 0; i < 16; i++) h = (h ^ key[i]) * 0x100000001B3ULL;
+    return h ? h : 1;
+}
+
+// True the first time a fingerprint is offered
+static bool remember(hc22000_writer_t* w, uint64_t fp) {
+    uint32_t slot = (uint32_t)(fp ^ (fp >> 32)) & w->seenMask;
+    while (w->seen[slot]) {
+        if (w->seen[slot] == fp) return false;
+        slot = (slot + 1) & w->seenMask;
+    }
+
+    // Keep the set at most 3/4 full; past that, records go out undeduped
+    if (w->seenCount < w->seenMask / 4 * 3) {
+        w->seen[slot] = fp;
+        w->seenCount++;
+    }
+    return true;
+}
+
+// =============================================================================
+// FORMATTING
+// =============================================================================
+// WPA*01*PMKID*MAC_AP*MAC_STA*ESSID***
+// WPA*02*MIC*MAC_AP*MAC_STA*ESSID*ANONCE*EAPOL*MESSAGEPAIR
+
+uint16_t hc22000_format_pmkid(char* out, const uint8_t* pmkid, const uint8_t* ap,
+                              const uint8_t* sta, const char* essid) {
+    char* p = out;
+    memcpy(p, "WPA*01*", 7);
+    p = hex_put(p + 7, pmkid, 16);
+    *p++ = '*';
+    p = hex_put(p, ap, 6);
+    *p++ = '*';
+    p = hex_put(p, sta, 6);
+    *p++ = '*';
+    p = essid_put(p, essid);
+    memcpy(p, "***\n", 4);
+    return p + 4 - out;
+}
+
+uint16_t hc22000_format_eapol(char* out, const uint8_t* mic, const uint8_t* ap,
+                              const uint8_t* sta, const char* essid, const uint8_t* anonce,
+                              const uint8_t* eapol, uint16_t eapolLen, uint8_t messagePair) {
+    if (eapolLen > HC22000_MAX_EAPOL) eapolLen = HC22000_MAX_EAPOL;
+
+    char* p = out;
+    memcpy(p, "WPA*02*", 7);
+    p = hex_put(p + 7, mic, 16);
+    *p++ = '*';
+    p = hex_put(p, ap, 6);
+    *p++ = '*';
+    p = hex_put(p, sta, 6);
+    *p++ = '*';
+    p = essid_put(p, essid);
+    *p++ = '*';
+    p = hex_put(p, anonce, 32);
+    *p++ = '*';
+    p = hex_put(p, eapol, eapolLen);
+    *p++ = '*';
+    p = hex_put(p, &messagePair, 1);
+    *p++ = '\n';
+    return p - out;
+}
+
+// =============================================================================
+// RECORDS
+// =============================================================================
+// Lines are formatted in place at the end of the staging buffer, which always
+// keeps room for one more.
+
+static void commit_line(hc22000_writer_t* w, uint16_t len) {
+    w->staged += len;
+    w->records++;
+    if (w->staged > HC22000_STAGE_SIZE - HC22000_MAX_LINE) drain(w, false);
+}
+
+bool hc22000_write_pmkid(hc22000_writer_t* w, const uint8_t* pmkid, const uint8_t* ap,
+                         const uint8_t* sta, const char* essid) {
+    if (!w->isOpen) return false;
+    if (!remember(w, fingerprint(HC22000_TYPE_PMKID, ap, sta, pmkid))) {
+        w->duplicates++;
+        return false;
+    }
+
+    commit_line(w, hc22000_format_pmkid(w->stage + w->staged, pmkid, ap, sta, essid));
+    return true;
+}
+
+bool hc22000_write_eapol(hc22000_writer_t* w, const uint8_t* mic, const uint8_t* ap,
+                         const uint8_t* sta, const char* essid, const uint8_t* anonce,
+                         const uint8_t* eapol, uint16_t eapolLen, uint8_t messagePair) {
+    if (!w->isOpen) return false;
+    uint8_t type = HC22000_TYPE_EAPOL | (messagePair & 0x07) << 4;
+    if (!remember(w, fingerprint(type, ap, sta, mic))) {
+        w->duplicates++;
+        return false;
+    }
+
+    commit_line(w, hc22000_format_eapol(w->stage + w->staged, mic, ap, sta, essid,
+                                        anonce, eapol, eapolLen, messagePair));
+    return true;
+}
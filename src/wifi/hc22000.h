@@ -0,0 +1,92 @@
+/**
+ * @file hc22000.h
+ * @brief RICK 22000 Writer - append-only hashcat sink with write-behind
+ *
+ * Lines are hex-encoded straight into a RAM staging buffer and reach the
+ * card in whole 512-byte sectors; the tail goes out on flush or close.
+ * Every record is fingerprinted by (type, AP, STA, MIC/PMKID) and written
+ * at most once for the lifetime of the writer, across reopens.
+ */
+
+#ifndef HC22000_H
+#define HC22000_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+#define HC22000_SECTOR          512
+#define HC22000_STAGE_SIZE      (8 * HC22000_SECTOR)
+#define HC22000_MAX_EAPOL       256
+#define HC22000_MAX_LINE        (96 + 64 + 64 + 2 * HC22000_MAX_EAPOL)
+
+#define HC22000_TYPE_PMKID      1
+#define HC22000_TYPE_EAPOL      2
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    File file;
+    bool isOpen;
+    uint32_t filePos;           // Bytes in the file, for sector alignment
+
+    char* stage;                // HC22000_STAGE_SIZE bytes
+    uint16_t staged;
+
+    uint64_t* seen;             // Fingerprint set, 0 = empty slot
+    uint32_t seenMask;
+    uint32_t seenCount;
+
+    uint32_t records;           // Lines accepted since init
+    uint32_t duplicates;
+    uint32_t sectorWrites;      // Write calls that reached the card
+    uint32_t bytes;
+    uint32_t errors;
+} hc22000_writer_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Allocate the staging buffer and a dedupe set for about max_records lines
+ */
+bool hc22000_init(hc22000_writer_t* w, uint32_t max_records);
+
+/**
+ * Flush, close and release everything
+ */
+void hc22000_free(hc22000_writer_t* w);
+
+/**
+ * Open a file for appending; the dedupe set is kept
+ */
+bool hc22000_open(hc22000_writer_t* w, const char* path);
+
+/**
+ * Write out everything staged, including a partial sector
+ */
+void hc22000_flush(hc22000_writer_t* w);
+
+void hc22000_close(hc22000_writer_t* w);
+
+/**
+ * Format a WPA*01 / WPA*02 line into out (HC22000_MAX_LINE bytes), returns
+ * its length including the newline
+ */
+uint16_t hc22000_format_pmkid(char* out, const uint8_t* pmkid, const uint8_t* ap,
+                              const uint8_t* sta, const char* essid);
+uint16_t hc22000_format_eapol(char* out, const uint8_t* mic, const uint8_t* ap,
+                              const uint8_t* sta, const char* essid, const uint8_t* anonce,
+                              const uint8_t* eapol, uint16_t eapolLen, uint8_t messagePair);
+
+/**
+ * Stage a record; false if it is a duplicate or the writer is not open
+ */
+bool hc22000_write_pmkid(hc22000_writer_t* w, const uint8_t* pmkid, const uint8_t* ap,
+                         const uint8_t* sta, const char* essid);
+bool hc22000_write_eapol(hc22000_writer_t* w, const uint8_t* mic, const uint8_t* ap,
+                         const uint8_t* sta, const char* essid, const uint8_t* anonce,
+                         const uint8_t* eapol, uint16_t eapolLen, uint8_t messagePair);
+
+#endif // HC22000_H
@@ -0,0 +1,107 @@
+/**
+ * @file hop_scheduler.cpp
+ * @brief RICK Hop Scheduler - decides which channel to listen on and for how long
+ */
+
+#include "hop_scheduler.h"
+#include <string.h>
+
+// =============================================================================
+// SETUP
+// =============================================================================
+void hop_init(hop_scheduler_t* hop, hop_policy_t policy, uint8_t min_channel, uint8_t max_channel,
+              uint16_t base_dwell_ms, uint16_t floor_dwell_ms) {
+    memset(hop, 0, sizeof(hop_scheduler_t));
+    if (max_channel > HOP_MAX_CHANNEL) max_channel = HOP_MAX_CHANNEL;
+    if (min_channel < 1) min_channel = 1;
+    if (floor_dwell_ms > base_dwell_ms) floor_dwell_ms = base_dwell_ms;
+
+    hop->policy = policy;
+    hop->minChannel = min_channel;
+    hop->maxChannel = max_channel;
+    hop->channel = min_channel;
+    hop->lockedChannel = min_channel;
+    hop->baseDwellMs = base_dwell_ms;
+    hop->floorDwellMs = floor_dwell_ms;
+    hop->dwellMs = base_dwell_ms;
+    hop->dwellStart = millis();
+}
+
+void hop_set_policy(hop_scheduler_t* hop, hop_policy_t policy, uint8_t locked_channel) {
+    hop->policy = policy;
+    if (locked_channel >= hop->minChannel && locked_channel <= hop->maxChannel) {
+        hop->lockedChannel = locked_channel;
+    }
+    hop->dwellStart = millis() - hop->dwellMs;  // Re-plan on the next tick
+}
+
+const char* hop_policy_name(hop_policy_t policy) {
+    switch (policy) {
+        case HOP_ROUND_ROBIN: return "RR";
+        case HOP_WEIGHTED:    return "ADAPT";
+        case HOP_LOCKED:      return "LOCK";
+        default:              return "?";
+    }
+}
+
+// =============================================================================
+// ACTIVITY
+// =============================================================================
+void hop_note_frame(hop_scheduler_t* hop, uint8_t channel) {
+    if (channel <= HOP_MAX_CHANNEL && hop->frames[channel] < 0xFFFF) hop->frames[channel]++;
+}
+
+void hop_note_new_bssid(hop_scheduler_t* hop, uint8_t channel) {
+    if (channel <= HOP_MAX_CHANNEL && hop->newBssids[channel] < 0xFFFF) hop->newBssids[channel]++;
+}
+
+// Fold the finished dwell into the channel's score
+static void close_dwell(hop_scheduler_t* hop, uint32_t elapsed) {
+    uint8_t ch = hop->channel;
+    if (elapsed == 0) elapsed = 1;
+
+    float activity = hop->frames[ch] + HOP_NEW_BSSID_WEIGHT * hop->newBssids[ch];
+    float rate = activity * 1000.0f / elapsed;
+    hop->score[ch] += HOP_RATE_SMOOTHING * (rate - hop->score[ch]);
+
+    hop->frames[ch] = 0;
+    hop->newBssids[ch] = 0;
+}
+
+// =============================================================================
+// SCHEDULING
+// =============================================================================
+static uint16_t weighted_dwell(const hop_scheduler_t* hop, uint8_t ch) {
+    uint8_t channels = hop->maxChannel - hop->minChannel + 1;
+    float total = 0;
+    for (uint8_t c = hop->minChannel; c <= hop->maxChannel; c++) total += hop->score[c];
+
+    // Nothing heard anywhere yet - fall back to an even split
+    if (total <= 0) return hop->baseDwellMs;
+
+    // Each round lasts channels x base dwell; every channel gets the floor
+    // and the rest is shared out by score
+    uint32_t round = (uint32_t)hop->baseDwellMs * channels;
+    uint32_t spare = round - (uint32_t)hop->floorDwellMs * channels;
+    return hop->floorDwellMs + (uint16_t)(spare * (hop->score[ch] / total));
+}
+
+bool hop_tick(hop_scheduler_t* hop, uint32_t now) {
+    uint32_t elapsed = now - hop->dwellStart;
+
+    if (hop->policy == HOP_LOCKED) {
+        if (hop->channel == hop->lockedChannel) return false;
+        close_dwell(hop, elapsed);
+        hop->channel = hop->lockedChannel;
+        hop->dwellStart = now;
+        return true;
+    }
+
+    if (elapsed < hop->dwellMs) return false;
+    close_dwell(hop, elapsed);
+
+    hop->channel = hop->channel >= hop->maxChannel ? hop->minChannel : hop->channel + 1;
+    hop->dwellMs = hop->policy == HOP_WEIGHTED ? weighted_dwell(hop, hop->channel) : hop->baseDwellMs;
+    hop->dwellStart = now;
+    return true;
+}
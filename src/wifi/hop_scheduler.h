@@ -0,0 +1,84 @@
+/**
+ * @file hop_scheduler.h
+ * @brief RICK Hop Scheduler - decides which channel to listen on and for how long
+ *
+ * Round-robin gives every channel the same dwell. Weighted still visits every
+ * channel each round but splits the round between them by recent activity
+ * (frames per second plus a bonus per newly discovered BSSID), with a floor
+ * so quiet channels keep being sampled. Locked stays on one channel.
+ */
+
+#ifndef HOP_SCHEDULER_H
+#define HOP_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define HOP_MAX_CHANNEL         14
+#define HOP_NEW_BSSID_WEIGHT    20.0f   // One new AP is worth this many frames
+#define HOP_RATE_SMOOTHING      0.3f    // EWMA weight of the latest dwell
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef enum {
+    HOP_ROUND_ROBIN = 0,
+    HOP_WEIGHTED,
+    HOP_LOCKED,
+    HOP_POLICY_COUNT
+} hop_policy_t;
+
+typedef struct {
+    hop_policy_t policy;
+    uint8_t minChannel;
+    uint8_t maxChannel;
+    uint8_t channel;                    // Channel the radio is on
+    uint8_t lockedChannel;
+    uint16_t baseDwellMs;               // Average dwell per channel
+    uint16_t floorDwellMs;              // Weighted never dwells less than this
+    uint16_t dwellMs;                   // Length of the current dwell
+    uint32_t dwellStart;
+
+    // Counted during the current dwell, indexed by channel
+    uint16_t frames[HOP_MAX_CHANNEL + 1];
+    uint16_t newBssids[HOP_MAX_CHANNEL + 1];
+
+    // Smoothed activity per second, indexed by channel
+    float score[HOP_MAX_CHANNEL + 1];
+} hop_scheduler_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Initialize over channels min..max, starting on min
+ */
+void hop_init(hop_scheduler_t* hop, hop_policy_t policy, uint8_t min_channel, uint8_t max_channel,
+              uint16_t base_dwell_ms, uint16_t floor_dwell_ms);
+
+/**
+ * Switch policy; locked_channel is used by HOP_LOCKED
+ */
+void hop_set_policy(hop_scheduler_t* hop, hop_policy_t policy, uint8_t locked_channel);
+
+/**
+ * Count a frame heard on channel
+ */
+void hop_note_frame(hop_scheduler_t* hop, uint8_t channel);
+
+/**
+ * Count a BSSID seen for the first time on channel
+ */
+void hop_note_new_bssid(hop_scheduler_t* hop, uint8_t channel);
+
+/**
+ * Advance the schedule, returns true when the caller should retune to hop->channel
+ */
+bool hop_tick(hop_scheduler_t* hop, uint32_t now);
+
+/**
+ * Policy name for the UI
+ */
+const char* hop_policy_name(hop_policy_t policy);
+
+#endif // HOP_SCHEDULER_H
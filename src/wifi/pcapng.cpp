@@ -0,0 +1,329 @@
+/**
+ * @file pcapng.cpp
+ * @brief RICK PCAPNG Sink - raw frame capture with rotation
+ */
+
+#include "pcapng.h"
+#include <string.h>
+
+#define BLOCK_SHB               0x0A0D0D0A
+#define BLOCK_IDB               0x00000001
+#define BLOCK_EPB               0x00000006
+#define BLOCK_PAD               0x80000BAD      // Local-use type, skipped by readers
+#define LINKTYPE_RADIOTAP       127
+
+// Radiotap: flags, channel, dBm antenna signal
+#define RADIOTAP_LEN            16
+#define RADIOTAP_PRESENT        ((1 << 1) | (1 << 3) | (1 << 5))
+#define RADIOTAP_CHAN_2GHZ      0x0080
+
+#define SHB_LEN                 28
+#define IDB_LEN                 32
+#define EPB_OVERHEAD            32
+#define NO_INDEX                0xFFFF
+
+static const uint8_t ZEROS[PCAPNG_PREFILL_CHUNK] = {0};
+
+static inline void put16(uint8_t* p, uint16_t v) { memcpy(p, &v, 2); }
+static inline void put32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+
+// =============================================================================
+// SETUP
+// =============================================================================
+bool pcapng_init(pcapng_sink_t* sink, const char* dir, uint32_t file_bytes,
+                 uint32_t rotate_ms, uint16_t snaplen) {
+    *sink = pcapng_sink_t();
+    strncpy(sink->dir, dir, sizeof(sink->dir) - 1);
+    sink->fileBytes = (file_bytes + PCAPNG_SECTOR - 1) / PCAPNG_SECTOR * PCAPNG_SECTOR;
+    sink->rotateMs = rotate_ms;
+    sink->snaplen = snaplen;
+
+    sink->buffer = (uint8_t*)ps_malloc(PCAPNG_BUFFER_SIZE);
+    if (!sink->buffer) {
+        Serial.println("[PCAP] PSRAM alloc failed, trying heap...");
+        sink->buffer = (uint8_t*)malloc(PCAPNG_BUFFER_SIZE);
+    }
+    if (!sink->buffer) {
+        Serial.println("[PCAP] Failed to allocate staging buffer");
+        return false;
+    }
+    return true;
+}
+
+void pcapng_free(pcapng_sink_t* sink) {
+    pcapng_stop(sink);
+    free(sink->buffer);
+    sink->buffer = nullptr;
+}
+
+// =============================================================================
+// FILES
+// =============================================================================
+static void file_name(const pcapng_sink_t* sink, uint16_t index, char* out, size_t len) {
+    snprintf(out, len, "%s/cap_%04u.pcapng", sink->dir, index);
+}
+
+// First index at or after from with no file on the card, NO_INDEX if none
+static uint16_t free_index(const pcapng_sink_t* sink, uint32_t from) {
+    char path[sizeof(sink->dir) + 24];
+    for (uint32_t i = from; i <= PCAPNG_MAX_INDEX; i++) {
+        file_name(sink, i, path, sizeof(path));
+        if (!SD.exists(path)) return i;
+    }
+    return NO_INDEX;
+}
+
+// Write staged bytes; unless all is set, only up to the last sector boundary
+// of the file, so bursts stay sector-aligned
+static void drain(pcapng_sink_t* sink, bool all) {
+    if (sink->fill == 0) return;
+
+    uint32_t n = sink->fill;
+    if (!all) {
+        uint32_t head = (PCAPNG_SECTOR - sink->filePos % PCAPNG_SECTOR) % PCAPNG_SECTOR;
+        if (n < head) return;
+        n = head + (n - head) / PCAPNG_SECTOR * PCAPNG_SECTOR;
+        if (n == 0) return;
+    }
+
+    size_t written = sink->file.write(sink->buffer, n);
+    sink->bursts++;
+    sink->lastBurst = millis();
+    if (written != n) sink->errors++;
+    sink->filePos += written;
+
+    sink->fill -= n;
+    memmove(sink->buffer, sink->buffer + n, sink->fill);
+}
+
+static void stage_headers(pcapng_sink_t* sink) {
+    uint8_t* p = sink->buffer + sink->fill;
+
+    put32(p, BLOCK_SHB);
+    put32(p + 4, SHB_LEN);
+    put32(p + 8, 0x1A2B3C4D);               // Byte-order magic
+    put16(p + 12, 1);                       // Version 1.0
+    put16(p + 14, 0);
+    put32(p + 16, 0xFFFFFFFF);              // Section length unknown
+    put32(p + 20, 0xFFFFFFFF);
+    put32(p + 24, SHB_LEN);
+    p += SHB_LEN;
+
+    put32(p, BLOCK_IDB);
+    put32(p + 4, IDB_LEN);
+    put16(p + 8, LINKTYPE_RADIOTAP);
+    put16(p + 10, 0);
+    put32(p + 12, RADIOTAP_LEN + sink->snaplen);
+    put16(p + 16, 9);                       // if_tsresol: microseconds
+    put16(p + 18, 1);
+    put32(p + 20, 6);
+    put32(p + 24, 0);                       // opt_endofopt
+    put32(p + 28, IDB_LEN);
+
+    sink->fill += SHB_LEN + IDB_LEN;
+    sink->oldestStaged = millis();
+}
+
+// Cover the preallocated space after the last block with one padding block
+static void seal(pcapng_sink_t* sink, uint32_t physical) {
+    if (physical <= sink->filePos) return;
+
+    uint32_t pad = physical - sink->filePos;
+    if (pad < 12) pad += PCAPNG_SECTOR;
+
+    uint8_t hdr[8];
+    put32(hdr, BLOCK_PAD);
+    put32(hdr + 4, pad);
+    sink->file.write(hdr, 8);
+    sink->file.seek(sink->filePos + pad - 4);
+    sink->file.write(hdr + 4, 4);
+}
+
+static void close_current(pcapng_sink_t* sink) {
+    drain(sink, true);
+    seal(sink, sink->fileSize);
+    sink->file.close();
+    sink->isOpen = false;
+}
+
+static bool open_current(pcapng_sink_t* sink) {
+    char path[sizeof(sink->dir) + 24];
+
+    if (sink->nextOpen) {
+        // Preallocated file: overwrite from the start
+        sink->file = sink->next;
+        sink->next = File();
+        sink->nextOpen = false;
+        sink->file.seek(0);
+        sink->fileIndex = sink->nextIndex;
+        sink->fileSize = sink->nextFilled;
+    } else {
+        uint16_t index = free_index(sink, sink->fileIndex);
+        if (index == NO_INDEX) {
+            Serial.printf("[PCAP] No free capture name left in %s, stopping\n", sink->dir);
+            sink->errors++;
+            return false;
+        }
+        sink->fileIndex = index;
+        file_name(sink, sink->fileIndex, path, sizeof(path));
+        sink->file = SD.open(path, FILE_WRITE);
+        if (!sink->file) {
+            Serial.printf("[PCAP] Cannot open %s\n", path);
+            sink->errors++;
+            return false;
+        }
+        sink->fileSize = 0;
+    }
+
+    sink->isOpen = true;
+    sink->filePos = 0;
+    sink->fileOpened = millis();
+    stage_headers(sink);
+    return true;
+}
+
+static void rotate(pcapng_sink_t* sink) {
+    close_current(sink);
+    sink->fileIndex++;
+    open_current(sink);
+    sink->rotations++;
+}
+
+bool pcapng_start(pcapng_sink_t* sink) {
+    if (!sink->buffer) return false;
+    if (sink->isOpen) return true;
+
+    sink->fill = 0;
+    sink->fileIndex = 0;
+    sink->radioAnchored = false;
+    sink->lastStamp = 0;
+    sink->stampWraps = 0;
+    if (!open_current(sink)) return false;
+
+    Serial.printf("[PCAP] Capturing to %s/cap_%04u.pcapng\n", sink->dir, sink->fileIndex);
+    return true;
+}
+
+void pcapng_stop(pcapng_sink_t* sink) {
+    if (sink->isOpen) close_current(sink);
+
+    if (sink->nextOpen) {
+        // Never used - drop it rather than leave an empty capture behind
+        char path[sizeof(sink->dir) + 24];
+        sink->next.close();
+        sink->nextOpen = false;
+        file_name(sink, sink->nextIndex, path, sizeof(path));
+        SD.remove(path);
+    }
+}
+
+// =============================================================================
+// FRAMES
+// =============================================================================
+static uint16_t channel_mhz(uint8_t channel) {
+    if (channel == 14) return 2484;
+    return 2407 + channel * 5;
+}
+
+bool pcapng_write(pcapng_sink_t* sink, const hal_frame_t* frame, uint16_t orig_len, uint64_t rx_us) {
+    if (!sink->isOpen) return false;
+
+    uint16_t caplen = frame->len < sink->snaplen ? frame->len : sink->snaplen;
+    uint32_t dataLen = RADIOTAP_LEN + caplen;
+    uint32_t blockLen = EPB_OVERHEAD + ((dataLen + 3) & ~3u);
+
+    if (sink->filePos + sink->fill + blockLen > sink->fileBytes) {
+        rotate(sink);
+        if (!sink->isOpen) return false;
+    }
+    if (sink->fill + blockLen > PCAPNG_BUFFER_SIZE) drain(sink, false);
+    if (sink->fill == 0) sink->oldestStaged = millis();
+
+    // Extend the 32-bit radio clock across wraps
+    if (frame->timestamp < sink->lastStamp && sink->lastStamp - frame->timestamp > 0x80000000) {
+        sink->stampWraps++;
+    }
+    sink->lastStamp = frame->timestamp;
+    uint64_t radio = ((uint64_t)sink->stampWraps << 32) | frame->timestamp;
+
+    // The receive stamp trails the radio's by the callback latency, so the
+    // smallest gap is the truest offset; a far larger one is a radio restart.
+    // Drain time would add however long the consumer was held up
+    int64_t gap = (int64_t)(rx_us - radio);
+    if (!sink->radioAnchored || gap < sink->radioToLocal || gap - sink->radioToLocal > PCAPNG_REANCHOR_US) {
+        sink->radioToLocal = gap;
+        sink->radioAnchored = true;
+    }
+    uint64_t ts = utc_clock_at(&utcClock, radio + sink->radioToLocal);
+
+    uint8_t* p = sink->buffer + sink->fill;
+    put32(p, BLOCK_EPB);
+    put32(p + 4, blockLen);
+    put32(p + 8, 0);                        // Interface 0
+    put32(p + 12, (uint32_t)(ts >> 32));
+    put32(p + 16, (uint32_t)ts);
+    put32(p + 20, dataLen);
+    put32(p + 24, RADIOTAP_LEN + (orig_len > frame->len ? orig_len : frame->len));
+
+    uint8_t* rt = p + 28;
+    rt[0] = 0;                              // Version
+    rt[1] = 0;
+    put16(rt + 2, RADIOTAP_LEN);
+    put32(rt + 4, RADIOTAP_PRESENT);
+    rt[8] = 0;                              // Flags: no FCS
+    rt[9] = 0;                              // Align channel to 2
+    put16(rt + 10, channel_mhz(frame->channel));
+    put16(rt + 12, RADIOTAP_CHAN_2GHZ);
+    rt[14] = (uint8_t)frame->rssi;
+    rt[15] = 0;
+
+    memcpy(rt + RADIOTAP_LEN, frame->payload, caplen);
+    memset(rt + dataLen, 0, blockLen - EPB_OVERHEAD - dataLen);
+    put32(p + blockLen - 4, blockLen);
+
+    sink->fill += blockLen;
+    sink->packets++;
+    sink->bytes += caplen;
+
+    if (sink->fill >= PCAPNG_BURST) drain(sink, false);
+    return true;
+}
+
+// =============================================================================
+// SERVICE
+// =============================================================================
+void pcapng_service(pcapng_sink_t* sink) {
+    if (!sink->isOpen) return;
+    uint32_t now = millis();
+
+    if (sink->rotateMs && now - sink->fileOpened >= sink->rotateMs) {
+        rotate(sink);
+        if (!sink->isOpen) return;
+    }
+
+    if (sink->fill && now - sink->oldestStaged >= PCAPNG_FLUSH_MS) {
+        drain(sink, true);
+        sink->file.flush();
+    }
+
+    // Preallocate the next file a chunk at a time, only once the card has
+    // been quiet for a while, so the zeros never hold up frame writes
+    if (sink->fill >= PCAPNG_BURST || now - sink->lastBurst < PCAPNG_PREFILL_MS ||
+        now - sink->lastPrefill < PCAPNG_PREFILL_MS) {
+        return;
+    }
+    sink->lastPrefill = now;
+    if (!sink->nextOpen) {
+        char path[sizeof(sink->dir) + 24];
+        sink->nextIndex = free_index(sink, sink->fileIndex + 1);
+        if (sink->nextIndex == NO_INDEX) return;
+        file_name(sink, sink->nextIndex, path, sizeof(path));
+        sink->next = SD.open(path, FILE_WRITE);
+        if (!sink->next) return;
+        sink->nextOpen = true;
+        sink->nextFilled = 0;
+    }
+    if (sink->nextFilled < sink->fileBytes) {
+        sink->nextFilled += sink->next.write(ZEROS, sizeof(ZEROS));
+    }
+}
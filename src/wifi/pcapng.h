@@ -0,0 +1,111 @@
+/**
+ * @file pcapng.h
+ * @brief RICK PCAPNG Sink - raw frame capture with rotation
+ *
+ * Frames from the promiscuous ring are framed as Enhanced Packet Blocks with
+ * a radiotap header (channel, RSSI), staged in a PSRAM buffer and written in
+ * sector-aligned bursts. Files are preallocated ahead of time, a chunk at a
+ * time from pcapng_service() while the card has been quiet, so the FAT chain
+ * is already in place when frames arrive; the unused tail is closed off with
+ * a padding block that readers skip. A file rotates when it reaches its size
+ * or age limit.
+ *
+ * Packet timestamps are UTC from the shared clock (gps/utc_clock): radio
+ * time is carried onto hal_clock_us() by an offset learned from the ring's
+ * receive stamps, then through utc_clock_at().
+ */
+
+#ifndef PCAPNG_H
+#define PCAPNG_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include "hal/hal.h"
+#include "gps/utc_clock.h"
+
+#define PCAPNG_SECTOR           512
+#define PCAPNG_BUFFER_SIZE      (32 * 1024)     // Staging buffer, PSRAM
+#define PCAPNG_BURST            (16 * PCAPNG_SECTOR)
+#define PCAPNG_PREFILL_CHUNK    4096            // Preallocation per write
+#define PCAPNG_PREFILL_MS       20              // Min gap between them, and quiet time since a burst
+#define PCAPNG_FLUSH_MS         2000            // Max age of staged frames
+#define PCAPNG_MAX_INDEX        9999            // cap_0000 .. cap_9999, then capture stops
+#define PCAPNG_REANCHOR_US      1000000         // Radio clock this far off the offset restarted
+
+// =============================================================================
+// DATA STRUCTURES
+// =============================================================================
+typedef struct {
+    char dir[48];
+    uint32_t fileBytes;         // Rotate at this size (and preallocate it)
+    uint32_t rotateMs;          // Rotate after this long, 0 = size only
+    uint16_t snaplen;           // Bytes kept per frame
+
+    // Current file
+    File file;
+    bool isOpen;
+    uint32_t filePos;           // Bytes written to the current file
+    uint32_t fileSize;          // Its size on the card, incl. preallocation
+    uint32_t fileOpened;
+    uint16_t fileIndex;
+
+    // Next file, preallocated in the background
+    File next;
+    bool nextOpen;
+    uint16_t nextIndex;
+    uint32_t nextFilled;
+
+    uint8_t* buffer;
+    uint32_t fill;
+    uint32_t oldestStaged;      // millis() of the first unwritten block
+    uint32_t lastBurst;         // millis() of the last frame write to the card
+    uint32_t lastPrefill;
+
+    int64_t radioToLocal;       // hal_clock_us() minus radio time
+    bool radioAnchored;
+    uint32_t lastStamp;
+    uint32_t stampWraps;
+
+    // Stats
+    uint32_t packets;
+    uint32_t bytes;             // Captured bytes, before framing
+    uint32_t bursts;            // Write calls that reached the card
+    uint32_t rotations;
+    uint32_t errors;
+} pcapng_sink_t;
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Set up a sink writing dir/cap_NNNN.pcapng; nothing is opened yet
+ */
+bool pcapng_init(pcapng_sink_t* sink, const char* dir, uint32_t file_bytes,
+                 uint32_t rotate_ms, uint16_t snaplen);
+
+/**
+ * Open the first file (the next free index in dir)
+ */
+bool pcapng_start(pcapng_sink_t* sink);
+
+/**
+ * Flush, seal and close the current file, drop the preallocated one
+ */
+void pcapng_stop(pcapng_sink_t* sink);
+
+void pcapng_free(pcapng_sink_t* sink);
+
+/**
+ * Stage one frame; orig_len is its length on air, rx_us the hal_clock_us()
+ * it was received at
+ */
+bool pcapng_write(pcapng_sink_t* sink, const hal_frame_t* frame, uint16_t orig_len, uint64_t rx_us);
+
+/**
+ * Age-based flush, rotation by time and background preallocation - call
+ * from the loop
+ */
+void pcapng_service(pcapng_sink_t* sink);
+
+#endif // PCAPNG_H
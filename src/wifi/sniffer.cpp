@@ -0,0 +1,84 @@
+/**
+ * @file sniffer.cpp
+ * @brief RICK Beacon Sniffer - passive AP discovery from promiscuous frames
+ */
+
+#include "sniffer.h"
+#include "dot11.h"
+#include <string.h>
+
+#define CAP_PRIVACY         0x0010
+
+// Microsoft WPA IE: 00-50-F2 type 1
+static const uint8_t WPA_OUI_TYPE[4] = {0x00, 0x50, 0xF2, 0x01};
+
+// =============================================================================
+// FRAME PARSING
+// =============================================================================
+static wifi_auth_mode_t rsn_auth(const dot11_ie_t* ie, bool hasWpa) {
+    dot11_rsn_t rsn;
+    if (!dot11_parse_rsn(ie->data, ie->len, &rsn)) {
+        return hasWpa ? WIFI_AUTH_WPA_WPA2_PSK : WIFI_AUTH_WPA2_PSK;
+    }
+
+    bool psk = rsn.akmMask & ((1 << DOT11_AKM_PSK) | (1 << DOT11_AKM_PSK_SHA256));
+    bool sae = rsn.akmMask & (1 << DOT11_AKM_SAE);
+    bool eap = rsn.akmMask & (1 << DOT11_AKM_8021X);
+
+    if (sae && psk) return WIFI_AUTH_WPA2_WPA3_PSK;
+    if (sae) return WIFI_AUTH_WPA3_PSK;
+    if (eap && !psk) return WIFI_AUTH_WPA2_ENTERPRISE;
+    return hasWpa ? WIFI_AUTH_WPA_WPA2_PSK : WIFI_AUTH_WPA2_PSK;
+}
+
+bool sniffer_parse(const hal_frame_t* frame, hal_ap_record_t* out) {
+    if (frame->type != WIFI_PKT_MGMT) return false;
+
+    dot11_view_t view;
+    if (!dot11_parse(frame->payload, frame->len, &view)) return false;
+    if (view.subtype != DOT11_MGMT_BEACON && view.subtype != DOT11_MGMT_PROBE_RESP) return false;
+
+    const uint8_t* ies;
+    uint16_t iesLen;
+    if (!dot11_mgmt_ies(&view, &ies, &iesLen)) return false;
+
+    memcpy(out->bssid, view.bssid, 6);
+    out->ssid[0] = '\0';
+    out->rssi = frame->rssi;
+    out->channel = frame->channel;
+
+    uint16_t caps = view.body[10] | (view.body[11] << 8);
+    dot11_ie_t rsn = {0, 0, nullptr};
+    bool hasWpa = false;
+
+    dot11_ie_iter_t it;
+    dot11_ie_t ie;
+    dot11_ie_begin(&it, ies, iesLen);
+    while (dot11_ie_next(&it, &ie)) {
+        switch (ie.id) {
+            case DOT11_IE_SSID:
+                // Hidden networks send a zero length or NUL-filled SSID
+                if (ie.len <= 32 && ie.len > 0 && ie.data[0] != '\0') {
+                    memcpy(out->ssid, ie.data, ie.len);
+                    out->ssid[ie.len] = '\0';
+                }
+                break;
+            case DOT11_IE_DS_PARAMS:
+                // Adjacent-channel beacons leak through, trust the AP
+                if (ie.len == 1) out->channel = ie.data[0];
+                break;
+            case DOT11_IE_RSN:
+                rsn = ie;
+                break;
+            case DOT11_IE_VENDOR:
+                if (ie.len >= 4 && memcmp(ie.data, WPA_OUI_TYPE, 4) == 0) hasWpa = true;
+                break;
+        }
+    }
+
+    if (rsn.data) out->authmode = rsn_auth(&rsn, hasWpa);
+    else if (hasWpa) out->authmode = WIFI_AUTH_WPA_PSK;
+    else if (caps & CAP_PRIVACY) out->authmode = WIFI_AUTH_WEP;
+    else out->authmode = WIFI_AUTH_OPEN;
+    return true;
+}
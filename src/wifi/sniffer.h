@@ -0,0 +1,24 @@
+/**
+ * @file sniffer.h
+ * @brief RICK Beacon Sniffer - passive AP discovery from promiscuous frames
+ *
+ * Parses beacons and probe responses drained from the frame ring, so the
+ * network table is updated on every frame instead of once per sweep.
+ */
+
+#ifndef SNIFFER_H
+#define SNIFFER_H
+
+#include <Arduino.h>
+#include "hal/hal.h"
+
+// =============================================================================
+// FUNCTION PROTOTYPES
+// =============================================================================
+
+/**
+ * Parse a beacon or probe response into an AP record, false for anything else
+ */
+bool sniffer_parse(const hal_frame_t* frame, hal_ap_record_t* out);
+
+#endif // SNIFFER_H
@@ -138,15 +138,35 @@
 #define WIFI_DEAUTH_REASON      1       // Unspecified reason
 #define WIFI_DEAUTH_FRAMES      5       // Frames per burst
 
+// Network table eviction (least recently seen rows spill to SD when full)
+#define SCANNER_SPILL_FILE      DIR_LOGS "/networks_evicted.csv"
+#define SCANNER_SPILL_HEADER    "MAC,SSID,AuthMode,FirstSeen,LastSeen,Channel,RSSI,Hidden"
+#define SCANNER_SPILL_BATCH     32      // Rows staged in RAM per SD append
+
+// Promiscuous frames in flight between the RX callback and scanner_tick()
+#define SCANNER_RING_SLOTS      512     // x FRAME_RING_SLOT_SIZE bytes of PSRAM
+
+// Hidden networks stay watched for their SSID this long after their last beacon
+#define SCANNER_DECLOAK_EXPIRY_MS   (5 * 60 * 1000)
+
 // Handshake capture
 #define HANDSHAKE_TIMEOUT_MS    60000
 #define PMKID_CAPTURE_ENABLED   true
 #define EAPOL_BUFFER_SIZE       512
 #define MAX_CAPTURED_HANDSHAKES 100
+#define CAPTURE_SINK_FILE       DIR_HANDSHAKES "/capture.22000"
+#define CAPTURE_SINK_RECORDS    1024    // Distinct lines remembered for dedupe
+
+// Raw frame capture (pcapng into DIR_PCAP)
+#define PCAP_FILE_BYTES         (16UL * 1024 * 1024)    // Rotate and preallocate at this size
+#define PCAP_ROTATE_MS          (15UL * 60 * 1000)      // ... or after this long
+#define PCAP_SNAPLEN            496                     // Bytes kept per frame
 
 // Channel hopping
-#define CHANNEL_HOP_INTERVAL_MS 200
+#define CHANNEL_HOP_INTERVAL_MS 200     // Average dwell per channel
 #define CHANNEL_DWELL_TIME_MS   100
+#define CHANNEL_HOP_FLOOR_MS    50      // Shortest adaptive dwell
+#define CHANNEL_HOP_POLICY      HOP_WEIGHTED
 
 // MAC randomization
 #define MAC_RANDOMIZE_ENABLED   true
@@ -171,9 +191,18 @@ typedef enum {
 // GPS & WARDRIVING
 // =============================================================================
 #define GPS_ENABLED             true
-#define GPS_BAUD_RATE           9600
+#define GPS_BAUD_RATE           115200  // Module boots at 9600, switched at init
+#define GPS_RATE_MS             200     // 5 Hz fixes
+#define GPS_RX_BUFFER           1024    // UART driver buffer
+#define GPS_RING_SIZE           4096    // NMEA stream ring
 #define GPS_UPDATE_INTERVAL_MS  1000
 #define WARDRIVING_ENABLED      true
+#define WARDRIVE_FLUSH_ROWS     256     // Journal flush after this many new/improved points
+#define WARDRIVE_FLUSH_MS       10000   // ... or this long with any pending
+#define WARDRIVE_MOVE_M         10.0    // Estimate this far off its journal record counts as improved
+#define WARDRIVE_EXPORT_MAX_APS 131072  // Distinct BSSIDs an export folds to one row each (2 MB)
+#define WARDRIVE_EXPORT_CHUNK   4096    // Journal bytes read at a time by an export
+#define WARDRIVE_EXPORT_SLICE_US 8000   // Export work per wardrive_export_step()
 #define WIGLE_CSV_HEADER        "MAC,SSID,AuthMode,FirstSeen,Channel,RSSI,CurrentLatitude,CurrentLongitude,AltitudeMeters,AccuracyMeters,Type"
 
 // =============================================================================
@@ -203,6 +232,7 @@ typedef enum {
 #define DIR_ROOT                "/sd/rick"
 #define DIR_HANDSHAKES          "/sd/rick/handshakes"
 #define DIR_PMKID               "/sd/rick/pmkid"
+#define DIR_PCAP                "/sd/rick/pcap"
 #define DIR_WARDRIVING          "/sd/rick/wardriving"
 #define DIR_LOGS                "/sd/rick/logs"
 #define DIR_CONFIG              "/sd/rick/config"
@@ -12,24 +12,65 @@
 // Earth radius in meters
 #define EARTH_RADIUS 6371000.0
 
+// =============================================================================
+// BSSID INDEX
+// =============================================================================
+// Open addressing over point numbers, at most half full. Points are only
+// ever added during a session, so there is no deletion.
+
+static inline uint32_t bssid_hash(const uint8_t* bssid) {
+    uint32_t h = ((uint32_t)bssid[2] << 24) | ((uint32_t)bssid[3] << 16) |
+                 ((uint32_t)bssid[4] << 8) | bssid[5];
+    h ^= (((uint32_t)bssid[0] << 8) | bssid[1]) * 0x85EBCA6B;
+    h *= 0x9E3779B1;
+    return h ^ (h >> 16);
+}
+
+// Slot holding the BSSID, or the empty slot it would go in
+static uint32_t index_slot(wardrive_state_t* state, const uint8_t* bssid) {
+    uint32_t slot = bssid_hash(bssid) & state->indexMask;
+    uint32_t i;
+    while ((i = state->index[slot]) != WARDRIVE_INDEX_EMPTY) {
+        if (memcmp(state->points[i].bssid, bssid, 6) == 0) break;
+        slot = (slot + 1) & state->indexMask;
+    }
+    return slot;
+}
+
 // =============================================================================
 // INITIALIZATION
 // =============================================================================
 bool wardrive_init(wardrive_state_t* state, uint32_t max_points) {
     state->points = (wardrive_point_t*)ps_malloc(sizeof(wardrive_point_t) * max_points);
-    if (!state->points) {
+    state->dirtyRows = (uint32_t*)ps_malloc(sizeof(uint32_t) * max_points);
+    state->stage.buf = (char*)ps_malloc(WARDRIVE_STAGE_SIZE);
+    if (!state->stage.buf) state->stage.buf = (char*)malloc(WARDRIVE_STAGE_SIZE);
+
+    uint32_t slots = 16;
+    while (slots < max_points * 2) slots <<= 1;
+    state->index = (uint32_t*)ps_malloc(sizeof(uint32_t) * slots);
+    state->indexMask = slots - 1;
+
+    if (!state->points || !state->dirtyRows || !state->stage.buf || !state->index ||
+        !wlog_writer_init(&state->log)) {
         Serial.println("[WARDRIVE] Failed to allocate buffer");
         return false;
     }
 
     state->pointCount = 0;
     state->capacity = max_points;
+    memset(state->index, 0xFF, sizeof(uint32_t) * slots);
     state->isActive = false;
     state->startTime = 0;
     state->totalDistance = 0;
 
     memset(&state->lastFix, 0, sizeof(gps_fix_t));
     state->sessionFile[0] = '\0';
+    state->journalFile[0] = '\0';
+    state->flushed = 0;
+    state->dirtyCount = 0;
+    state->improvedCount = 0;
+    state->stage.used = 0;
 
     Serial.println("[WARDRIVE] Wubba Lubba Dub Dub mode initialized");
     return true;
@@ -43,25 +84,40 @@ void wardrive_start(wardrive_state_t* state) {
     state->startTime = millis();
     state->totalDistance = 0;
     state->pointCount = 0;
-
-    // Create session filename with timestamp
-    snprintf(state->sessionFile, sizeof(state->sessionFile),
-             "%s/wardrive_%lu.csv", DIR_WARDRIVING, millis() / 1000);
-
-    // Write CSV header
-    File file = SD.open(state->sessionFile, FILE_WRITE);
-    if (file) {
-        file.println(WIGLE_CSV_HEADER);
-        file.close();
-    }
+    memset(state->index, 0xFF, sizeof(uint32_t) * (state->indexMask + 1));
+    state->flushed = 0;
+    state->dirtyCount = 0;
+    state->improvedCount = 0;
+    state->lastFlush = state->startTime;
+    state->flushes = 0;
+    state->journalRows = 0;
+    state->journalBytes = 0;
+    state->flushUs = 0;
+    state->flushMaxUs = 0;
+
+    // Create session filenames with timestamp
+    unsigned long stamp = (unsigned long)(utc_now_us() / 1000000);
+    snprintf(state->sessionFile, sizeof(state->sessionFile), "%s/wardrive_%lu.csv", DIR_WARDRIVING, stamp);
+    snprintf(state->journalFile, sizeof(state->journalFile), "%s/wardrive_%lu.rwl", DIR_WARDRIVING, stamp);
+    if (wlog_create(&state->log, state->journalFile)) wlog_close(&state->log);
 
     Serial.println("[WARDRIVE] WUBBA LUBBA DUB DUB! Session started");
-    Serial.printf("[WARDRIVE] Logging to: %s\n", state->sessionFile);
+    Serial.printf("[WARDRIVE] Logging to: %s\n", state->journalFile);
 }
 
 void wardrive_stop(wardrive_state_t* state) {
+    if (!state->isActive) return;
     state->isActive = false;
 
+    // Compact: the table holds the latest record for every BSSID in the journal
+    wardrive_save(state);
+    if (wardrive_export_wigle(state, state->sessionFile)) {
+        Serial.printf("[WARDRIVE] Compacted %u journal records (%u bytes) into %u rows in %s\n",
+                      state->journalRows, state->journalBytes, state->pointCount, state->sessionFile);
+    } else {
+        Serial.printf("[WARDRIVE] Compaction failed, journal: %s\n", state->journalFile);
+    }
+
     Serial.printf("[WARDRIVE] Session ended. Points: %d, Distance: %.2f km\n",
                   state->pointCount, state->totalDistance / 1000.0);
 }
@@ -69,20 +125,22 @@ void wardrive_stop(wardrive_state_t* state) {
 // =============================================================================
 // GPS UPDATE
 // =============================================================================
-void wardrive_update_gps(wardrive_state_t* state, TinyGPSPlus* gps) {
-    if (!gps->location.isValid()) {
+void wardrive_update_gps(wardrive_state_t* state, const nmea_fix_t* fix) {
+    if (!fix->valid) {
         state->lastFix.valid = false;
         return;
     }
+    // No new sentence since the last call
+    if (state->lastFix.valid && fix->stampMs == state->lastFix.timestamp) return;
 
     gps_fix_t newFix;
-    newFix.latitude = gps->location.lat();
-    newFix.longitude = gps->location.lng();
-    newFix.altitude = gps->altitude.meters();
-    newFix.speed = gps->speed.kmph();
-    newFix.course = gps->course.deg();
-    newFix.satellites = gps->satellites.value();
-    newFix.timestamp = millis();
+    newFix.latitude = fix->lat * 1e-7;
+    newFix.longitude = fix->lon * 1e-7;
+    newFix.altitude = fix->altCm * 0.01;
+    newFix.speed = fix->speedCms * 0.036;
+    newFix.course = fix->courseCdeg * 0.01;
+    newFix.satellites = fix->satellites;
+    newFix.timestamp = fix->stampMs;
     newFix.valid = true;
 
     // Calculate distance traveled
@@ -104,22 +162,50 @@ void wardrive_add_network(wardrive_state_t* state, network_info_t* network) {
     if (!state->isActive) return;
     if (!state->lastFix.valid) return;
 
-    // Check if already logged (by BSSID)
-    for (uint32_t i = 0; i < state->pointCount; i++) {
-        if (memcmp(state->points[i].bssid, network->bssid, 6) == 0) {
-            // Update RSSI if stronger
-            if (network->rssi > state->points[i].rssi) {
-                state->points[i].rssi = network->rssi;
-                state->points[i].latitude = state->lastFix.latitude;
-                state->points[i].longitude = state->lastFix.longitude;
-                state->points[i].lastSeen = millis();
-            }
-            return;
+    uint32_t slot = index_slot(state, network->bssid);
+    uint32_t i = state->index[slot];
+    if (i != WARDRIVE_INDEX_EMPTY) {
+        wardrive_point_t* point = &state->points[i];
+        point->lastSeen = utc_now_us();
+        ap_locator_add(&point->loc, state->lastFix.latitude, state->lastFix.longitude, network->rssi);
+
+        bool improved = false;
+        if (network->rssi > point->rssi) {
+            point->rssi = network->rssi;
+            point->latitude = state->lastFix.latitude;
+            point->longitude = state->lastFix.longitude;
+            improved = true;
         }
+        // Decloaked since first logged
+        if (!point->ssid[0] && network->ssid[0]) {
+            strncpy(point->ssid, network->ssid, 32);
+            point->ssid[32] = '\0';
+            improved = true;
+        }
+        if (i >= state->flushed) return;
+
+        // Already journalled, and every sighting changes the count and
+        // estimate its record carries - queue a superseding one, which
+        // hurries the next flush if the point improved or the estimate moved
+        if (!point->dirty) {
+            point->dirty = true;
+            state->dirtyRows[state->dirtyCount++] = i;
+        }
+        if (!point->improved && !improved) {
+            double lat, lon;
+            wardrive_point_location(point, &lat, &lon);
+            improved = gps_distance(point->loggedLat * 1e-7, point->loggedLon * 1e-7, lat, lon) > WARDRIVE_MOVE_M;
+        }
+        if (improved && !point->improved) {
+            point->improved = true;
+            state->improvedCount++;
+        }
+        return;
     }
 
     // Add new point
     if (state->pointCount < state->capacity) {
+        state->index[slot] = state->pointCount;
         wardrive_point_t* point = &state->points[state->pointCount];
         memcpy(point->bssid, network->bssid, 6);
         strncpy(point->ssid, network->ssid, 32);
@@ -130,8 +216,12 @@ void wardrive_add_network(wardrive_state_t* state, network_info_t* network) {
         point->latitude = state->lastFix.latitude;
         point->longitude = state->lastFix.longitude;
         point->altitude = state->lastFix.altitude;
-        point->firstSeen = millis();
-        point->lastSeen = millis();
+        point->firstSeen = utc_now_us();
+        point->lastSeen = point->firstSeen;
+        ap_locator_init(&point->loc);
+        ap_locator_add(&point->loc, point->latitude, point->longitude, point->rssi);
+        point->dirty = false;
+        point->improved = false;
 
         state->pointCount++;
 
@@ -141,22 +231,39 @@ void wardrive_add_network(wardrive_state_t* state, network_info_t* network) {
     }
 }
 
+void wardrive_point_location(const wardrive_point_t* point, double* lat, double* lon) {
+    if (ap_locator_estimate(&point->loc, lat, lon) == LOCATOR_NONE) {
+        *lat = point->latitude;
+        *lon = point->longitude;
+    }
+}
+
 // =============================================================================
 // WARDRIVING TICK
 // =============================================================================
-void wardrive_tick(wardrive_state_t* state, scanner_state_t* scanner, TinyGPSPlus* gps) {
+void wardrive_tick(wardrive_state_t* state, scanner_state_t* scanner, const nmea_fix_t* fix) {
     if (!state->isActive) return;
 
     // Update GPS
-    wardrive_update_gps(state, gps);
+    wardrive_update_gps(state, fix);
 
-    // Log new networks
-    for (uint16_t i = 0; i < scanner->count; i++) {
-        wardrive_add_network(state, &scanner->networks[i]);
+    // Log what the scanner saw since the last tick
+    if (scanner->changed) {
+        for (uint16_t i = 0; i < scanner->changedCount; i++) {
+            wardrive_add_network(state, &scanner->networks[scanner->changed[i]]);
+        }
+        scanner_clear_changed(scanner);
+    } else {
+        for (uint16_t i = 0; i < scanner->count; i++) {
+            wardrive_add_network(state, &scanner->networks[i]);
+        }
     }
 
-    // Auto-save every 100 points
-    if (state->pointCount > 0 && state->pointCount % 100 == 0) {
+    // Journal what changed
+    uint32_t pending = wardrive_pending(state);
+    uint32_t improved = state->improvedCount + (state->pointCount - state->flushed);
+    if (improved >= WARDRIVE_FLUSH_ROWS ||
+        (pending > 0 && millis() - state->lastFlush >= WARDRIVE_FLUSH_MS)) {
         wardrive_save(state);
     }
 }
@@ -164,110 +271,483 @@ void wardrive_tick(wardrive_state_t* state, scanner_state_t* scanner, TinyGPSPlu
 // =============================================================================
 // FILE EXPORT
 // =============================================================================
-bool wardrive_save(wardrive_state_t* state) {
-    if (state->sessionFile[0] == '\0') return false;
+static const char* auth_name(uint8_t authmode) {
+    switch (authmode) {
+        case WIFI_AUTH_OPEN:            return "[OPEN]";
+        case WIFI_AUTH_WEP:             return "[WEP]";
+        case WIFI_AUTH_WPA_PSK:         return "[WPA-PSK]";
+        case WIFI_AUTH_WPA2_PSK:        return "[WPA2-PSK]";
+        case WIFI_AUTH_WPA_WPA2_PSK:    return "[WPA-WPA2-PSK]";
+        case WIFI_AUTH_WPA2_ENTERPRISE: return "[WPA2-EAP]";
+        case WIFI_AUTH_WPA3_PSK:        return "[WPA3-PSK]";
+        default:                        return "[UNKNOWN]";
+    }
+}
 
-    File file = SD.open(state->sessionFile, FILE_APPEND);
-    if (!file) return false;
+static const char* const EXPORT_HEADERS[] = {
+    "WigleWifi-1.4,appRelease=Rick,model=K257,release=1.0,device=Archie,display=ST7796,board=ESP32S3,brand=LilyGo\n"
+    WIGLE_CSV_HEADER "\n",
 
-    for (uint32_t i = 0; i < state->pointCount; i++) {
-        wardrive_point_t* p = &state->points[i];
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+    "<Document>\n"
+    "<name>Pickle Rick Wardriving</name>\n"
+    "<Style id=\"network\"><IconStyle><Icon><href>http://maps.google.com/mapfiles/kml/paddle/wht-blank.png</href></Icon></IconStyle></Style>\n",
+
+    "{\"type\":\"FeatureCollection\",\"features\":[\n",
+};
+
+static const char* const EXPORT_FOOTERS[] = {
+    "",
+    "</Document>\n</kml>\n",
+    "\n]}\n",
+};
+
+static const char* const EXPORT_NAMES[] = {"WiGLE CSV", "KML", "GeoJSON"};
+
+static size_t stage_drain(wardrive_stage_t* stage, File& file) {
+    size_t written = stage->used ? file.write((const uint8_t*)stage->buf, stage->used) : 0;
+    if (written != stage->used) stage->errors++;
+    stage->used = 0;
+    return written;
+}
+
+static void stage_text(wardrive_stage_t* stage, File& file, const char* text) {
+    size_t len = strlen(text);
+    if (stage->used + len > WARDRIVE_STAGE_SIZE) stage_drain(stage, file);
+    memcpy(stage->buf + stage->used, text, len);
+    stage->used += len;
+}
 
-        // Auth mode string
-        const char* auth;
-        switch (p->authmode) {
-            case WIFI_AUTH_OPEN:           auth = "[OPEN]"; break;
-            case WIFI_AUTH_WEP:            auth = "[WEP]"; break;
-            case WIFI_AUTH_WPA_PSK:        auth = "[WPA-PSK]"; break;
-            case WIFI_AUTH_WPA2_PSK:       auth = "[WPA2-PSK]"; break;
-            case WIFI_AUTH_WPA_WPA2_PSK:   auth = "[WPA-WPA2-PSK]"; break;
-            case WIFI_AUTH_WPA2_ENTERPRISE:auth = "[WPA2-EAP]"; break;
-            case WIFI_AUTH_WPA3_PSK:       auth = "[WPA3-PSK]"; break;
-            default:                       auth = "[UNKNOWN]"; break;
+static void stage_begin(wardrive_stage_t* stage, File& file, export_format_t format) {
+    stage->used = 0;
+    stage->rows = 0;
+    stage->errors = 0;
+    stage_text(stage, file, EXPORT_HEADERS[format]);
+}
+
+static void stage_end(wardrive_stage_t* stage, File& file, export_format_t format) {
+    stage_text(stage, file, EXPORT_FOOTERS[format]);
+    stage_drain(stage, file);
+}
+
+// Fixed-point value as decimal text, exactly
+static void format_fixed(char* out, size_t len, int32_t value, uint32_t scale, int places) {
+    uint32_t mag = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    snprintf(out, len, "%s%lu.%0*lu", value < 0 ? "-" : "", (unsigned long)(mag / scale),
+             places, (unsigned long)(mag % scale));
+}
+
+// SSID as it has to appear inside a field of the format - at most 6 bytes
+// per byte of name, plus CSV quotes
+static void format_ssid(char* out, const char* ssid, export_format_t format) {
+    char* o = out;
+    bool quote = format == EXPORT_WIGLE && strpbrk(ssid, ",\"\r\n");
+    if (quote) *o++ = '"';
+    for (const char* s = ssid; *s; s++) {
+        uint8_t c = *s;
+        if (format == EXPORT_WIGLE) {
+            if (c == '"') *o++ = '"';
+            *o++ = c;
+        } else if (format == EXPORT_KML) {
+            if (c == '&') o += sprintf(o, "&amp;");
+            else if (c == '<') o += sprintf(o, "&lt;");
+            else if (c == '>') o += sprintf(o, "&gt;");
+            else if (c == '"') o += sprintf(o, "&quot;");
+            else *o++ = c < 0x20 && c != '\t' ? '?' : c;     // Not allowed in XML 1.0
+        } else {
+            if (c == '"' || c == '\\') { *o++ = '\\'; *o++ = c; }
+            else if (c < 0x20) o += sprintf(o, "\\u%04x", c);
+            else *o++ = c;
         }
+    }
+    if (quote) *o++ = '"';
+    *o = '\0';
+}
 
-        // WiGLE CSV format
-        file.printf("%02X:%02X:%02X:%02X:%02X:%02X,%s,%s,%lu,%d,%d,%.8f,%.8f,%.1f,10,WIFI\n",
-                    p->bssid[0], p->bssid[1], p->bssid[2],
-                    p->bssid[3], p->bssid[4], p->bssid[5],
-                    p->ssid, auth, p->firstSeen,
-                    p->channel, p->rssi,
-                    p->latitude, p->longitude, p->altitude);
+// One network into the stage, which is written out in stage-sized blocks
+static void stage_record(wardrive_stage_t* stage, File& file, export_format_t format,
+                         const wlog_record_t* r) {
+    if (stage->used > WARDRIVE_STAGE_SIZE - WARDRIVE_MAX_ROW) stage_drain(stage, file);
+
+    char mac[18], ssid[32 * 6 + 3], seen[24], lat[16], lon[16], alt[16];
+    snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X",
+             r->bssid[0], r->bssid[1], r->bssid[2], r->bssid[3], r->bssid[4], r->bssid[5]);
+    format_ssid(ssid, r->ssid, format);
+    utc_format((uint64_t)r->time * 1000000, seen, sizeof(seen));
+    format_fixed(lat, sizeof(lat), r->lat, 10000000, 7);
+    format_fixed(lon, sizeof(lon), r->lon, 10000000, 7);
+    format_fixed(alt, sizeof(alt), r->altDm, 10, 1);
+
+    char* out = stage->buf + stage->used;
+    int n;
+    if (format == EXPORT_KML) {
+        seen[10] = 'T';
+        n = snprintf(out, WARDRIVE_MAX_ROW,
+                     "<Placemark>\n"
+                     "<name>%s</name>\n"
+                     "<description>BSSID: %s, CH: %d, RSSI: %d, Sightings: %lu</description>\n"
+                     "<styleUrl>#network</styleUrl>\n"
+                     "<TimeStamp><when>%sZ</when></TimeStamp>\n"
+                     "<Point><coordinates>%s,%s,%s</coordinates></Point>\n"
+                     "</Placemark>\n",
+                     ssid[0] ? ssid : "Hidden", mac, r->channel, r->rssi, (unsigned long)r->sightings,
+                     seen, lon, lat, alt);
+    } else if (format == EXPORT_GEOJSON) {
+        seen[10] = 'T';
+        n = snprintf(out, WARDRIVE_MAX_ROW,
+                     "%s{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[%s,%s,%s]},"
+                     "\"properties\":{\"bssid\":\"%s\",\"ssid\":\"%s\",\"auth\":\"%s\",\"channel\":%d,"
+                     "\"rssi\":%d,\"sightings\":%lu,\"firstSeen\":\"%sZ\"}}",
+                     stage->rows ? ",\n" : "", lon, lat, alt, mac, ssid, auth_name(r->authmode),
+                     r->channel, r->rssi, (unsigned long)r->sightings, seen);
+    } else {
+        n = snprintf(out, WARDRIVE_MAX_ROW, "%s,%s,%s,%s,%d,%d,%s,%s,%s,10,WIFI\n",
+                     mac, ssid, auth_name(r->authmode), seen, r->channel, r->rssi, lat, lon, alt);
     }
+    if (n > 0) stage->used += n < WARDRIVE_MAX_ROW ? n : WARDRIVE_MAX_ROW - 1;
+    stage->rows++;
+}
 
-    file.close();
-    Serial.printf("[WARDRIVE] Saved %d points to %s\n", state->pointCount, state->sessionFile);
+uint32_t wardrive_pending(wardrive_state_t* state) {
+    return state->dirtyCount + (state->pointCount - state->flushed);
+}
+
+void wardrive_to_record(const wardrive_point_t* point, wlog_record_t* rec) {
+    double lat, lon;
+    wardrive_point_location(point, &lat, &lon);
+    memcpy(rec->bssid, point->bssid, 6);
+    memcpy(rec->ssid, point->ssid, sizeof(rec->ssid));
+    rec->rssi = point->rssi;
+    rec->channel = point->channel;
+    rec->authmode = point->authmode;
+    rec->lat = (int32_t)lround(lat * 1e7);
+    rec->lon = (int32_t)lround(lon * 1e7);
+    rec->altDm = (int32_t)lround(point->altitude * 10);
+    rec->time = (uint32_t)(point->firstSeen / 1000000);
+    rec->sightings = point->loc.sightings;
+}
+
+bool wardrive_save(wardrive_state_t* state) {
+    if (state->journalFile[0] == '\0') return false;
+    state->lastFlush = millis();
+    uint32_t rows = wardrive_pending(state);
+    if (rows == 0) return true;
+
+    uint32_t start = micros();
+    if (!wlog_open(&state->log, state->journalFile)) return false;
+    uint32_t bytes = state->log.bytes;
+
+    // Changed points first, then the ones never written
+    wlog_record_t rec;
+    for (uint32_t i = 0; i < state->dirtyCount; i++) {
+        wardrive_point_t* p = &state->points[state->dirtyRows[i]];
+        p->dirty = false;
+        p->improved = false;
+        wardrive_to_record(p, &rec);
+        wlog_write(&state->log, &rec);
+        p->loggedLat = rec.lat;
+        p->loggedLon = rec.lon;
+    }
+    for (uint32_t i = state->flushed; i < state->pointCount; i++) {
+        wardrive_point_t* p = &state->points[i];
+        wardrive_to_record(p, &rec);
+        wlog_write(&state->log, &rec);
+        p->loggedLat = rec.lat;
+        p->loggedLon = rec.lon;
+    }
+    wlog_close(&state->log);
+
+    state->dirtyCount = 0;
+    state->improvedCount = 0;
+    state->flushed = state->pointCount;
+    state->flushes++;
+    state->journalRows += rows;
+    state->journalBytes += state->log.bytes - bytes;
+    uint32_t us = micros() - start;
+    state->flushUs += us;
+    if (us > state->flushMaxUs) state->flushMaxUs = us;
     return true;
 }
 
-bool wardrive_export_wigle(wardrive_state_t* state, const char* filename) {
+bool wardrive_restore(wardrive_state_t* state, const wlog_record_t* rec) {
+    uint32_t slot = index_slot(state, rec->bssid);
+    uint32_t i = state->index[slot];
+    if (i == WARDRIVE_INDEX_EMPTY) {
+        if (state->pointCount >= state->capacity) return false;
+        i = state->pointCount++;
+        state->index[slot] = i;
+        if (state->flushed == i) state->flushed++;
+    }
+
+    wardrive_point_t* point = &state->points[i];
+    memcpy(point->bssid, rec->bssid, 6);
+    memcpy(point->ssid, rec->ssid, sizeof(point->ssid));
+    point->rssi = rec->rssi;
+    point->channel = rec->channel;
+    point->authmode = rec->authmode;
+    point->latitude = rec->lat * 1e-7;
+    point->longitude = rec->lon * 1e-7;
+    point->altitude = rec->altDm * 0.1;
+    point->firstSeen = (uint64_t)rec->time * 1000000;
+    point->lastSeen = point->firstSeen;
+    point->loggedLat = rec->lat;
+    point->loggedLon = rec->lon;
+    point->dirty = false;
+    point->improved = false;
+
+    // The estimate is all that was kept - it becomes the position, and the
+    // origin of the plane later sightings are summed on
+    ap_locator_init(&point->loc);
+    point->loc.lat0 = rec->lat;
+    point->loc.lon0 = rec->lon;
+    point->loc.sightings = rec->sightings;
+    return true;
+}
+
+static bool export_table(wardrive_state_t* state, const char* filename, export_format_t format) {
     File file = SD.open(filename, FILE_WRITE);
     if (!file) return false;
 
-    // WiGLE header
-    file.println("WigleWifi-1.4,appRelease=Rick,model=K257,release=1.0,device=Archie,display=ST7796,board=ESP32S3,brand=LilyGo");
-    file.println(WIGLE_CSV_HEADER);
-
+    stage_begin(&state->stage, file, format);
+    wlog_record_t rec;
     for (uint32_t i = 0; i < state->pointCount; i++) {
-        wardrive_point_t* p = &state->points[i];
-
-        const char* auth;
-        switch (p->authmode) {
-            case WIFI_AUTH_OPEN:           auth = "[OPEN]"; break;
-            case WIFI_AUTH_WEP:            auth = "[WEP]"; break;
-            case WIFI_AUTH_WPA_PSK:        auth = "[WPA-PSK]"; break;
-            case WIFI_AUTH_WPA2_PSK:       auth = "[WPA2-PSK]"; break;
-            default:                       auth = "[WPA2]"; break;
-        }
-
-        file.printf("%02X:%02X:%02X:%02X:%02X:%02X,%s,%s,%lu,%d,%d,%.8f,%.8f,%.1f,10,WIFI\n",
-                    p->bssid[0], p->bssid[1], p->bssid[2],
-                    p->bssid[3], p->bssid[4], p->bssid[5],
-                    p->ssid, auth, p->firstSeen,
-                    p->channel, p->rssi,
-                    p->latitude, p->longitude, p->altitude);
+        wardrive_to_record(&state->points[i], &rec);
+        stage_record(&state->stage, file, format, &rec);
     }
+    stage_end(&state->stage, file, format);
 
     file.close();
-    return true;
+    return state->stage.errors == 0;
+}
+
+bool wardrive_export_wigle(wardrive_state_t* state, const char* filename) {
+    return export_table(state, filename, EXPORT_WIGLE);
 }
 
 bool wardrive_export_kml(wardrive_state_t* state, const char* filename) {
-    File file = SD.open(filename, FILE_WRITE);
-    if (!file) return false;
+    return export_table(state, filename, EXPORT_KML);
+}
 
-    // KML header
-    file.println("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
-    file.println("<kml xmlns=\"http://www.opengis.net/kml/2.2\">");
-    file.println("<Document>");
-    file.println("<name>Pickle Rick Wardriving</name>");
+bool wardrive_export_geojson(wardrive_state_t* state, const char* filename) {
+    return export_table(state, filename, EXPORT_GEOJSON);
+}
 
-    // Style for networks
-    file.println("<Style id=\"network\"><IconStyle><Icon><href>http://maps.google.com/mapfiles/kml/paddle/wht-blank.png</href></Icon></IconStyle></Style>");
+export_format_t wardrive_export_format(const char* filename) {
+    const char* ext = strrchr(filename, '.');
+    if (ext && !strcasecmp(ext, ".kml")) return EXPORT_KML;
+    if (ext && (!strcasecmp(ext, ".geojson") || !strcasecmp(ext, ".json"))) return EXPORT_GEOJSON;
+    return EXPORT_WIGLE;
+}
 
-    // Add placemarks
-    for (uint32_t i = 0; i < state->pointCount; i++) {
-        wardrive_point_t* p = &state->points[i];
+// =============================================================================
+// STREAMING EXPORT
+// =============================================================================
+// Two passes over the journal: the first counts the records each BSSID has,
+// the second counts them down and writes the network at its last one, so
+// every BSSID gets one row with its latest record, in the order those were
+// written. The counts sit in an open-addressing table of packed BSSIDs.
+
+bool wardrive_export_init(wardrive_export_t* job, uint32_t max_aps) {
+    *job = wardrive_export_t();
+
+    uint32_t slots = 16;
+    while (slots < max_aps + max_aps / 3) slots <<= 1;
+    job->seen = (uint64_t*)ps_malloc(sizeof(uint64_t) * slots);
+    job->seenMask = slots - 1;
+    job->seenMax = max_aps;
+    job->chunk = (uint8_t*)ps_malloc(WARDRIVE_EXPORT_CHUNK + WLOG_BLOCK_SIZE);
+    job->stage.buf = (char*)ps_malloc(WARDRIVE_STAGE_SIZE);
+    if (!job->stage.buf) job->stage.buf = (char*)malloc(WARDRIVE_STAGE_SIZE);
+
+    if (!job->seen || !job->chunk || !job->stage.buf) {
+        Serial.println("[WARDRIVE] Failed to allocate export buffers");
+        wardrive_export_free(job);
+        return false;
+    }
+    return true;
+}
 
-        file.println("<Placemark>");
-        file.printf("<name>%s</name>\n", p->ssid[0] ? p->ssid : "Hidden");
-        file.printf("<description>BSSID: %02X:%02X:%02X:%02X:%02X:%02X, CH: %d, RSSI: %d</description>\n",
-                    p->bssid[0], p->bssid[1], p->bssid[2],
-                    p->bssid[3], p->bssid[4], p->bssid[5],
-                    p->channel, p->rssi);
-        file.println("<styleUrl>#network</styleUrl>");
-        file.printf("<Point><coordinates>%.8f,%.8f,%.1f</coordinates></Point>\n",
-                    p->longitude, p->latitude, p->altitude);
-        file.println("</Placemark>");
+void wardrive_export_free(wardrive_export_t* job) {
+    wardrive_export_cancel(job);
+    free(job->seen);
+    free(job->chunk);
+    free(job->stage.buf);
+    job->seen = nullptr;
+    job->chunk = nullptr;
+    job->stage.buf = nullptr;
+}
+
+// BSSID in the top 48 bits, leaving the low 16 for a count
+static inline uint64_t seen_key(const uint8_t* bssid) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) key = key << 8 | bssid[i];
+    return key << 16;
+}
+
+// Slot holding the BSSID, or the empty slot it would go in
+static uint32_t seen_slot(wardrive_export_t* job, const uint8_t* bssid, uint64_t key) {
+    uint32_t slot = bssid_hash(bssid) & job->seenMask;
+    while (job->seen[slot] != WARDRIVE_EXPORT_EMPTY && (job->seen[slot] & ~0xFFFFULL) != key) {
+        slot = (slot + 1) & job->seenMask;
     }
+    return slot;
+}
 
-    file.println("</Document>");
-    file.println("</kml>");
-    file.close();
+static void count_record(const wlog_record_t* rec, void* ctx) {
+    wardrive_export_t* job = (wardrive_export_t*)ctx;
+    uint64_t key = seen_key(rec->bssid);
+    uint64_t* s = &job->seen[seen_slot(job, rec->bssid, key)];
+    if (*s != WARDRIVE_EXPORT_EMPTY) {
+        if ((*s & 0xFFFF) < 0xFFFE) (*s)++;
+    } else if (job->seenCount < job->seenMax) {
+        *s = key | 1;
+        job->seenCount++;
+    }
+}
 
+static void write_record(const wlog_record_t* rec, void* ctx) {
+    wardrive_export_t* job = (wardrive_export_t*)ctx;
+    uint64_t* s = &job->seen[seen_slot(job, rec->bssid, seen_key(rec->bssid))];
+    if (*s == WARDRIVE_EXPORT_EMPTY) {
+        job->unindexed++;
+    } else if ((*s & 0xFFFF) > 1) {
+        (*s)--;
+        job->superseded++;
+        return;
+    }
+    stage_record(&job->stage, job->out, job->format, rec);
+    job->points++;
+}
+
+static void export_close(wardrive_export_t* job) {
+    job->in.close();
+    job->out.close();
+}
+
+bool wardrive_export_begin(wardrive_export_t* job, const char* journal, const char* filename,
+                           export_format_t format) {
+    if (job->phase == EXPORT_COUNTING || job->phase == EXPORT_WRITING) return false;
+
+    job->in = SD.open(journal, FILE_READ);
+    if (!job->in) {
+        Serial.printf("[WARDRIVE] Cannot open %s\n", journal);
+        return false;
+    }
+    job->out = SD.open(filename, FILE_WRITE);
+    if (!job->out) {
+        Serial.printf("[WARDRIVE] Cannot create %s\n", filename);
+        job->in.close();
+        return false;
+    }
+
+    strncpy(job->outFile, filename, sizeof(job->outFile) - 1);
+    job->outFile[sizeof(job->outFile) - 1] = '\0';
+    job->format = format;
+    job->phase = EXPORT_COUNTING;
+    job->inSize = job->in.size();
+    job->inPos = 0;
+    job->carried = 0;
+    wlog_reader_init(&job->reader);
+    memset(job->seen, 0xFF, sizeof(uint64_t) * (job->seenMask + 1));
+    job->seenCount = 0;
+    job->points = 0;
+    job->superseded = 0;
+    job->unindexed = 0;
+    job->reported = 0;
+    job->startMs = millis();
+    job->busyUs = 0;
+    job->stepMaxUs = 0;
+
+    Serial.printf("[WARDRIVE] Exporting %s (%lu bytes) to %s as %s\n", journal,
+                  (unsigned long)job->inSize, filename, EXPORT_NAMES[format]);
     return true;
 }
 
+// Next chunk of the journal through this pass; false once it is all read
+static bool export_chunk(wardrive_export_t* job) {
+    uint32_t want = job->inSize - job->inPos;
+    if (want > WARDRIVE_EXPORT_CHUNK) want = WARDRIVE_EXPORT_CHUNK;
+    size_t n = want ? job->in.read(job->chunk + job->carried, want) : 0;
+    job->inPos += n;
+
+    size_t have = job->carried + n;
+    size_t used = wlog_read(&job->reader, job->chunk, have, n == 0,
+                            job->phase == EXPORT_COUNTING ? count_record : write_record, job);
+    memmove(job->chunk, job->chunk + used, have - used);
+    job->carried = have - used;
+    return n > 0;
+}
+
+static void export_finish(wardrive_export_t* job) {
+    stage_end(&job->stage, job->out, job->format);
+    export_close(job);
+
+    if (job->stage.errors) {
+        job->phase = EXPORT_FAILED;
+        Serial.printf("[WARDRIVE] Export to %s failed writing\n", job->outFile);
+        return;
+    }
+    job->phase = EXPORT_DONE;
+    Serial.printf("[WARDRIVE] Exported %lu networks to %s in %lu ms (%lu superseded records, %lu bad blocks)\n",
+                  (unsigned long)job->points, job->outFile, (unsigned long)(millis() - job->startMs),
+                  (unsigned long)job->superseded, (unsigned long)job->reader.badBlocks);
+    if (job->unindexed) {
+        Serial.printf("[WARDRIVE] Past %lu BSSIDs: %lu records exported as they came\n",
+                      (unsigned long)job->seenMax, (unsigned long)job->unindexed);
+    }
+}
+
+bool wardrive_export_step(wardrive_export_t* job, uint32_t budget_us) {
+    if (job->phase != EXPORT_COUNTING && job->phase != EXPORT_WRITING) return false;
+
+    uint32_t start = micros();
+    do {
+        if (export_chunk(job)) continue;
+
+        if (job->phase == EXPORT_WRITING) {
+            export_finish(job);
+            break;
+        }
+        // Counted - back to the start to write
+        job->in.seek(0);
+        job->inPos = 0;
+        job->carried = 0;
+        wlog_reader_init(&job->reader);
+        job->phase = EXPORT_WRITING;
+        stage_begin(&job->stage, job->out, job->format);
+    } while (micros() - start < budget_us);
+
+    uint32_t us = micros() - start;
+    job->busyUs += us;
+    if (us > job->stepMaxUs) job->stepMaxUs = us;
+
+    bool running = job->phase == EXPORT_COUNTING || job->phase == EXPORT_WRITING;
+    uint8_t quarter = wardrive_export_progress(job) / 25;
+    if (running && quarter > job->reported) {
+        job->reported = quarter;
+        Serial.printf("[WARDRIVE] Export %u%%\n", quarter * 25);
+    }
+    return running;
+}
+
+uint8_t wardrive_export_progress(const wardrive_export_t* job) {
+    if (job->phase == EXPORT_DONE) return 100;
+    if (job->phase != EXPORT_COUNTING && job->phase != EXPORT_WRITING) return 0;
+    if (job->inSize == 0) return 99;
+    uint64_t done = job->inPos + (job->phase == EXPORT_WRITING ? job->inSize : 0);
+    uint32_t pct = (uint32_t)(done * 100 / (2ULL * job->inSize));
+    return pct > 99 ? 99 : pct;
+}
+
+void wardrive_export_cancel(wardrive_export_t* job) {
+    if (job->phase != EXPORT_COUNTING && job->phase != EXPORT_WRITING) return;
+    export_close(job);
+    SD.remove(job->outFile);
+    job->phase = EXPORT_IDLE;
+    Serial.printf("[WARDRIVE] Export to %s cancelled\n", job->outFile);
+}
+
 // =============================================================================
 // STATISTICS
 // =============================================================================
@@ -302,13 +782,14 @@ float gps_distance(double lat1, double lon1, double lat2, double lon2) {
     return EARTH_RADIUS * c;  // Returns meters
 }
 
-bool gps_has_fix(TinyGPSPlus* gps) {
-    return gps->location.isValid() && gps->satellites.value() >= 4;
+bool gps_has_fix(const nmea_fix_t* fix) {
+    return fix->valid && fix->satellites >= 4;
 }
 
-float gps_get_accuracy(TinyGPSPlus* gps) {
-    // Estimate based on satellite count
-    int sats = gps->satellites.value();
+float gps_get_accuracy(const nmea_fix_t* fix) {
+    // HDOP times a typical 2.5 m range error, else guess from satellite count
+    if (fix->hdop) return fix->hdop * 0.025f;
+    int sats = fix->satellites;
     if (sats >= 12) return 2.5;
     if (sats >= 8) return 5.0;
     if (sats >= 6) return 10.0;
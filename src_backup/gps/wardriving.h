@@ -3,19 +3,65 @@
  * @brief GPS Wardriving - Wubba Lubba Dub Dub Mode
  *
  * GPS-enabled wardriving with WiGLE export
+ *
+ * During a session points are journalled to the card append-only, in the
+ * binary format of gps/wardrive_log: each flush writes just the points that
+ * are new or were seen again since the last one, so a point's latest record
+ * supersedes its earlier ones and the journal always ends with what the
+ * table holds. Stopping the session compacts the table into
+ * the final WiGLE CSV, one row per BSSID, and the journal stays next to it.
+ *
+ * An export job turns any journal into WiGLE CSV, KML or GeoJSON without
+ * the table: it streams the file twice in chunks, a slice of work per
+ * wardrive_export_step(), in RAM fixed by WARDRIVE_EXPORT_MAX_APS.
+ *
+ * Points are found by a BSSID hash index, and each tick consumes only the
+ * scanner rows that changed since the last one, so every observation costs
+ * O(1) however many APs the session holds.
  */
 
 #ifndef WARDRIVING_H
 #define WARDRIVING_H
 
 #include <Arduino.h>
-#include <TinyGPSPlus.h>
 #include "../config.h"
 #include "../wifi/wifi_scanner.h"
+#include "gps/nmea_parser.h"
+#include "gps/utc_clock.h"
+#include "gps/ap_locator.h"
+#include "gps/wardrive_log.h"
+
+#define WARDRIVE_STAGE_SIZE     4096
+#define WARDRIVE_MAX_ROW        512     // KML placemark with every SSID byte escaped
+#define WARDRIVE_INDEX_EMPTY    0xFFFFFFFF
+
+#define WARDRIVE_EXPORT_EMPTY   0xFFFFFFFFFFFFFFFFULL
 
 // =============================================================================
 // WARDRIVING DATA
 // =============================================================================
+typedef enum {
+    EXPORT_WIGLE = 0,
+    EXPORT_KML,
+    EXPORT_GEOJSON
+} export_format_t;
+
+typedef enum {
+    EXPORT_IDLE = 0,
+    EXPORT_COUNTING,            // First pass: records per BSSID
+    EXPORT_WRITING,             // Second pass: a row at each BSSID's last record
+    EXPORT_DONE,
+    EXPORT_FAILED
+} export_phase_t;
+
+// Export text gathered in memory and written out in stage-sized blocks
+typedef struct {
+    char* buf;                  // WARDRIVE_STAGE_SIZE bytes
+    uint16_t used;
+    uint32_t rows;
+    uint32_t errors;            // Short writes
+} wardrive_stage_t;
+
 typedef struct {
     double latitude;
     double longitude;
@@ -30,27 +76,79 @@ typedef struct {
 typedef struct {
     uint8_t bssid[6];
     char ssid[33];
-    int8_t rssi;
+    int8_t rssi;                // Strongest sighting ...
     uint8_t channel;
     uint8_t authmode;
-    double latitude;
+    double latitude;            // ... and where it was made
     double longitude;
     double altitude;
-    uint32_t firstSeen;
-    uint32_t lastSeen;
+    uint64_t firstSeen;         // UTC microseconds
+    uint64_t lastSeen;
+    ap_locator_t loc;           // Every sighting with a fix, for the exported position
+    int32_t loggedLat;          // Position in its latest journal record, 1e-7 degrees
+    int32_t loggedLon;
+    bool dirty;                 // Changed since its journal record was written ...
+    bool improved;              // ... by more than another sighting
 } wardrive_point_t;
 
 typedef struct {
     wardrive_point_t* points;
     uint32_t pointCount;
     uint32_t capacity;
+    uint32_t* index;            // BSSID hash index, slot -> point
+    uint32_t indexMask;
     bool isActive;
     gps_fix_t lastFix;
     uint32_t startTime;
     float totalDistance;
-    char sessionFile[64];
+    char sessionFile[64];       // Final WiGLE CSV
+    char journalFile[64];       // Binary log
+    wardrive_stage_t stage;
+
+    // Journal
+    wlog_writer_t log;
+    uint32_t flushed;           // Points [0, flushed) have a journal record
+    uint32_t* dirtyRows;        // Flushed points changed since, capacity entries
+    uint32_t dirtyCount;
+    uint32_t improvedCount;     // Of those, improved
+    uint32_t lastFlush;         // millis()
+
+    // Stats
+    uint32_t flushes;
+    uint32_t journalRows;
+    uint32_t journalBytes;
+    uint32_t flushUs;           // Total and worst time in wardrive_save()
+    uint32_t flushMaxUs;
 } wardrive_state_t;
 
+typedef struct {
+    export_format_t format;
+    export_phase_t phase;
+    File in;
+    File out;
+    char outFile[64];
+    wlog_reader_t reader;
+    uint8_t* chunk;             // WARDRIVE_EXPORT_CHUNK bytes, after a carried partial block
+    uint16_t carried;
+    uint32_t inSize;            // Journal length at the start - later appends are left out
+    uint32_t inPos;             // In this pass
+
+    uint64_t* seen;             // BSSID << 16 | records left, open addressing
+    uint32_t seenMask;
+    uint32_t seenCount;
+    uint32_t seenMax;
+    wardrive_stage_t stage;
+
+    // Progress
+    uint32_t points;
+    uint32_t superseded;        // Records skipped for a later one
+    uint32_t unindexed;         // Records of BSSIDs past seenMax, all exported
+    uint8_t reported;           // Quarters logged
+    uint32_t startMs;
+    uint32_t busyUs;            // Total and worst time in wardrive_export_step()
+    uint32_t stepMaxUs;
+} wardrive_export_t;
+
 // =============================================================================
 // WARDRIVING FUNCTIONS
 // =============================================================================
@@ -66,30 +164,55 @@ bool wardrive_init(wardrive_state_t* state, uint32_t max_points);
 void wardrive_start(wardrive_state_t* state);
 
 /**
- * Stop wardriving session
+ * Stop wardriving session: flush the journal and write the session's
+ * WiGLE CSV
  */
 void wardrive_stop(wardrive_state_t* state);
 
 /**
- * Update GPS fix
+ * Take a new fix from the NMEA parser
  */
-void wardrive_update_gps(wardrive_state_t* state, TinyGPSPlus* gps);
+void wardrive_update_gps(wardrive_state_t* state, const nmea_fix_t* fix);
 
 /**
- * Add network to wardrive log
+ * Record one sighting of a network at the current fix
  */
 void wardrive_add_network(wardrive_state_t* state, network_info_t* network);
 
 /**
- * Wardriving tick - call in loop
+ * Where the AP probably is, from all its sightings - what the exports carry
  */
-void wardrive_tick(wardrive_state_t* state, scanner_state_t* scanner, TinyGPSPlus* gps);
+void wardrive_point_location(const wardrive_point_t* point, double* lat, double* lon);
 
 /**
- * Save session to SD card
+ * Wardriving tick - call in loop; takes the scanner rows changed since the
+ * last tick (the whole table if the scanner has no change list) and flushes
+ * the journal every WARDRIVE_FLUSH_ROWS new or improved points, or
+ * WARDRIVE_FLUSH_MS with any point changed at all
+ */
+void wardrive_tick(wardrive_state_t* state, scanner_state_t* scanner, const nmea_fix_t* fix);
+
+/**
+ * Append the new and improved points to the session journal
  */
 bool wardrive_save(wardrive_state_t* state);
 
+/**
+ * Points waiting for the next journal flush
+ */
+uint32_t wardrive_pending(wardrive_state_t* state);
+
+/**
+ * Journal record for a point, at its estimated position
+ */
+void wardrive_to_record(const wardrive_point_t* point, wlog_record_t* rec);
+
+/**
+ * Put a journalled point back in the table, replacing any earlier one for
+ * the BSSID; it counts as already journalled
+ */
+bool wardrive_restore(wardrive_state_t* state, const wlog_record_t* rec);
+
 /**
  * Export to WiGLE CSV format
  */
@@ -100,6 +223,51 @@ bool wardrive_export_wigle(wardrive_state_t* state, const char* filename);
  */
 bool wardrive_export_kml(wardrive_state_t* state, const char* filename);
 
+/**
+ * Export to GeoJSON, one Point feature per network
+ */
+bool wardrive_export_geojson(wardrive_state_t* state, const char* filename);
+
+/**
+ * Format by filename extension: .kml, .geojson or .json, else WiGLE CSV
+ */
+export_format_t wardrive_export_format(const char* filename);
+
+// =============================================================================
+// STREAMING EXPORT
+// =============================================================================
+
+/**
+ * Allocate an export job for sessions of up to max_aps distinct BSSIDs;
+ * past that, every record of the extra BSSIDs is exported
+ */
+bool wardrive_export_init(wardrive_export_t* job, uint32_t max_aps);
+
+void wardrive_export_free(wardrive_export_t* job);
+
+/**
+ * Start exporting a session journal; the work happens in
+ * wardrive_export_step()
+ */
+bool wardrive_export_begin(wardrive_export_t* job, const char* journal, const char* filename,
+                           export_format_t format);
+
+/**
+ * Export for about budget_us, at least one chunk. Returns true while there
+ * is more to do
+ */
+bool wardrive_export_step(wardrive_export_t* job, uint32_t budget_us);
+
+/**
+ * Percent of the journal passes done
+ */
+uint8_t wardrive_export_progress(const wardrive_export_t* job);
+
+/**
+ * Abandon a running export and remove its partial output
+ */
+void wardrive_export_cancel(wardrive_export_t* job);
+
 /**
  * Get total distance traveled (km)
  */
@@ -127,12 +295,12 @@ float gps_distance(double lat1, double lon1, double lat2, double lon2);
 /**
  * Check if GPS has valid fix
  */
-bool gps_has_fix(TinyGPSPlus* gps);
+bool gps_has_fix(const nmea_fix_t* fix);
 
 /**
  * Get GPS accuracy estimate (meters)
  */
-float gps_get_accuracy(TinyGPSPlus* gps);
+float gps_get_accuracy(const nmea_fix_t* fix);
 
 /**
  * Format GPS coordinates for display
@@ -4,30 +4,12 @@
  */
 
 #include "lora_mesh.h"
-#include <esp_system.h>
-
-// =============================================================================
-// HARDWARE CONFIGURATION (K257 SX1262)
-// =============================================================================
-#define LORA_CS     7
-#define LORA_DIO1   9
-#define LORA_RST    8
-#define LORA_BUSY   36
-
-// RadioLib SX1262 instance
-static SX1262 radio = new Module(LORA_CS, LORA_DIO1, LORA_RST, LORA_BUSY);
+#include "hal/hal.h"
+#include "gps/utc_clock.h"
 
 // Receive buffer
-static volatile bool receivedFlag = false;
 static mesh_message_t rxMessage;
 
-// =============================================================================
-// ISR CALLBACK
-// =============================================================================
-static void IRAM_ATTR onReceive(void) {
-    receivedFlag = true;
-}
-
 // =============================================================================
 // INITIALIZATION
 // =============================================================================
@@ -43,20 +25,15 @@ bool lora_mesh_init(lora_mesh_state_t* state) {
              state->deviceId[4], state->deviceId[5]);
 
     // Initialize radio
-    int status = radio.begin(LORA_FREQ, LORA_BW, LORA_SF, LORA_CR,
-                             LORA_SYNC, LORA_POWER, LORA_PREAMBLE);
-
-    if (status != RADIOLIB_ERR_NONE) {
-        Serial.printf("[LoRa] Init failed: %d\n", status);
+    if (!hal_lora_begin(LORA_FREQ, LORA_BW, LORA_SF, LORA_CR,
+                        LORA_SYNC, LORA_POWER, LORA_PREAMBLE)) {
+        Serial.println("[LoRa] Init failed");
         state->initialized = false;
         return false;
     }
 
-    // Set DIO1 as interrupt
-    radio.setDio1Action(onReceive);
-
     // Start receiving
-    radio.startReceive();
+    hal_lora_start_receive();
 
     // Initialize state
     state->initialized = true;
@@ -78,11 +55,11 @@ void lora_mesh_enable(lora_mesh_state_t* state, bool enable) {
 
     state->enabled = enable;
     if (enable) {
-        radio.startReceive();
+        hal_lora_start_receive();
         lora_mesh_send_beacon(state);
         Serial.println("[LoRa] Mesh enabled");
     } else {
-        radio.standby();
+        hal_lora_standby();
         Serial.println("[LoRa] Mesh disabled");
     }
 }
@@ -99,83 +76,74 @@ void lora_mesh_update(lora_mesh_state_t* state) {
     }
 
     // Check for received messages
-    if (receivedFlag) {
-        receivedFlag = false;
-
+    if (hal_lora_available()) {
         uint8_t buf[256];
-        int len = radio.getPacketLength();
-
-        if (len > 0 && len <= sizeof(buf)) {
-            int status = radio.readData(buf, len);
-
-            if (status == RADIOLIB_ERR_NONE) {
-                state->lastRssi = radio.getRSSI();
-                state->lastSnr = radio.getSNR();
-                state->msgReceived++;
-
-                // Parse message
-                if (len >= sizeof(mesh_message_t) - MAX_MSG_SIZE) {
-                    mesh_message_t* msg = (mesh_message_t*)buf;
-
-                    // Process based on type
-                    switch (msg->type) {
-                        case MSG_BEACON:
-                            // Add/update node
-                            {
-                                bool found = false;
-                                for (int i = 0; i < state->nodeCount; i++) {
-                                    if (memcmp(state->nodes[i].id, msg->srcId, 6) == 0) {
-                                        state->nodes[i].rssi = state->lastRssi;
-                                        state->nodes[i].lastSeen = millis();
-                                        found = true;
-                                        break;
-                                    }
-                                }
-
-                                if (!found && state->nodeCount < MAX_MESH_NODES) {
-                                    mesh_node_t* node = &state->nodes[state->nodeCount];
-                                    memcpy(node->id, msg->srcId, 6);
-                                    memcpy(node->name, msg->data, min((int)msg->dataLen, 15));
-                                    node->name[15] = 0;
-                                    node->rssi = state->lastRssi;
-                                    node->lastSeen = millis();
-                                    node->handshakes = 0;
-                                    state->nodeCount++;
-                                    Serial.printf("[LoRa] New node: %s (RSSI: %d)\n",
-                                                  node->name, node->rssi);
+        int len = hal_lora_receive(buf, sizeof(buf), &state->lastRssi, &state->lastSnr);
+
+        if (len > 0) {
+            state->msgReceived++;
+
+            // Parse message
+            if ((size_t)len >= sizeof(mesh_message_t) - MAX_MSG_SIZE) {
+                mesh_message_t* msg = (mesh_message_t*)buf;
+
+                // Process based on type
+                switch (msg->type) {
+                    case MSG_BEACON:
+                        // Add/update node
+                        {
+                            bool found = false;
+                            for (int i = 0; i < state->nodeCount; i++) {
+                                if (memcmp(state->nodes[i].id, msg->srcId, 6) == 0) {
+                                    state->nodes[i].rssi = state->lastRssi;
+                                    state->nodes[i].lastSeen = millis();
+                                    state->nodes[i].heardUtc = utc_now_us();
+                                    found = true;
+                                    break;
                                 }
                             }
-                            break;
-
-                        case MSG_PING:
-                            // Respond with pong
-                            {
-                                mesh_message_t pong;
-                                pong.type = MSG_PONG;
-                                memcpy(pong.srcId, state->deviceId, 6);
-                                memcpy(pong.dstId, msg->srcId, 6);
-                                pong.seqNum = msg->seqNum;
-                                pong.dataLen = 0;
-                                radio.transmit((uint8_t*)&pong, sizeof(pong) - MAX_MSG_SIZE);
-                                radio.startReceive();
-                            }
-                            break;
-
-                        case MSG_HANDSHAKE:
-                            Serial.printf("[LoRa] Received handshake (%d bytes)\n", msg->dataLen);
-                            // TODO: Save to SD card
-                            break;
 
-                        case MSG_CHAT:
-                            Serial.printf("[LoRa] Chat: %.*s\n", msg->dataLen, msg->data);
-                            break;
-                    }
+                            if (!found && state->nodeCount < MAX_MESH_NODES) {
+                                mesh_node_t* node = &state->nodes[state->nodeCount];
+                                memcpy(node->id, msg->srcId, 6);
+                                memcpy(node->name, msg->data, min((int)msg->dataLen, 15));
+                                node->name[15] = 0;
+                                node->rssi = state->lastRssi;
+                                node->lastSeen = millis();
+                                node->heardUtc = utc_now_us();
+                                node->handshakes = 0;
+                                state->nodeCount++;
+                                Serial.printf("[LoRa] New node: %s (RSSI: %d)\n",
+                                              node->name, node->rssi);
+                            }
+                        }
+                        break;
+
+                    case MSG_PING:
+                        // Respond with pong
+                        {
+                            mesh_message_t pong;
+                            pong.type = MSG_PONG;
+                            memcpy(pong.srcId, state->deviceId, 6);
+                            memcpy(pong.dstId, msg->srcId, 6);
+                            pong.seqNum = msg->seqNum;
+                            pong.dataLen = 0;
+                            hal_lora_transmit((uint8_t*)&pong, sizeof(pong) - MAX_MSG_SIZE);
+                            hal_lora_start_receive();
+                        }
+                        break;
+
+                    case MSG_HANDSHAKE:
+                        Serial.printf("[LoRa] Received handshake (%d bytes)\n", msg->dataLen);
+                        // TODO: Save to SD card
+                        break;
+
+                    case MSG_CHAT:
+                        Serial.printf("[LoRa] Chat: %.*s\n", msg->dataLen, msg->data);
+                        break;
                 }
             }
         }
-
-        // Restart receive
-        radio.startReceive();
     }
 
     // Prune stale nodes (not seen in 2 minutes)
@@ -205,13 +173,13 @@ bool lora_mesh_send_beacon(lora_mesh_state_t* state) {
     msg.dataLen = strlen(state->deviceName);
     memcpy(msg.data, state->deviceName, msg.dataLen);
 
-    int status = radio.transmit((uint8_t*)&msg,
-                                 sizeof(msg) - MAX_MSG_SIZE + msg.dataLen);
+    int status = hal_lora_transmit((uint8_t*)&msg,
+                                   sizeof(msg) - MAX_MSG_SIZE + msg.dataLen);
 
-    radio.startReceive();
+    hal_lora_start_receive();
     state->lastBeacon = millis();
 
-    if (status == RADIOLIB_ERR_NONE) {
+    if (status == 0) {
         state->msgSent++;
         return true;
     }
@@ -233,12 +201,12 @@ bool lora_mesh_share_handshake(lora_mesh_state_t* state, const uint8_t* data, si
     msg.dataLen = len;
     memcpy(msg.data, data, len);
 
-    int status = radio.transmit((uint8_t*)&msg,
-                                 sizeof(msg) - MAX_MSG_SIZE + len);
+    int status = hal_lora_transmit((uint8_t*)&msg,
+                                   sizeof(msg) - MAX_MSG_SIZE + len);
 
-    radio.startReceive();
+    hal_lora_start_receive();
 
-    if (status == RADIOLIB_ERR_NONE) {
+    if (status == 0) {
         state->msgSent++;
         Serial.printf("[LoRa] Shared handshake (%d bytes)\n", len);
         return true;
@@ -263,12 +231,12 @@ bool lora_mesh_send_chat(lora_mesh_state_t* state, const char* message) {
     msg.dataLen = len;
     memcpy(msg.data, message, len);
 
-    int status = radio.transmit((uint8_t*)&msg,
-                                 sizeof(msg) - MAX_MSG_SIZE + len);
+    int status = hal_lora_transmit((uint8_t*)&msg,
+                                   sizeof(msg) - MAX_MSG_SIZE + len);
 
-    radio.startReceive();
+    hal_lora_start_receive();
 
-    if (status == RADIOLIB_ERR_NONE) {
+    if (status == 0) {
         state->msgSent++;
         return true;
     }
@@ -289,11 +257,11 @@ bool lora_mesh_ping(lora_mesh_state_t* state, uint8_t nodeIndex) {
     msg.seqNum = millis() & 0xFF;
     msg.dataLen = 0;
 
-    int status = radio.transmit((uint8_t*)&msg, sizeof(msg) - MAX_MSG_SIZE);
+    int status = hal_lora_transmit((uint8_t*)&msg, sizeof(msg) - MAX_MSG_SIZE);
 
-    radio.startReceive();
+    hal_lora_start_receive();
 
-    if (status == RADIOLIB_ERR_NONE) {
+    if (status == 0) {
         state->msgSent++;
         return true;
     }
@@ -313,11 +281,11 @@ mesh_node_t* lora_mesh_get_node(lora_mesh_state_t* state, uint8_t index) {
 }
 
 bool lora_mesh_message_available(void) {
-    return receivedFlag;
+    return hal_lora_available();
 }
 
 bool lora_mesh_get_message(mesh_message_t* msg) {
-    if (!receivedFlag) return false;
+    if (!hal_lora_available()) return false;
     memcpy(msg, &rxMessage, sizeof(mesh_message_t));
     return true;
 }
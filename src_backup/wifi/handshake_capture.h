@@ -10,26 +10,12 @@
 
 #include <Arduino.h>
 #include "../config.h"
+#include "wifi/hc22000.h"
+#include "wifi/capture_filter.h"
 
 // =============================================================================
-// EAPOL FRAME STRUCTURES
+// CAPTURE RECORDS
 // =============================================================================
-typedef struct {
-    uint8_t version;
-    uint8_t type;
-    uint16_t length;
-    uint8_t key_descriptor;
-    uint16_t key_info;
-    uint16_t key_length;
-    uint8_t replay_counter[8];
-    uint8_t key_nonce[32];
-    uint8_t key_iv[16];
-    uint8_t key_rsc[8];
-    uint8_t key_id[8];
-    uint8_t key_mic[16];
-    uint16_t key_data_length;
-} __attribute__((packed)) eapol_key_t;
-
 typedef struct {
     uint8_t bssid[6];
     uint8_t station[6];
@@ -40,32 +26,70 @@ typedef struct {
     uint8_t eapol[256];
     uint16_t eapolLen;
     uint8_t keyver;
+    uint64_t replayM1;          // Replay counters as sent, to pair messages
+    uint64_t replayM2;
+    uint64_t replayM3;
+    uint8_t messagePair;        // hashcat 22000 message pair, valid once complete
     bool hasFrame1;
     bool hasFrame2;
     bool hasFrame3;
     bool hasFrame4;
     bool complete;
-    uint32_t captureTime;
+    bool inUse;                 // Slot holds a live session
+    bool essidPending;          // Complete, held back until the ESSID is known
+    uint64_t captureTime;       // UTC microseconds
+    uint32_t lastSeen;          // Last EAPOL message, for expiry
 } handshake_t;
 
+// 22000 message pairs (low bits) and flags
+#define MSGPAIR_M1M2            0x00    // EAPOL from M2, challenge
+#define MSGPAIR_M2M3            0x02    // EAPOL from M2, authorized
+#define MSGPAIR_UNCHECKED       0x80    // Replay counters did not line up
+
+// Empty slot in the session index
+#define CAPTURE_INDEX_EMPTY     0xFFFF
+
 typedef struct {
     uint8_t bssid[6];
+    uint8_t station[6];
     char ssid[33];
     uint8_t pmkid[16];
-    uint32_t captureTime;
+    bool essidPending;
+    uint64_t captureTime;       // UTC microseconds
 } pmkid_t;
 
+/**
+ * Fills essid (33 bytes) for a BSSID, false if the network is unknown
+ */
+typedef bool (*capture_essid_fn)(const uint8_t* bssid, char* essid);
+
 // =============================================================================
 // CAPTURE STATE
 // =============================================================================
 typedef struct {
-    handshake_t* handshakes;
-    uint16_t handshakeCount;
+    handshake_t* handshakes;        // Session pool, live slots have inUse set
+    uint16_t handshakeCount;        // Live sessions, complete or not
     uint16_t handshakeCapacity;
+    uint16_t* sessionIndex;         // (AP, STA) hash -> slot in handshakes
+    uint32_t sessionMask;
+    uint16_t* freeSlots;            // Stack of unused slots
+    uint16_t freeCount;
+    uint32_t lastExpiry;
+    uint32_t expiredCount;
+    uint32_t oversizedCount;        // M2s dropped, EAPOL too long to keep
 
     pmkid_t* pmkids;
     uint16_t pmkidCount;
     uint16_t pmkidCapacity;
+    uint16_t* pmkidIndex;           // (AP, STA) hash -> row in pmkids
+    uint32_t pmkidMask;
+    uint32_t pmkidDuplicates;
+
+    capture_essid_fn essidSource;
+    uint16_t essidPending;          // Records waiting for capture_essid_learned()
+
+    hc22000_writer_t sink;          // CAPTURE_SINK_FILE while capturing
+    capfilter_t filter;             // Frames this capture needs, for scanner_set_filter()
 
     uint8_t targetBSSID[6];
     bool hasTarget;
@@ -83,7 +107,10 @@ typedef struct {
 bool capture_init(capture_state_t* state, uint16_t max_handshakes, uint16_t max_pmkids);
 
 /**
- * Start capturing for specific target
+ * Start capturing for specific target; completed handshakes and PMKIDs
+ * stream to CAPTURE_SINK_FILE until capture_stop(). state->filter then
+ * narrows to the target, for scanner_set_filter(); if it is already
+ * installed, the RX callback is off it while it is rebuilt.
  */
 void capture_start_target(capture_state_t* state, const uint8_t* bssid, const char* ssid);
 
@@ -98,32 +125,56 @@ void capture_start_all(capture_state_t* state);
 void capture_stop(capture_state_t* state);
 
 /**
- * Process incoming EAPOL frame
+ * Process incoming EAPOL frame - tracks one session per (AP, STA), pairs
+ * messages by replay counter and nonce, and expires incomplete sessions
+ * after HANDSHAKE_TIMEOUT_MS. The PMKID KDE of an M1 is kept once per
+ * (AP, STA).
  */
 void capture_process_eapol(capture_state_t* state, const uint8_t* packet, uint16_t len);
 
 /**
- * Process beacon for PMKID extraction
+ * Process a management frame for PMKIDs - only (re)association requests
+ * carry a real one (the station's cached PMKSA); beacons never do
  */
 void capture_process_beacon(capture_state_t* state, const uint8_t* packet, uint16_t len);
 
+/**
+ * Where captures get their ESSID from, typically the scanner's BSSID index.
+ * Records it cannot name yet are held until capture_essid_learned() or
+ * capture_stop().
+ */
+void capture_set_essid_source(capture_state_t* state, capture_essid_fn fn);
+
+/**
+ * An SSID became known for a BSSID (scanner_set_essid_callback()); writes
+ * the records that were waiting for it
+ */
+void capture_essid_learned(capture_state_t* state, const uint8_t* bssid, const char* ssid);
+
 /**
  * Check if handshake is complete
  */
 bool capture_is_complete(handshake_t* handshake);
 
 /**
- * Save handshake to file (22000 hashcat format)
+ * Session for an (AP, STA) pair, nullptr if none
+ */
+handshake_t* capture_find_session(capture_state_t* state, const uint8_t* bssid, const uint8_t* station);
+
+/**
+ * Append one handshake to a file (22000 hashcat format)
  */
 bool capture_save_handshake(handshake_t* handshake, const char* filename);
 
 /**
- * Save PMKID to file (22000 hashcat format)
+ * Append one PMKID to a file (22000 hashcat format)
  */
 bool capture_save_pmkid(pmkid_t* pmkid, const char* filename);
 
 /**
- * Save all captures to SD card
+ * Write every capture held in RAM to CAPTURE_SINK_FILE, skipping lines the
+ * sink already wrote; while capturing, records still waiting for their ESSID
+ * are left waiting
  */
 bool capture_save_all(capture_state_t* state);
 
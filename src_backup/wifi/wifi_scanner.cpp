@@ -4,14 +4,241 @@
  */
 
 #include "wifi_scanner.h"
-#include <WiFi.h>
-#include <esp_wifi.h>
+#include "gps/utc_clock.h"
+#include <SD.h>
 #include <string.h>
 
+// =============================================================================
+// BSSID HASH INDEX
+// =============================================================================
+// Open addressing with linear probing. Slots hold row numbers into
+// state->networks and the table is sized to stay at most half full, so a
+// lookup is one or two probes regardless of how many networks are known.
+
+static inline uint32_t bssid_hash(const uint8_t* bssid) {
+    // The OUI carries little entropy - lead with the NIC-specific bytes
+    uint32_t h = ((uint32_t)bssid[2] << 24) | ((uint32_t)bssid[3] << 16) |
+                 ((uint32_t)bssid[4] << 8) | bssid[5];
+    h ^= (((uint32_t)bssid[0] << 8) | bssid[1]) * 0x85EBCA6B;
+    h *= 0x9E3779B1;
+    return h ^ (h >> 16);
+}
+
+static bool index_alloc(scanner_state_t* state, uint16_t max_networks) {
+    uint32_t slots = 16;
+    while (slots < (uint32_t)max_networks * 2) slots <<= 1;
+
+    // Keep the index in PSRAM next to the rows it points at
+    state->index = (uint16_t*)ps_malloc(sizeof(uint16_t) * slots);
+    if (!state->index) {
+        state->index = (uint16_t*)malloc(sizeof(uint16_t) * slots);
+    }
+    if (!state->index) {
+        state->indexMask = 0;
+        return false;
+    }
+
+    state->indexMask = slots - 1;
+    memset(state->index, 0xFF, sizeof(uint16_t) * slots);
+    return true;
+}
+
+static void index_insert(scanner_state_t* state, uint16_t row) {
+    uint32_t slot = bssid_hash(state->networks[row].bssid) & state->indexMask;
+    while (state->index[slot] != SCANNER_INDEX_EMPTY) {
+        slot = (slot + 1) & state->indexMask;
+    }
+    state->index[slot] = row;
+}
+
+static void index_remove(scanner_state_t* state, uint16_t row) {
+    uint32_t mask = state->indexMask;
+    uint32_t hole = bssid_hash(state->networks[row].bssid) & mask;
+    while (state->index[hole] != row) {
+        if (state->index[hole] == SCANNER_INDEX_EMPTY) return;
+        hole = (hole + 1) & mask;
+    }
+
+    // Backward-shift deletion: pull later probes into the hole so no lookup
+    // chain is broken and no tombstones accumulate
+    uint32_t next = (hole + 1) & mask;
+    while (state->index[next] != SCANNER_INDEX_EMPTY) {
+        uint32_t home = bssid_hash(state->networks[state->index[next]].bssid) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            state->index[hole] = state->index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    state->index[hole] = SCANNER_INDEX_EMPTY;
+}
+
+// =============================================================================
+// RECENCY LIST
+// =============================================================================
+// Doubly linked list of rows ordered by lastSeen. Every sighting moves a row
+// to the tail, so the head is always the eviction candidate - O(1) both ways.
+
+static bool lru_alloc(scanner_state_t* state, uint16_t max_networks) {
+    state->lruHead = SCANNER_INDEX_EMPTY;
+    state->lruTail = SCANNER_INDEX_EMPTY;
+    state->lruPrev = (uint16_t*)ps_malloc(sizeof(uint16_t) * max_networks);
+    state->lruNext = (uint16_t*)ps_malloc(sizeof(uint16_t) * max_networks);
+    state->spill = (network_info_t*)ps_malloc(sizeof(network_info_t) * SCANNER_SPILL_BATCH);
+    state->spillCount = 0;
+    state->evictedCount = 0;
+
+    if (!state->lruPrev || !state->lruNext) {
+        free(state->lruPrev);
+        free(state->lruNext);
+        free(state->spill);
+        state->lruPrev = nullptr;
+        state->lruNext = nullptr;
+        state->spill = nullptr;
+        return false;
+    }
+    return true;
+}
+
+static void lru_unlink(scanner_state_t* state, uint16_t row) {
+    uint16_t prev = state->lruPrev[row];
+    uint16_t next = state->lruNext[row];
+
+    if (prev != SCANNER_INDEX_EMPTY) state->lruNext[prev] = next;
+    else state->lruHead = next;
+
+    if (next != SCANNER_INDEX_EMPTY) state->lruPrev[next] = prev;
+    else state->lruTail = prev;
+}
+
+static void lru_push_tail(scanner_state_t* state, uint16_t row) {
+    state->lruPrev[row] = state->lruTail;
+    state->lruNext[row] = SCANNER_INDEX_EMPTY;
+
+    if (state->lruTail != SCANNER_INDEX_EMPTY) state->lruNext[state->lruTail] = row;
+    else state->lruHead = row;
+
+    state->lruTail = row;
+}
+
+// =============================================================================
+// EVICTION SPILL
+// =============================================================================
+static const char* auth_str(wifi_auth_mode_t auth) {
+    switch (auth) {
+        case WIFI_AUTH_OPEN:           return "[OPEN]";
+        case WIFI_AUTH_WEP:            return "[WEP]";
+        case WIFI_AUTH_WPA_PSK:        return "[WPA-PSK]";
+        case WIFI_AUTH_WPA2_PSK:       return "[WPA2-PSK]";
+        case WIFI_AUTH_WPA_WPA2_PSK:   return "[WPA-WPA2-PSK]";
+        case WIFI_AUTH_WPA2_ENTERPRISE:return "[WPA2-EAP]";
+        case WIFI_AUTH_WPA3_PSK:       return "[WPA3-PSK]";
+        default:                       return "[UNKNOWN]";
+    }
+}
+
+// CSV field, quoted only when the SSID holds a separator, quote or newline
+static void csv_ssid(char* out, const char* ssid) {
+    bool quote = strpbrk(ssid, ",\"\r\n") != nullptr;
+    if (quote) *out++ = '"';
+    for (; *ssid; ssid++) {
+        if (*ssid == '"') *out++ = '"';
+        *out++ = *ssid;
+    }
+    if (quote) *out++ = '"';
+    *out = '\0';
+}
+
+static void spill_write(File& file, const network_info_t* net) {
+    char ssid[32 * 2 + 3], first[24], last[24];
+    csv_ssid(ssid, net->ssid);
+    utc_format(net->firstSeen, first, sizeof(first));
+    utc_format(net->lastSeen, last, sizeof(last));
+
+    file.printf("%02X:%02X:%02X:%02X:%02X:%02X,%s,%s,%s,%s,%d,%d,%d\n",
+                net->bssid[0], net->bssid[1], net->bssid[2],
+                net->bssid[3], net->bssid[4], net->bssid[5],
+                ssid, auth_str(net->authmode), first, last,
+                net->channel, net->rssi, net->hidden ? 1 : 0);
+}
+
+static File spill_open() {
+    bool fresh = !SD.exists(SCANNER_SPILL_FILE);
+    File file = SD.open(SCANNER_SPILL_FILE, FILE_APPEND);
+    if (file && fresh) {
+        file.println(SCANNER_SPILL_HEADER);
+    }
+    return file;
+}
+
+static void spill_row(scanner_state_t* state, const network_info_t* net) {
+    if (!state->spill) {
+        // No staging buffer - write through
+        File file = spill_open();
+        if (file) {
+            spill_write(file, net);
+            file.close();
+        }
+        return;
+    }
+
+    memcpy(&state->spill[state->spillCount++], net, sizeof(network_info_t));
+    if (state->spillCount >= SCANNER_SPILL_BATCH) {
+        scanner_flush_evicted(state);
+    }
+}
+
+static uint16_t evict_oldest(scanner_state_t* state) {
+    uint16_t row = state->lruHead;
+
+    spill_row(state, &state->networks[row]);
+    if (state->index) index_remove(state, row);
+    lru_unlink(state, row);
+    state->evictedCount++;
+    return row;
+}
+
+// =============================================================================
+// CHANGED ROWS
+// =============================================================================
+// Each row is listed at most once between clears, so the list never holds
+// more than capacity entries. Consumers read only what moved instead of
+// walking the whole table every tick.
+
+static void mark_changed(scanner_state_t* state, uint16_t row) {
+    if (!state->changed || state->networks[row].changed) return;
+    state->networks[row].changed = true;
+    state->changed[state->changedCount++] = row;
+}
+
+void scanner_clear_changed(scanner_state_t* state) {
+    for (uint16_t i = 0; i < state->changedCount; i++) {
+        state->networks[state->changed[i]].changed = false;
+    }
+    state->changedCount = 0;
+}
+
+bool scanner_flush_evicted(scanner_state_t* state) {
+    if (state->spillCount == 0) return true;
+
+    File file = spill_open();
+    if (!file) return false;  // Keep them staged; retried on the next flush
+
+    for (uint16_t i = 0; i < state->spillCount; i++) {
+        spill_write(file, &state->spill[i]);
+    }
+    file.close();
+    state->spillCount = 0;
+    return true;
+}
+
 // =============================================================================
 // SCANNER INITIALIZATION
 // =============================================================================
 bool scanner_init(scanner_state_t* state, uint16_t max_networks) {
+    // Row numbers share uint16_t with the empty-slot marker
+    if (max_networks >= SCANNER_INDEX_EMPTY) max_networks = SCANNER_INDEX_EMPTY - 1;
+
     // Try PSRAM first, fallback to regular heap
     state->networks = (network_info_t*)ps_malloc(sizeof(network_info_t) * max_networks);
     if (!state->networks) {
@@ -23,28 +250,61 @@ bool scanner_init(scanner_state_t* state, uint16_t max_networks) {
         // Initialize with zero capacity but don't fail - scanner can work without storage
         state->count = 0;
         state->capacity = 0;
+        state->index = nullptr;
+        state->indexMask = 0;
+        state->lruPrev = nullptr;
+        state->lruNext = nullptr;
+        state->spill = nullptr;
+        state->spillCount = 0;
+        state->evictedCount = 0;
+        state->changed = nullptr;
+        state->changedCount = 0;
+        state->ring = nullptr;
+        state->pcap = nullptr;
+        state->essidCallback = nullptr;
+        decloak_init(&state->decloak, SCANNER_DECLOAK_EXPIRY_MS);
         state->currentChannel = 1;
+        hop_init(&state->hop, CHANNEL_HOP_POLICY, WIFI_CHANNEL_MIN, WIFI_CHANNEL_MAX,
+                 CHANNEL_HOP_INTERVAL_MS, CHANNEL_HOP_FLOOR_MS);
         state->isScanning = false;
         state->isHopping = true;
+        state->isSniffing = false;
         state->scanStartTime = 0;
         state->lastHopTime = 0;
-        WiFi.mode(WIFI_STA);
-        WiFi.disconnect();
+        hal_wifi_begin();
         Serial.println("[SCANNER] Initialized in limited mode (no storage)");
         return true;  // Return true but with limited functionality
     }
 
+    if (!index_alloc(state, max_networks)) {
+        Serial.println("[SCANNER] Index alloc failed, falling back to linear lookup");
+    }
+    if (!lru_alloc(state, max_networks)) {
+        Serial.println("[SCANNER] Recency list alloc failed, new networks dropped when full");
+    }
+    state->changed = (uint16_t*)ps_malloc(sizeof(uint16_t) * max_networks);
+    state->changedCount = 0;
+    if (!state->changed) {
+        Serial.println("[SCANNER] Changed-row list alloc failed, consumers walk the whole table");
+    }
+
     state->count = 0;
     state->capacity = max_networks;
+    state->ring = nullptr;
+    state->pcap = nullptr;
+    state->essidCallback = nullptr;
+    decloak_init(&state->decloak, SCANNER_DECLOAK_EXPIRY_MS);
     state->currentChannel = 1;
+    hop_init(&state->hop, CHANNEL_HOP_POLICY, WIFI_CHANNEL_MIN, WIFI_CHANNEL_MAX,
+             CHANNEL_HOP_INTERVAL_MS, CHANNEL_HOP_FLOOR_MS);
     state->isScanning = false;
     state->isHopping = true;
+    state->isSniffing = false;
     state->scanStartTime = 0;
     state->lastHopTime = 0;
 
     // Initialize WiFi in station mode
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect();
+    hal_wifi_begin();
 
     Serial.printf("[SCANNER] Initialized with capacity for %d networks\n", max_networks);
     return true;
@@ -59,13 +319,14 @@ void scanner_start(scanner_state_t* state) {
     state->lastHopTime = millis();
 
     // Set to first channel
-    esp_wifi_set_channel(state->currentChannel, WIFI_SECOND_CHAN_NONE);
+    hal_wifi_set_channel(state->currentChannel);
 
     Serial.println("[SCANNER] Portal Gun activated - Scanning dimensions...");
 }
 
 void scanner_stop(scanner_state_t* state) {
     state->isScanning = false;
+    scanner_flush_evicted(state);
     Serial.printf("[SCANNER] Portal closed. Found %d networks.\n", state->count);
 }
 
@@ -75,7 +336,8 @@ void scanner_stop(scanner_state_t* state) {
 void scanner_set_channel(scanner_state_t* state, uint8_t channel) {
     if (channel >= WIFI_CHANNEL_MIN && channel <= WIFI_CHANNEL_MAX) {
         state->currentChannel = channel;
-        esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+        state->hop.channel = channel;
+        hal_wifi_set_channel(channel);
     }
 }
 
@@ -83,67 +345,108 @@ void scanner_set_hopping(scanner_state_t* state, bool enabled) {
     state->isHopping = enabled;
 }
 
+void scanner_set_hop_policy(scanner_state_t* state, hop_policy_t policy, uint8_t locked_channel) {
+    hop_set_policy(&state->hop, policy, locked_channel);
+    Serial.printf("[SCANNER] Hop policy %s\n", hop_policy_name(policy));
+}
+
 // =============================================================================
 // SCANNER TICK (CALL IN LOOP)
 // =============================================================================
+// A hidden network's SSID became known
+static void name_hidden(scanner_state_t* state, network_info_t* net, const char* ssid) {
+    memcpy(net->ssid, ssid, sizeof(net->ssid));
+    decloak_forget(&state->decloak, net->bssid);
+    mark_changed(state, net - state->networks);
+
+    Serial.printf("[SCANNER] Decloaked: %s [%02X:%02X:%02X:%02X:%02X:%02X]\n", net->ssid,
+                  net->bssid[0], net->bssid[1], net->bssid[2],
+                  net->bssid[3], net->bssid[4], net->bssid[5]);
+    if (state->essidCallback) state->essidCallback(net->bssid, net->ssid);
+}
+
+static void ingest_record(scanner_state_t* state, const hal_ap_record_t* rec) {
+    // Check if network already exists
+    network_info_t* existing = scanner_find_bssid(state, rec->bssid);
+
+    if (existing) {
+        // Update existing entry
+        existing->rssi = rec->rssi;
+        existing->channel = rec->channel;
+        scanner_touch(state, existing);
+
+        if (existing->ssid[0] == '\0') {
+            if (rec->ssid[0] != '\0') name_hidden(state, existing, rec->ssid);
+            else decloak_watch(&state->decloak, existing->bssid);
+        }
+        return;
+    }
+
+    // Add new network
+    hop_note_new_bssid(&state->hop, rec->channel);
+    network_info_t net;
+    memcpy(net.bssid, rec->bssid, 6);
+    memcpy(net.ssid, rec->ssid, sizeof(net.ssid));
+    net.rssi = rec->rssi;
+    net.channel = rec->channel;
+    net.authmode = rec->authmode;
+    net.hidden = (strlen(net.ssid) == 0);
+    net.firstSeen = utc_now_us();
+    net.lastSeen = net.firstSeen;
+    net.hasHandshake = false;
+    net.hasPMKID = false;
+
+    scanner_add_network(state, &net);
+
+    Serial.printf("[SCANNER] Found: %s [%02X:%02X:%02X:%02X:%02X:%02X] CH:%d RSSI:%d\n",
+                  net.hidden ? "<hidden>" : net.ssid,
+                  net.bssid[0], net.bssid[1], net.bssid[2],
+                  net.bssid[3], net.bssid[4], net.bssid[5],
+                  net.channel, net.rssi);
+
+    if (net.hidden) decloak_watch(&state->decloak, net.bssid);
+    else if (state->essidCallback) state->essidCallback(net.bssid, net.ssid);
+}
+
+void scanner_set_essid_callback(scanner_state_t* state, scanner_essid_cb_t callback) {
+    state->essidCallback = callback;
+}
+
 void scanner_tick(scanner_state_t* state) {
+    // Frames queue up whether or not a sweep is running
+    if (state->ring) scanner_drain_frames(state, state->ring->mask + 1);
+    if (state->pcap) pcapng_service(state->pcap);
+
     if (!state->isScanning) return;
 
     // Channel hopping
-    if (state->isHopping && (millis() - state->lastHopTime > CHANNEL_HOP_INTERVAL_MS)) {
+    if (state->isHopping && hop_tick(&state->hop, millis())) {
         state->lastHopTime = millis();
-        state->currentChannel++;
-        if (state->currentChannel > WIFI_CHANNEL_MAX) {
-            state->currentChannel = WIFI_CHANNEL_MIN;
-        }
-        esp_wifi_set_channel(state->currentChannel, WIFI_SECOND_CHAN_NONE);
+        state->currentChannel = state->hop.channel;
+        hal_wifi_set_channel(state->currentChannel);
     }
 
-    // Perform scan
-    int n = WiFi.scanNetworks(true, true, false, 100);  // Async, show hidden, passive, 100ms per channel
+    if (state->isSniffing) return;  // Table is fed from the frame ring
+
+    // Poll the async sweep, (re)start it when idle
+    int16_t n = hal_wifi_scan_poll();
 
-    if (n == WIFI_SCAN_RUNNING) {
+    if (n == HAL_SCAN_RUNNING) {
         return;  // Still scanning
     }
 
-    if (n > 0) {
-        for (int i = 0; i < n; i++) {
-            // Check if network already exists
-            network_info_t* existing = scanner_find_bssid(state, WiFi.BSSID(i));
-
-            if (existing) {
-                // Update existing entry
-                existing->rssi = WiFi.RSSI(i);
-                existing->lastSeen = millis();
-            } else if (state->count < state->capacity) {
-                // Add new network
-                network_info_t net;
-                memcpy(net.bssid, WiFi.BSSID(i), 6);
-                strncpy(net.ssid, WiFi.SSID(i).c_str(), 32);
-                net.ssid[32] = '\0';
-                net.rssi = WiFi.RSSI(i);
-                net.channel = WiFi.channel(i);
-                net.authmode = WiFi.encryptionType(i);
-                net.hidden = (strlen(net.ssid) == 0);
-                net.firstSeen = millis();
-                net.lastSeen = millis();
-                net.latitude = 0;
-                net.longitude = 0;
-                net.hasHandshake = false;
-                net.hasPMKID = false;
-
-                scanner_add_network(state, &net);
-
-                Serial.printf("[SCANNER] Found: %s [%02X:%02X:%02X:%02X:%02X:%02X] CH:%d RSSI:%d\n",
-                              net.hidden ? "<hidden>" : net.ssid,
-                              net.bssid[0], net.bssid[1], net.bssid[2],
-                              net.bssid[3], net.bssid[4], net.bssid[5],
-                              net.channel, net.rssi);
-            }
-        }
+    if (n == HAL_SCAN_FAILED) {
+        hal_wifi_scan_start(true, WIFI_SCAN_PASSIVE, CHANNEL_DWELL_TIME_MS);
+        return;
     }
 
-    WiFi.scanDelete();
+    for (int i = 0; i < n; i++) {
+        hal_ap_record_t rec;
+        if (hal_wifi_scan_get(i, &rec)) ingest_record(state, &rec);
+    }
+
+    hal_wifi_scan_delete();
+    hal_wifi_scan_start(true, WIFI_SCAN_PASSIVE, CHANNEL_DWELL_TIME_MS);
 }
 
 // =============================================================================
@@ -155,22 +458,79 @@ network_info_t* scanner_get_network(scanner_state_t* state, uint16_t index) {
 }
 
 network_info_t* scanner_find_bssid(scanner_state_t* state, const uint8_t* bssid) {
-    for (uint16_t i = 0; i < state->count; i++) {
-        if (memcmp(state->networks[i].bssid, bssid, 6) == 0) {
-            return &state->networks[i];
+    if (!state->index) {
+        for (uint16_t i = 0; i < state->count; i++) {
+            if (memcmp(state->networks[i].bssid, bssid, 6) == 0) {
+                return &state->networks[i];
+            }
         }
+        return nullptr;
+    }
+
+    uint32_t slot = bssid_hash(bssid) & state->indexMask;
+    uint16_t row;
+    while ((row = state->index[slot]) != SCANNER_INDEX_EMPTY) {
+        if (memcmp(state->networks[row].bssid, bssid, 6) == 0) {
+            return &state->networks[row];
+        }
+        slot = (slot + 1) & state->indexMask;
     }
     return nullptr;
 }
 
 void scanner_add_network(scanner_state_t* state, network_info_t* network) {
-    if (state->count >= state->capacity) return;
-    memcpy(&state->networks[state->count], network, sizeof(network_info_t));
-    state->count++;
+    network_info_t* existing = scanner_find_bssid(state, network->bssid);
+    if (existing) {
+        // Update in place, keep when we first saw it and whether the row
+        // is already on the changed list
+        uint64_t firstSeen = existing->firstSeen;
+        bool listed = existing->changed;
+        memcpy(existing, network, sizeof(network_info_t));
+        existing->firstSeen = firstSeen;
+        existing->changed = listed;
+        scanner_touch(state, existing);
+        return;
+    }
+
+    uint16_t row;
+    bool listed = false;        // A reused row may still be on the changed list
+    if (state->count < state->capacity) {
+        row = state->count++;
+    } else if (state->lruPrev && state->lruHead != SCANNER_INDEX_EMPTY) {
+        row = evict_oldest(state);
+        listed = state->networks[row].changed;
+    } else {
+        return;
+    }
+
+    memcpy(&state->networks[row], network, sizeof(network_info_t));
+    state->networks[row].changed = listed;
+    if (state->index) index_insert(state, row);
+    if (state->lruPrev) lru_push_tail(state, row);
+    mark_changed(state, row);
+}
+
+void scanner_touch(scanner_state_t* state, network_info_t* network) {
+    network->lastSeen = utc_now_us();
+    uint16_t row = network - state->networks;
+    mark_changed(state, row);
+    if (!state->lruPrev) return;
+
+    if (row == state->lruTail) return;
+    lru_unlink(state, row);
+    lru_push_tail(state, row);
 }
 
 void scanner_clear(scanner_state_t* state) {
+    scanner_flush_evicted(state);
     state->count = 0;
+    state->changedCount = 0;
+    decloak_init(&state->decloak, state->decloak.expiryMs);
+    state->lruHead = SCANNER_INDEX_EMPTY;
+    state->lruTail = SCANNER_INDEX_EMPTY;
+    if (state->index) {
+        memset(state->index, 0xFF, sizeof(uint16_t) * (state->indexMask + 1));
+    }
     Serial.println("[SCANNER] Network list cleared");
 }
 
@@ -202,24 +562,129 @@ uint16_t scanner_count_hidden(scanner_state_t* state) {
     return count;
 }
 
+uint32_t scanner_count_decloaked(scanner_state_t* state) {
+    return state->decloak.decloaked;
+}
+
 // =============================================================================
 // PROMISCUOUS MODE
 // =============================================================================
-static wifi_promiscuous_cb_t userCallback = nullptr;
+static hal_frame_cb_t userCallback = nullptr;
+static frame_ring_t frameRing;
+static bool frameRingReady = false;
+static bool sniffActive = false;
+static capfilter_t* volatile activeFilter = nullptr;
+
+// Runs in the WiFi driver task - copy only, everything else happens in
+// scanner_drain_frames()
+static void onFrame(const hal_frame_t* frame) {
+    capfilter_t* filter = activeFilter;
+    if (filter && !capfilter_match(filter, frame)) return;
+    frame_ring_push(&frameRing, frame);
+}
+
+static bool attach_ring(scanner_state_t* state) {
+    if (!frameRingReady) {
+        if (!frame_ring_init(&frameRing, SCANNER_RING_SLOTS)) return false;
+        frameRingReady = true;
+    }
+    state->ring = &frameRing;
+    return true;
+}
+
+void scanner_set_filter(capfilter_t* filter) {
+    activeFilter = filter;
+}
+
+capfilter_t* scanner_get_filter() {
+    return activeFilter;
+}
+
+void scanner_set_pcap(scanner_state_t* state, pcapng_sink_t* sink) {
+    state->pcap = sink;
+}
+
+uint32_t scanner_drain_frames(scanner_state_t* state, uint32_t max_frames) {
+    if (!state->ring) return 0;
+
+    uint32_t consumed = 0;
+    const frame_slot_t* slot;
+    while (consumed < max_frames && (slot = frame_ring_peek(state->ring)) != nullptr) {
+        hal_frame_t frame;
+        frame_ring_view(slot, &frame);
+        hop_note_frame(&state->hop, frame.channel);
+        if (state->pcap) pcapng_write(state->pcap, &frame, slot->origLen, frame_ring_rx_us(slot));
+
+        // Probe responses and (re)association requests naming a hidden AP
+        uint8_t bssid[6];
+        char ssid[33];
+        if (decloak_match(&state->decloak, &frame, bssid, ssid)) {
+            network_info_t* net = scanner_find_bssid(state, bssid);
+            if (net && net->ssid[0] == '\0') name_hidden(state, net, ssid);
+        }
+
+        if (state->isSniffing) {
+            hal_ap_record_t rec;
+            if (sniffer_parse(&frame, &rec)) ingest_record(state, &rec);
+        }
+        if (userCallback) userCallback(&frame);
+
+        frame_ring_release(state->ring);
+        consumed++;
+    }
+    return consumed;
+}
 
 void scanner_enable_promisc(scanner_state_t* state) {
-    esp_wifi_set_promiscuous(true);
+    if (!attach_ring(state)) {
+        Serial.println("[SCANNER] No frame ring, promiscuous frames dropped");
+    }
+    hal_wifi_promisc(true);
     Serial.println("[SCANNER] Promiscuous mode enabled");
 }
 
 void scanner_disable_promisc(scanner_state_t* state) {
-    esp_wifi_set_promiscuous(false);
+    hal_wifi_promisc(false);
     Serial.println("[SCANNER] Promiscuous mode disabled");
 }
 
-void scanner_set_callback(wifi_promiscuous_cb_t callback) {
+void scanner_set_callback(hal_frame_cb_t callback) {
     userCallback = callback;
-    esp_wifi_set_promiscuous_rx_cb(callback);
+    hal_wifi_set_frame_cb(callback || sniffActive ? onFrame : nullptr);
+}
+
+bool scanner_start_sniffing(scanner_state_t* state) {
+    if (state->isSniffing) return true;
+
+    if (!attach_ring(state)) {
+        Serial.println("[SCANNER] No frame ring, cannot sniff");
+        return false;
+    }
+
+    // Sweeps park the radio on each channel themselves, stop them first
+    hal_wifi_scan_delete();
+    state->isSniffing = true;
+    sniffActive = true;
+    hal_wifi_set_frame_cb(onFrame);
+    scanner_enable_promisc(state);
+    hal_wifi_set_channel(state->currentChannel);
+
+    Serial.println("[SCANNER] Beacon sniffing enabled");
+    return true;
+}
+
+void scanner_stop_sniffing(scanner_state_t* state) {
+    if (!state->isSniffing) return;
+
+    sniffActive = false;
+    if (!userCallback) {
+        hal_wifi_set_frame_cb(nullptr);
+        scanner_disable_promisc(state);
+    }
+    state->isSniffing = false;
+
+    Serial.printf("[SCANNER] Beacon sniffing disabled (%lu frames dropped)\n",
+                  (unsigned long)state->ring->dropped);
 }
 
 // =============================================================================
@@ -230,7 +695,7 @@ static bool macSaved = false;
 
 void scanner_randomize_mac() {
     if (!macSaved) {
-        esp_wifi_get_mac(WIFI_IF_STA, originalMac);
+        hal_wifi_get_mac(originalMac);
         macSaved = true;
     }
 
@@ -240,14 +705,14 @@ void scanner_randomize_mac() {
         newMac[i] = random(0, 256);
     }
 
-    esp_wifi_set_mac(WIFI_IF_STA, newMac);
+    hal_wifi_set_mac(newMac);
     Serial.printf("[SCANNER] MAC randomized: %02X:%02X:%02X:%02X:%02X:%02X\n",
                   newMac[0], newMac[1], newMac[2], newMac[3], newMac[4], newMac[5]);
 }
 
 void scanner_restore_mac() {
     if (macSaved) {
-        esp_wifi_set_mac(WIFI_IF_STA, originalMac);
+        hal_wifi_set_mac(originalMac);
         Serial.println("[SCANNER] Original MAC restored");
     }
 }
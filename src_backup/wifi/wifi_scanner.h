@@ -11,6 +11,13 @@
 #include <Arduino.h>
 #include <esp_wifi.h>
 #include "../config.h"
+#include "hal/hal.h"
+#include "wifi/sniffer.h"
+#include "wifi/frame_ring.h"
+#include "wifi/hop_scheduler.h"
+#include "wifi/pcapng.h"
+#include "wifi/capture_filter.h"
+#include "wifi/decloak.h"
 
 // =============================================================================
 // NETWORK DATA STRUCTURES
@@ -22,21 +29,46 @@ typedef struct {
     uint8_t channel;
     wifi_auth_mode_t authmode;
     bool hidden;
-    uint32_t firstSeen;
-    uint32_t lastSeen;
-    float latitude;
-    float longitude;
+    uint64_t firstSeen;         // UTC microseconds
+    uint64_t lastSeen;
     bool hasHandshake;
     bool hasPMKID;
+    bool changed;               // Listed in scanner_state_t::changed
 } network_info_t;
 
+// Empty slot in the BSSID index
+#define SCANNER_INDEX_EMPTY     0xFFFF
+
+/**
+ * Called when a BSSID's SSID becomes known: a new visible network, or a
+ * hidden one named by a probe response or association request
+ */
+typedef void (*scanner_essid_cb_t)(const uint8_t* bssid, const char* ssid);
+
 typedef struct {
     network_info_t* networks;
     uint16_t count;
     uint16_t capacity;
+    uint16_t* index;            // BSSID hash index, slot -> row in networks
+    uint32_t indexMask;         // Slot count - 1 (power of two)
+    uint16_t* lruPrev;          // Recency list over rows, oldest lastSeen at head
+    uint16_t* lruNext;
+    uint16_t lruHead;
+    uint16_t lruTail;
+    network_info_t* spill;      // Evicted rows waiting for the SD append
+    uint16_t spillCount;
+    uint32_t evictedCount;
+    uint16_t* changed;          // Rows added or re-sighted since scanner_clear_changed()
+    uint16_t changedCount;
+    frame_ring_t* ring;         // Promiscuous frames awaiting scanner_tick()
+    pcapng_sink_t* pcap;        // Raw copy of every drained frame, if set
+    scanner_essid_cb_t essidCallback;
+    decloak_table_t decloak;    // Hidden BSSIDs waiting to be named
+    hop_scheduler_t hop;
     uint8_t currentChannel;
     bool isScanning;
     bool isHopping;
+    bool isSniffing;            // Table fed by beacons instead of scan sweeps
     uint32_t scanStartTime;
     uint32_t lastHopTime;
 } scanner_state_t;
@@ -71,25 +103,55 @@ void scanner_set_channel(scanner_state_t* state, uint8_t channel);
 void scanner_set_hopping(scanner_state_t* state, bool enabled);
 
 /**
- * Scanner tick - call in loop
+ * Choose how hopping spends its time (round-robin, weighted, locked)
+ */
+void scanner_set_hop_policy(scanner_state_t* state, hop_policy_t policy, uint8_t locked_channel);
+
+/**
+ * Scanner tick - call in loop. Also the consumer of the frame ring: sniffed
+ * beacons and the scanner_set_callback() handler run from here.
  */
 void scanner_tick(scanner_state_t* state);
 
+/**
+ * Get told when an SSID becomes known for a BSSID (capture uses this to
+ * fill in ESSIDs it was waiting for)
+ */
+void scanner_set_essid_callback(scanner_state_t* state, scanner_essid_cb_t callback);
+
 /**
  * Get network by index
  */
 network_info_t* scanner_get_network(scanner_state_t* state, uint16_t index);
 
 /**
- * Get network by BSSID
+ * Get network by BSSID (O(1) through the hash index)
  */
 network_info_t* scanner_find_bssid(scanner_state_t* state, const uint8_t* bssid);
 
 /**
- * Add or update network
+ * Add or update network - when the table is full the least recently seen
+ * row is evicted to SCANNER_SPILL_FILE to make room. That file is the
+ * scanner's own CSV (SCANNER_SPILL_HEADER), not WiGLE: the scanner has no
+ * position
  */
 void scanner_add_network(scanner_state_t* state, network_info_t* network);
 
+/**
+ * Mark a network as just seen (keeps it off the eviction end)
+ */
+void scanner_touch(scanner_state_t* state, network_info_t* network);
+
+/**
+ * Forget the changed-row list once its consumer has read it
+ */
+void scanner_clear_changed(scanner_state_t* state);
+
+/**
+ * Write staged evicted rows to SD
+ */
+bool scanner_flush_evicted(scanner_state_t* state);
+
 /**
  * Clear all networks
  */
@@ -110,6 +172,11 @@ uint16_t scanner_count_by_auth(scanner_state_t* state, wifi_auth_mode_t auth);
  */
 uint16_t scanner_count_hidden(scanner_state_t* state);
 
+/**
+ * Hidden networks whose SSID has been recovered
+ */
+uint32_t scanner_count_decloaked(scanner_state_t* state);
+
 // =============================================================================
 // PROMISCUOUS MODE
 // =============================================================================
@@ -125,9 +192,43 @@ void scanner_enable_promisc(scanner_state_t* state);
 void scanner_disable_promisc(scanner_state_t* state);
 
 /**
- * Set promiscuous callback
+ * Set promiscuous callback - frames are queued by the RX callback and the
+ * handler runs later from scanner_tick(), never in the WiFi driver task
+ */
+void scanner_set_callback(hal_frame_cb_t callback);
+
+/**
+ * Drop frames in the RX callback, before they are queued, unless they match
+ * (nullptr accepts all). The filter must stay valid while installed.
+ */
+void scanner_set_filter(capfilter_t* filter);
+
+/**
+ * The installed filter, nullptr if none
+ */
+capfilter_t* scanner_get_filter();
+
+/**
+ * Write every frame drained from the ring to a pcapng sink (nullptr to stop);
+ * scanner_tick() also services the sink
+ */
+void scanner_set_pcap(scanner_state_t* state, pcapng_sink_t* sink);
+
+/**
+ * Consume up to max_frames queued frames, returns frames consumed
+ */
+uint32_t scanner_drain_frames(scanner_state_t* state, uint32_t max_frames);
+
+/**
+ * Discover networks from beacons/probe responses while hopping instead of
+ * scan sweeps - the table updates within one dwell of an AP's channel
+ */
+bool scanner_start_sniffing(scanner_state_t* state);
+
+/**
+ * Return to scan sweeps
  */
-void scanner_set_callback(wifi_promiscuous_cb_t callback);
+void scanner_stop_sniffing(scanner_state_t* state);
 
 // =============================================================================
 // MAC RANDOMIZATION